@@ -56,6 +56,34 @@ fpga_result ase_fpgaWriteMMIO512(fpga_handle handle, uint32_t mmio_num,
 fpga_result ase_fpgaMapMMIO(fpga_handle handle, uint32_t mmio_num,
 			      uint64_t **mmio_ptr);
 fpga_result ase_fpgaUnmapMMIO(fpga_handle handle, uint32_t mmio_num);
+
+/*
+ * ASE extension: asynchronous MMIO reads. These are exported by the ASE
+ * plugin but are not part of the OPAE adapter table, so host code resolves
+ * them with dlsym().
+ *
+ * ase_fpgaReadMMIO{32,64}Async() send a read and return a token without
+ * waiting. ase_fpgaMMIOReadWait() waits for the read named by the token and
+ * returns its data. Up to ASE_MMIO_MAX_ASYNC_READS reads may be in flight
+ * in a process, after which the async functions return FPGA_BUSY.
+ * ase_fpgaReadMMIO64Batch() reads a list of registers, keeping the window
+ * full.
+ */
+#define ASE_MMIO_MAX_ASYNC_READS 63
+typedef uint64_t ase_mmio_read_token;
+
+fpga_result ase_fpgaReadMMIO32Async(fpga_handle handle, uint32_t mmio_num,
+				      uint64_t offset,
+				      ase_mmio_read_token *token);
+fpga_result ase_fpgaReadMMIO64Async(fpga_handle handle, uint32_t mmio_num,
+				      uint64_t offset,
+				      ase_mmio_read_token *token);
+fpga_result ase_fpgaMMIOReadWait(fpga_handle handle,
+				   ase_mmio_read_token token,
+				   uint64_t *value);
+fpga_result ase_fpgaReadMMIO64Batch(fpga_handle handle, uint32_t mmio_num,
+				      const uint64_t *offsets, uint64_t *values,
+				      uint32_t count);
 fpga_result ase_fpgaEnumerate(const fpga_properties *filters,
 				uint32_t num_filters, fpga_token *tokens,
 				uint32_t max_tokens, uint32_t *num_matches);
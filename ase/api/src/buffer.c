@@ -33,6 +33,7 @@
 
 #include "ase_common.h"
 #include "ase_host_memory.h"
+#include "ase_zcopy.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -124,7 +125,8 @@ static void *sim_huge_mmap(void *addr, size_t length, int prot, int flags)
 /*
  * Allocate (mmap) new buffer
  */
-static fpga_result buffer_allocate(void **addr, uint64_t *len, int flags)
+static fpga_result buffer_allocate(void **addr, uint64_t *len, int flags,
+				   int *zcopy_fd)
 {
 	void *addr_local = NULL;
 
@@ -132,6 +134,30 @@ static fpga_result buffer_allocate(void **addr, uint64_t *len, int flags)
 
 	ASSERT_NOT_NULL(addr);
 
+	/* In zero-copy mode the buffer is backed by a memfd that is
+	   shared with the simulator. It is aligned like the huge page
+	   buffers below but uses normal pages. */
+	*zcopy_fd = -1;
+	if (ase_zcopy_enabled()) {
+		uint64_t align = 4 * KB;
+		if (*len > 2 * MB) {
+			*len = (*len + (1 * GB - 1)) & (~(1 * GB - 1));
+			align = 1 * GB;
+		} else if (*len > 4 * KB) {
+			*len = 2 * MB;
+			align = 2 * MB;
+		}
+
+		addr_local = ase_zcopy_alloc(*len, align, zcopy_fd);
+		if (addr_local != MAP_FAILED) {
+			*addr = addr_local;
+			return FPGA_OK;
+		}
+
+		FPGA_MSG("Zero-copy buffer allocation failed: %s",
+			 strerror(errno));
+	}
+
 	/* ! FPGA_BUF_PREALLOCATED, allocate memory using huge pages
 	   For buffer > 2M, use 1G-hugepage to ensure pages are
 	   contiguous */
@@ -200,97 +226,26 @@ static fpga_result buffer_release(void *addr, uint64_t len)
 }
 
 
-#define MAPS_BUF_SZ 4096
 /*
  * Confirm that a page is mapped at vaddr and that it is at least
  * req_page_bytes.
  */
 static fpga_result check_mapped_page(void *vaddr, size_t req_page_bytes)
 {
-	char line[MAPS_BUF_SZ];
-	uint64_t addr = (uint64_t)vaddr;
-	// Need to test for huge pages? 4KB page tests are easier.
-	bool test_huge_page = (req_page_bytes > 4096);
-
-	FILE *f;
-	if (!test_huge_page) {
-		// maps is simple and quick to read. Use it when checking only that a
-		// region is mapped. The test is still expensive and just proving that
-		// the page is mapped, which will eventually trigger a SEGV anyway.
-		// As a simulator performance compromise, we test the first 200
-		// requests and then back off, testing only 1% after that.
-		static uint64_t n_tested;
-		n_tested += 1;
-		if ((n_tested > 200) && ((n_tested % 100) != 0)) {
-			return FPGA_OK;
-		}
+	int64_t page_len = ase_host_memory_va_page_len((uint64_t)vaddr);
 
-		f = fopen("/proc/self/maps", "r");
-	} else {
-		// smaps can tell use the page size. Use it when confirming that the
-		// page is mapped as a huge page.
-		f = fopen("/proc/self/smaps", "r");
-	}
-	if (f == NULL) {
+	if (page_len < 0)
 		return FPGA_EXCEPTION;
-	}
 
-	// Deallocate the file buffer. This hurts performance, but is important for
-	// accuracy since the buffer will be allocated within the address space
-	// being checked.
-	setvbuf(f, (char *)NULL, _IONBF, 0);
-
-	while (fgets(line, MAPS_BUF_SZ, f)) {
-		unsigned long long start, end;
-		char *tmp0;
-		char *tmp1;
-
-		// Range entries begin with <start addr>-<end addr>
-		start = strtoll(line, &tmp0, 16);
-		// Was a number found and is the next character a dash?
-		if ((tmp0 == line) || (*tmp0 != '-')) {
-			// No -- not a range
-			continue;
-		}
-
-		end = strtoll(++tmp0, &tmp1, 16);
-		// Keep search if not a number or the address isn't in range.
-		if ((tmp0 == tmp1) || (start > addr) || (end <= addr)) {
-			continue;
-		}
+	// Nothing mapped at vaddr
+	if (page_len == 0)
+		return FPGA_NOT_FOUND;
 
-		// Found the region. The test is successful if all we needed was
-		// proof that the 4KB page is mapped.
-		if (!test_huge_page) {
-			fclose(f);
-			return FPGA_OK;
-		}
-
-		while (fgets(line, MAPS_BUF_SZ, f)) {
-			// Look for KernelPageSize
-			unsigned page_kb;
-			int ret = sscanf_s_u(line, "KernelPageSize: %d kB", &page_kb);
-			if (ret == 0)
-				continue;
-
-			fclose(f);
-
-			if (ret < 1 || page_kb == 0) {
-				return FPGA_EXCEPTION;
-			}
-
-			// Is the page large enough?
-			if (1024 * page_kb < req_page_bytes) {
-				return FPGA_EXCEPTION;
-			}
-
-			return FPGA_OK;
-		}
-	}
+	// Is the page large enough?
+	if ((uint64_t)page_len < req_page_bytes)
+		return FPGA_EXCEPTION;
 
-	// We couldn't find an entry for this addr in smaps.
-	fclose(f);
-	return FPGA_NOT_FOUND;
+	return FPGA_OK;
 }
 
 
@@ -302,6 +257,7 @@ fpga_result __FPGA_API__ ase_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
 	fpga_result result = FPGA_OK;
 	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
 	int err;
+	int zcopy_fd = -1;
 
 	bool preallocated = (flags & FPGA_BUF_PREALLOCATED);
 	bool quiet = (flags & FPGA_BUF_QUIET);
@@ -385,7 +341,7 @@ fpga_result __FPGA_API__ ase_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
 			len = pg_size + (len & ~(pg_size - 1));
 		}
 
-		result = buffer_allocate(&addr, &len, flags);
+		result = buffer_allocate(&addr, &len, flags, &zcopy_fd);
 		if (result != FPGA_OK) {
 			goto out_unlock;
 		}
@@ -427,6 +383,15 @@ fpga_result __FPGA_API__ ase_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
 		goto out_unlock;
 	}
 
+	/* Let the simulator map a zero-copy buffer. If it can't, DMA
+	 * to the buffer still works through the message path. */
+	if (zcopy_fd >= 0) {
+		if (ase_zcopy_register(zcopy_fd, addr, _handle->afu_idx,
+				       dma_map_iova, len) != 0) {
+			FPGA_MSG("Simulator did not map zero-copy buffer");
+		}
+	}
+
 	/* Update buf_addr */
 	if (buf_addr)
 		*buf_addr = addr;
@@ -435,6 +400,10 @@ fpga_result __FPGA_API__ ase_fpgaPrepareBuffer(fpga_handle handle, uint64_t len,
 	result = FPGA_OK;
 
 out_unlock:
+	/* The simulator holds its own reference to the memfd */
+	if (zcopy_fd >= 0)
+		close(zcopy_fd);
+
 	err = pthread_mutex_unlock(&_handle->lock);
 	if (err) {
 		FPGA_ERR("pthread_mutex_unlock() failed: %s", strerror(err));
@@ -470,6 +439,10 @@ fpga_result __FPGA_API__ ase_fpgaReleaseBuffer(fpga_handle handle, uint64_t wsid
 
 	bool preallocated = (wm->flags & FPGA_BUF_PREALLOCATED);
 
+	/* The simulator must drop a zero-copy mapping before the IOVA
+	 * can be reused */
+	ase_zcopy_drop(_handle->afu_idx, iova, len);
+
 	/* Simulated equivalent of unpinning the page */
 	if (ase_host_memory_free_iova(_handle->afu_idx, iova) != 0) {
 		FPGA_MSG("FPGA_PORT_DMA_UNMAP IOVA release failed!");
@@ -32,6 +32,7 @@
 #include <opae/utils.h>
 #include "common_int.h"
 #include "ase_common.h"
+#include "ase.h"
 
 #include <errno.h>
 #include <malloc.h>		/* malloc */
@@ -292,3 +293,147 @@ fpga_result __FPGA_API__ ase_fpgaReset(fpga_handle handle)
 
 	return FPGA_OK;
 }
+
+
+/*
+ * Asynchronous MMIO reads (ASE extension, see ase.h)
+ */
+_Static_assert(ASE_MMIO_MAX_ASYNC_READS == MMIO_MAX_ASYNC_READS,
+	       "ase.h async MMIO window doesn't match the scoreboard");
+
+static fpga_result mmio_read_async_common(fpga_handle handle, uint64_t offset,
+					  int width, ase_mmio_read_token *token)
+{
+	struct _fpga_handle *_handle = (struct _fpga_handle *) handle;
+	uint64_t align = (width == MMIO_WIDTH_64) ? sizeof(uint64_t) : sizeof(uint32_t);
+
+	if (NULL == handle) {
+		FPGA_MSG("handle is NULL");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (NULL == token) {
+		FPGA_MSG("token is NULL");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (!_handle->fpgaMMIO_is_mapped)
+		_handle->fpgaMMIO_is_mapped = true;
+
+	if (NULL == mmio_afu_vbase)
+		return FPGA_NOT_FOUND;
+
+	if (offset % align != 0) {
+		FPGA_MSG("Misaligned MMIO access");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (offset > MMIO_AFU_LENGTH) {
+		FPGA_MSG("Offset out of bounds");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (mmio_read_async(offset, _handle->afu_idx, width, token) != 0)
+		return FPGA_BUSY;
+
+	return FPGA_OK;
+}
+
+fpga_result __FPGA_API__ ase_fpgaReadMMIO32Async(fpga_handle handle,
+					     uint32_t mmio_num,
+					     uint64_t offset,
+					     ase_mmio_read_token *token)
+{
+	UNUSED_PARAM(mmio_num);
+	return mmio_read_async_common(handle, offset, MMIO_WIDTH_32, token);
+}
+
+fpga_result __FPGA_API__ ase_fpgaReadMMIO64Async(fpga_handle handle,
+					     uint32_t mmio_num,
+					     uint64_t offset,
+					     ase_mmio_read_token *token)
+{
+	UNUSED_PARAM(mmio_num);
+	return mmio_read_async_common(handle, offset, MMIO_WIDTH_64, token);
+}
+
+fpga_result __FPGA_API__ ase_fpgaMMIOReadWait(fpga_handle handle,
+					  ase_mmio_read_token token,
+					  uint64_t *value)
+{
+	if (NULL == handle) {
+		FPGA_MSG("handle is NULL");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (NULL == value) {
+		FPGA_MSG("value is NULL");
+		return FPGA_INVALID_PARAM;
+	}
+
+	if (mmio_read_async_wait(token, value) != 0) {
+		FPGA_MSG("Token is not an outstanding MMIO read");
+		return FPGA_INVALID_PARAM;
+	}
+
+	return FPGA_OK;
+}
+
+fpga_result __FPGA_API__ ase_fpgaReadMMIO64Batch(fpga_handle handle,
+					     uint32_t mmio_num,
+					     const uint64_t *offsets,
+					     uint64_t *values, uint32_t count)
+{
+	ase_mmio_read_token tokens[MMIO_MAX_ASYNC_READS];
+	uint32_t head = 0;	// Oldest read still in flight
+	uint32_t tail = 0;	// Next read to issue
+	fpga_result result = FPGA_OK;
+
+	if ((NULL == offsets) || (NULL == values)) {
+		FPGA_MSG("offsets or values is NULL");
+		return FPGA_INVALID_PARAM;
+	}
+
+	while (head < count) {
+		// Issue as many reads as the window allows
+		while ((tail < count) && (tail - head < MMIO_MAX_ASYNC_READS)) {
+			result = ase_fpgaReadMMIO64Async(handle, mmio_num, offsets[tail],
+							 &tokens[tail % MMIO_MAX_ASYNC_READS]);
+			if (result == FPGA_BUSY)
+				break;
+			if (result != FPGA_OK)
+				goto out_drain;
+			tail += 1;
+		}
+
+		if (head == tail) {
+			// Other threads hold the whole window. Read this one
+			// the blocking way.
+			result = ase_fpgaReadMMIO64(handle, mmio_num, offsets[head],
+						    &values[head]);
+			if (result != FPGA_OK)
+				return result;
+			head += 1;
+			tail += 1;
+			continue;
+		}
+
+		// Collect the oldest response
+		result = ase_fpgaMMIOReadWait(handle, tokens[head % MMIO_MAX_ASYNC_READS],
+					      &values[head]);
+		if (result != FPGA_OK)
+			goto out_drain;
+		head += 1;
+	}
+
+	return FPGA_OK;
+
+out_drain:
+	// Release the slots of reads already in flight
+	while (head < tail) {
+		ase_fpgaMMIOReadWait(handle, tokens[head % MMIO_MAX_ASYNC_READS],
+				     &values[head]);
+		head += 1;
+	}
+	return result;
+}
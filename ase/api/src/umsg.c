@@ -100,16 +100,14 @@ fpga_result ase_fpgaTriggerUmsg(fpga_handle handle, uint64_t value)
 	fpga_result result            = FPGA_OK;
 	uint64_t *umsg_ptr            = NULL;
 
-	// TODO: make thread-safe and check for errors
-
 	result = ase_fpgaGetUmsgPtr(handle, &umsg_ptr);
 	if (result != FPGA_OK) {
 		FPGA_ERR("Failed to get UMsg buffer");
 		return result;
 	}
 
-	// Assign Value to UMsg
-	*((volatile uint64_t *) (umsg_ptr)) = value;
+	// Assign Value to UMsg and send exactly one UMsg for it
+	umsg_send(0, &value);
 
 	return result;
 }
@@ -52,7 +52,15 @@ set(ASESW_FILE_LIST
   ${ASE_SERVER_SRC}/ipc_mgmt_ops.c
   ${ASE_SERVER_SRC}/ase_shbuf.c
   ${ASE_SERVER_SRC}/protocol_backend.c
+  ${ASE_SERVER_SRC}/ase_event.c
   ${ASE_SERVER_SRC}/mqueue_ops.c
+  ${ASE_SERVER_SRC}/ase_mq_ring.c
+  ${ASE_SERVER_SRC}/ase_mq_mux.c
+  ${ASE_SERVER_SRC}/ase_zcopy.c
+  ${ASE_SERVER_SRC}/ase_log.c
+  ${ASE_SERVER_SRC}/ase_trace.c
+  ${ASE_SERVER_SRC}/ase_pool.c
+  ${ASE_SERVER_SRC}/ase_wc.c
   ${ASE_SERVER_SRC}/error_report.c
   ${ASE_SERVER_SRC}/linked_list_ops.c
   ${ASE_SERVER_SRC}/randomness_control.c)
@@ -66,6 +66,8 @@ package ase_pkg;
       int 	  enable_cl_view;
       int 	  usr_tps;
       int 	  phys_memory_available_gb;
+      int 	  enable_ipc_rings;
+      int 	  write_combine_cycles;
    } ase_cfg_t;
    static ase_cfg_t cfg;
 
@@ -234,6 +234,8 @@ package ase_sim_pkg;
         cfg.enable_cl_view           = cfg_in.enable_cl_view           ;
         cfg.usr_tps                  = cfg_in.usr_tps                  ;
         cfg.phys_memory_available_gb = cfg_in.phys_memory_available_gb ;
+        cfg.enable_ipc_rings         = cfg_in.enable_ipc_rings         ;
+        cfg.write_combine_cycles     = cfg_in.write_combine_cycles     ;
     end
     endtask
 
@@ -316,10 +316,13 @@ module ccip_emulator
 
     // Data exchange for READ, WRITE system
     import "DPI-C" function void rd_memline_req_dex(inout cci_pkt pkg);
-    import "DPI-C" function void rd_memline_rsp_dex(inout cci_pkt pkg);
-    logic rd_memline_active;
-    cci_pkt Rx0_pkt;
-    RxHdr_t Rx0_hdr;
+    import "DPI-C" function int rd_memline_rsp_dex(inout cci_pkt pkg);
+
+    // Reads sent to the application, oldest first, waiting for responses.
+    // Must be less than MEMLINE_LOCAL_FIFO_SIZE in protocol_backend.c.
+    localparam RD_MAX_PENDING = 64;
+    cci_pkt rd_pend_pkt[$];
+    RxHdr_t rd_pend_hdr[$];
 
     import "DPI-C" function void wr_memline_req_dex(inout cci_pkt pkg);
     import "DPI-C" function void wr_memline_rsp_dex(inout cci_pkt pkg);
@@ -1502,7 +1505,8 @@ module ccip_emulator
         if (ase_reset) begin
             cf2as_latbuf_ch0_read <= 0;
         end
-        else if (~cf2as_latbuf_ch0_empty && ~rdrsp_full) begin
+        else if (~cf2as_latbuf_ch0_empty && ~rdrsp_full &&
+                 (rd_pend_pkt.size() < RD_MAX_PENDING)) begin
             cf2as_latbuf_ch0_read <= 1;
         end
         else begin
@@ -1523,45 +1527,50 @@ module ccip_emulator
 
         // Preserve intermediate request packet.  It will be completed by
         // the response in cf2as_ch0_rdrsp_to_rdrsp_fifo.
-        Rx0_pkt <= Tx0_pkt;
-        Rx0_hdr <= cf2as_latbuf_rx0hdr;
+        rd_pend_pkt.push_back(Tx0_pkt);
+        rd_pend_hdr.push_back(cf2as_latbuf_rx0hdr);
     end
     endtask
 
     // TASK: cf2as_ch0_rdrsp_to_rdrsp_fifo -- receive read response from application
+    // Responses arrive in request order. The oldest pending read is forwarded
+    // once the application has responded.
     task cf2as_ch0_rdrsp_to_rdrsp_fifo();
+        cci_pkt Rx0_pkt;
     begin
+        Rx0_pkt = rd_pend_pkt[0];
+
         // Read line fulfillment
-        rd_memline_rsp_dex(Rx0_pkt);
+        if (rd_memline_rsp_dex(Rx0_pkt) != 0) begin
+            // Write to rdrsp_fifo
+            rdrsp_data_in <= unpack_ccipkt_to_vector(Rx0_pkt);
+            rdrsp_hdr_in <= rd_pend_hdr[0];
+            rdrsp_write <= 1;
 
-        // Write to rdrsp_fifo
-        rdrsp_data_in <= unpack_ccipkt_to_vector(Rx0_pkt);
-        rdrsp_hdr_in <= Rx0_hdr;
+            void'(rd_pend_pkt.pop_front());
+            void'(rd_pend_hdr.pop_front());
+        end
+        else begin
+            rdrsp_write <= 0;
+        end
     end
     endtask
 
     // Read request glue process
     always @(posedge clk) begin
-        if (ase_reset) begin
-            rd_memline_active <= 0;
-        end
-        else if (cf2as_latbuf_ch0_valid) begin
+        if (~ase_reset && cf2as_latbuf_ch0_valid) begin
             cf2as_ch0_rdreq();
-            rd_memline_active <= 1;
-        end
-        else begin
-            rd_memline_active <= 0;
         end
     end
 
-    // Read response glue process
+    // Read response glue process. Pending reads are kept through reset
+    // so that requests and application responses stay matched.
     always @(posedge clk) begin
         if (ase_reset) begin
             rdrsp_write <= 0;
         end
-        else if (rd_memline_active) begin
+        else if ((rd_pend_pkt.size() != 0) && ~rdrsp_full) begin
             cf2as_ch0_rdrsp_to_rdrsp_fifo();
-            rdrsp_write <= 1;
         end
         else begin
             rdrsp_write <= 0;
@@ -81,7 +81,9 @@ module ase_hssi_emulator
 
     import "DPI-C" context function void hssi_reset(input int chan);
 
-    import "DPI-C" context function void hssi_stream_host_to_afu(
+    // Returns the first cycle at which to call again, unless AFU->host
+    // data is sent sooner. Idle channels skip the calls in between.
+    import "DPI-C" context function longint hssi_stream_host_to_afu(
                                             input  longint cycle,
                                             input  int chan,
                                             output int tvalid,
@@ -159,6 +161,7 @@ module ase_hssi_emulator
 `endif //  `ifndef ASE_DISABLE_LOGGER
 
     longint cycle_counter;
+    longint rx_next_cycle;
     int rx_tvalid;
     int rx_tlast;
     t_tdata rx_tdata;
@@ -182,9 +185,18 @@ module ase_hssi_emulator
 
     // Receive one cycle's worth of HSSI data via DPI-C
     task get_rx_hssi_messages();
-        // Call the software even if flow control prevents a new message
-        hssi_stream_host_to_afu(cycle_counter, CHANNEL_ID,
-                                rx_tvalid, rx_tlast, rx_tdata, rx_tuser, rx_tkeep);
+        // Call the software even if flow control prevents a new message.
+        // Skip the call while the software reports the channel is idle.
+        if (cycle_counter >= rx_next_cycle)
+        begin
+            rx_next_cycle = hssi_stream_host_to_afu(cycle_counter, CHANNEL_ID,
+                                                    rx_tvalid, rx_tlast, rx_tdata, rx_tuser, rx_tkeep);
+        end
+        else
+        begin
+            rx_tvalid = 0;
+        end
+
         data_rx.rx.tvalid <= rx_tvalid[0];
         if (rx_tvalid[0])
         begin
@@ -206,6 +218,9 @@ module ase_hssi_emulator
         hssi_stream_afu_to_host(cycle_counter, CHANNEL_ID, 1,
                                    (data_tx.tx.tlast ? 1 : 0),
                                    tx_tdata, tx_tuser, tx_tkeep);
+
+        // The plugin may respond to the new data
+        rx_next_cycle = 0;
     endtask // send_tx_hssi_messages
 
 
@@ -223,6 +238,7 @@ module ase_hssi_emulator
             data_rx.rx.tuser <= '0;
 
             data_tx.tready <= 1'b0;
+            rx_next_cycle = 0;
             hssi_reset(CHANNEL_ID);
         end
         else
@@ -53,7 +53,12 @@ module ase_pcie_ss_emulator
     parameter NUM_AFU_PORTS = 1,
     parameter PF_NUM = 0,
     parameter VF_NUM = 0,
-    parameter VF_ACTIVE = 1
+    parameter VF_ACTIVE = 1,
+
+    // Host->AFU beats fetched per DPI-C call. The beats are queued here
+    // and software is called again once the AFU has consumed them. 1
+    // fetches a single beat every cycle.
+    parameter H2A_BATCH_BEATS = 4
     )
    (
     input  logic pClk,
@@ -159,6 +164,14 @@ module ase_pcie_ss_emulator
                                             output t_tuser tuser,
                                             output t_tkeep tkeep);
 
+    import "DPI-C" context function int pcie_ss_stream_host_to_afu_batch(
+                                            input  longint cycle,
+                                            input  int max_beats,
+                                            output bit [H2A_BATCH_BEATS-1:0] tlast,
+                                            output t_tdata tdata[H2A_BATCH_BEATS],
+                                            output t_tuser tuser[H2A_BATCH_BEATS],
+                                            output t_tkeep tkeep[H2A_BATCH_BEATS]);
+
     import "DPI-C" context function void pcie_ss_stream_afu_to_host(
                                             input  longint cycle,
                                             input  int tvalid,
@@ -415,6 +428,14 @@ module ase_pcie_ss_emulator
     t_tkeep tx_tkeep;
     t_tuser tx_tuser;
 
+    // Queue of host->AFU beats from pcie_ss_stream_host_to_afu_batch()
+    bit [H2A_BATCH_BEATS-1:0] rx_q_tlast;
+    t_tdata rx_q_tdata[H2A_BATCH_BEATS];
+    t_tkeep rx_q_tkeep[H2A_BATCH_BEATS];
+    t_tuser rx_q_tuser[H2A_BATCH_BEATS];
+    int rx_q_cnt = 0;
+    int rx_q_idx = 0;
+
     always_ff @(posedge clk)
     begin
         if (ase_reset)
@@ -434,10 +455,47 @@ module ase_pcie_ss_emulator
 
     // Receive one cycle's worth of TLP data via DPI-C
     task get_rx_tlp_messages();
-        // Call the software even if flow control prevents a new message
-        pcie_ss_stream_host_to_afu(cycle_counter,
-                                   (rx_tready ? 1 : 0),
-                                   rx_tvalid, rx_tlast, rx_tdata, rx_tuser, rx_tkeep);
+        if ((H2A_BATCH_BEATS > 1) && rx_tready && (rx_q_idx == rx_q_cnt))
+        begin
+            // Refill the queue
+            rx_q_cnt = pcie_ss_stream_host_to_afu_batch(cycle_counter, H2A_BATCH_BEATS,
+                                                        rx_q_tlast, rx_q_tdata,
+                                                        rx_q_tuser, rx_q_tkeep);
+            rx_q_idx = 0;
+        end
+        else if (rx_q_idx != rx_q_cnt)
+        begin
+            // Beats are still queued. Call the software without flow
+            // control credit so that it keeps receiving memory responses
+            // and expiring combined writes while the queue drains. It
+            // returns no beat, so the outputs are overwritten below.
+            pcie_ss_stream_host_to_afu(cycle_counter, 0,
+                                       rx_tvalid, rx_tlast, rx_tdata, rx_tuser, rx_tkeep);
+        end
+
+        if (rx_q_idx != rx_q_cnt)
+        begin
+            // Queued beats are sent first
+            rx_tvalid = (rx_tready ? 1 : 0);
+            rx_tlast = rx_q_tlast[rx_q_idx];
+            rx_tdata = rx_q_tdata[rx_q_idx];
+            rx_tkeep = rx_q_tkeep[rx_q_idx];
+            rx_tuser = rx_q_tuser[rx_q_idx];
+            if (rx_tready) rx_q_idx = rx_q_idx + 1;
+        end
+        else if ((H2A_BATCH_BEATS == 1) || !rx_tready)
+        begin
+            // Call the software even if flow control prevents a new message
+            pcie_ss_stream_host_to_afu(cycle_counter,
+                                       (rx_tready ? 1 : 0),
+                                       rx_tvalid, rx_tlast, rx_tdata, rx_tuser, rx_tkeep);
+        end
+        else
+        begin
+            // Software had nothing to send
+            rx_tvalid = 0;
+        end
+
         if (rx_tready)
         begin
             pcie_rx_if.tvalid <= rx_tvalid[0];
@@ -479,6 +537,8 @@ module ase_pcie_ss_emulator
             pcie_rx_if.tuser_vendor <= '0;
 
             pcie_tx_if.tready <= 1'b0;
+            rx_q_cnt = 0;
+            rx_q_idx = 0;
             pcie_ss_reset();
         end
         else
@@ -34,7 +34,10 @@
 
 #include "ase_common.h"
 #include "ase_host_memory.h"
+#include "ase_vma.h"
+#include "ase_mq_ring.h"
 #include "ase_pcie_ats.h"
+#include "ase_zcopy.h"
 
 const int TID_DELAY = 10000;   // Wait time for generating TID
 
@@ -44,14 +47,8 @@ const int umsg_byteindex_arr[] = {
 };
 
 typedef struct mmio_s {
-	// MMIO Mutex Lock, initilize it here
-	pthread_mutex_t mmio_port_lock;
-
 	struct buffer_t *mmio_region;      // CSR map storage
 
-	// MMIO Read response watcher
-	int glbl_mmio_tid;       	       // MMIO Tid
-
 	pthread_t mmio_watch_tid;	       // Tracker thread Id
 	mmio_t *mmio_rsp_pkt;              // MMIO Response packet handoff control
 } MMIO_S;
@@ -62,6 +59,10 @@ typedef struct umas_s {
 	struct buffer_t *umas_region;	   // UMAS region
 
 	char *umsg_addr_array[NUM_UMSG_PER_AFU];  // UMsg address array
+	char umsg_mirror[NUM_UMSG_PER_AFU][CL_BYTE_WIDTH];  // Last data sent
+	pthread_mutex_t umsg_lock;         // Serializes UMsg sends
+	bool umsg_poll;                    // Watcher thread running
+	volatile uint32_t umsg_doorbell;   // Wakes the watcher from its sleep
 } UMAS_S;
 
 typedef struct membus_s {
@@ -75,15 +76,32 @@ typedef struct pcie_msg_s {
 } PCIE_MSG_S;
 
 // MMIO Scoreboard (used in APP-side only)
+// - Slot ownership is tracked in mmio_slot_mask, one bit per line
+// - tid = generation:slot, so a response finds its line without a search
+// - rx_flag is the line's futex word; a reader sleeps on its own slot
+//   and is woken only by its own response
 struct mmio_scoreboard_line_t {
 	uint64_t   data;
 	int        tid;
 	bool       tx_flag;
-	bool       rx_flag;
-};
+	uint32_t   rx_flag;
+	uint32_t   waiters;
+	uint32_t   gen;
+} __attribute__((aligned(64)));
 
 volatile struct mmio_scoreboard_line_t mmio_table[MMIO_MAX_OUTSTANDING];
 
+// Busy slots. Bumping mmio_slot_event wakes threads waiting for a slot.
+static volatile uint64_t mmio_slot_mask;
+static volatile uint32_t mmio_slot_event;
+static volatile uint32_t mmio_slot_waiters;
+
+// Mirror MMIO writes into the mmio_afu_vbase shadow map
+static bool mmio_shadow_enable = true;
+
+// Asynchronous MMIO reads issued and not yet claimed by mmio_read_async_wait()
+static volatile uint32_t mmio_async_reads;
+
 // Timestamp char array
 char tstamp_string[20];
 
@@ -137,6 +155,16 @@ int userbuf_index_count;              // User count/index
 
 // ASE Capability register
 struct ase_capability_t ase_capability;
+// Features offered at ASE_INIT and those negotiated with the simulator
+#define APP_FEATURES (ASE_FEATURE_UMSG | ASE_FEATURE_INTR | \
+		      ASE_FEATURE_MMIO512 | ASE_FEATURE_PIN_NOTES)
+static uint32_t ctrl_features;
+
+// Sends on app2sim_portctrl_req_tx, including batched pinned page notes
+static pthread_mutex_t portctrl_lock = PTHREAD_MUTEX_INITIALIZER;
+// ASE_PIN_NOTES message being built, see pin_note_add()
+static uint64_t pin_notes_msg[ASE_MQ_MSGSIZE / sizeof(uint64_t)];
+static uint32_t pin_notes_count;
 static uint32_t session_exist_status;
 static uint32_t mq_exist_status;
 static uint32_t mmio_exist_status;
@@ -146,10 +174,20 @@ static uint32_t pcie_msg_exist_status;
 static bool pcie_atc_active;
 
 static void *membus_rd_watcher(void *arg);
+static void membus_rd_workers_start(void);
+static void membus_rd_workers_stop(void);
 static void *membus_wr_watcher(void *arg);
 
 static void *pcie_msg_watcher(void *arg);
 
+static void umsg_lines_init(void);
+static void umsg_watcher_stop(void);
+static int session_handshake(void);
+static void set_capability(const struct ase_portctrl_rsp *rsp);
+static void pin_notes_flush(void);
+
+static int count_mmio_rsp_pending(void);
+
 // Debug logs
 #ifdef ASE_DEBUG
 FILE *fp_pagetable_log = (FILE *) NULL;
@@ -199,6 +237,7 @@ void close_mq(void)
 	mqueue_close(app2sim_membus_wr_rsp_tx);
 	mqueue_close(sim2app_pcie_msg_rx);
 	mqueue_close(app2sim_pcie_msg_tx);
+	ase_mq_ring_detach();
 }
 
 /*
@@ -218,27 +257,70 @@ void failure_cleanup(void)
 }
 
 /*
- * MMIO Generate TID
- * - Creation of TID must be atomic
+ * MMIO scoreboard slot allocation
+ * - Claims the lowest free slot with a CAS on the busy mask, so the
+ *   sim-side tags stay small when few requests are outstanding
+ * - When all slots are busy, spin briefly then sleep until one frees
+ * - Returns the slot with a fresh tid written to the line
  */
-uint32_t generate_mmio_tid(void)
+static int mmio_slot_alloc(void)
 {
-	// Return value
-	uint32_t ret_mmio_tid;
-
-	while (count_mmio_tid_used() == MMIO_MAX_OUTSTANDING) {
+	uint64_t mask;
+	uint32_t event;
+	uint32_t gen;
+	int slot_idx;
+	int spin = 0;
+
+	mask = __atomic_load_n(&mmio_slot_mask, __ATOMIC_ACQUIRE);
+	while (1) {
+		if (mask == UINT64_MAX) {
+			if (spin < ASE_SPIN_LIMIT) {
+				ase_cpu_relax();
+				spin++;
+			} else {
 #ifdef ASE_DEBUG
-		ASE_INFO("MMIO TIDs have run out --- waiting !\n");
+				ASE_INFO("MMIO TIDs have run out --- waiting !\n");
 #endif
-		usleep(1);
+				__atomic_fetch_add(&mmio_slot_waiters, 1, __ATOMIC_SEQ_CST);
+				event = __atomic_load_n(&mmio_slot_event, __ATOMIC_SEQ_CST);
+				if (__atomic_load_n(&mmio_slot_mask, __ATOMIC_SEQ_CST) == UINT64_MAX)
+					ase_futex_wait(&mmio_slot_event, event, 0);
+				__atomic_fetch_sub(&mmio_slot_waiters, 1, __ATOMIC_SEQ_CST);
+			}
+			mask = __atomic_load_n(&mmio_slot_mask, __ATOMIC_ACQUIRE);
+			continue;
+		}
+
+		slot_idx = __builtin_ctzll(~mask);
+		if (__atomic_compare_exchange_n(&mmio_slot_mask, (uint64_t *) &mask,
+				mask | (UINT64_C(1) << slot_idx), false,
+				__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+			break;
 	}
 
-	// Increment and mask
-	ret_mmio_tid = io_s.glbl_mmio_tid & MMIO_TID_BITMASK;
-	io_s.glbl_mmio_tid++;
+	// Owned now, no other thread touches the line until it is released
+	gen = mmio_table[slot_idx].gen + 1;
+	mmio_table[slot_idx].gen = gen;
+	mmio_table[slot_idx].tid = ((gen << MMIO_SLOT_BITWIDTH) | slot_idx) & MMIO_TID_BITMASK;
+	mmio_table[slot_idx].rx_flag = 0;
+	__atomic_store_n(&mmio_table[slot_idx].tx_flag, true, __ATOMIC_RELEASE);
+
+	return slot_idx;
+}
+
+
+/*
+ * Return a scoreboard slot to the free mask and wake slot waiters
+ */
+static void mmio_slot_release(int slot_idx)
+{
+	mmio_table[slot_idx].tx_flag = false;
+	__atomic_store_n(&mmio_table[slot_idx].rx_flag, 0, __ATOMIC_RELAXED);
+	__atomic_fetch_and(&mmio_slot_mask, ~(UINT64_C(1) << slot_idx), __ATOMIC_RELEASE);
 
-	// Return ID
-	return ret_mmio_tid;
+	__atomic_fetch_add(&mmio_slot_event, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&mmio_slot_waiters, __ATOMIC_SEQ_CST))
+		ase_futex_wake(&mmio_slot_event);
 }
 
 /*
@@ -294,20 +376,17 @@ void *mmio_response_watcher(void *arg)
 			} else {
 				// MMIO Read response (for credit count only)
 				if (io_s.mmio_rsp_pkt->write_en == MMIO_READ_REQ) {
-					mmio_table[slot_idx].tid =
-						io_s.mmio_rsp_pkt->tid;
 					mmio_table[slot_idx].data =
 						io_s.mmio_rsp_pkt->qword[0];
-					mmio_table[slot_idx].tx_flag =
-						true;
-					mmio_table[slot_idx].rx_flag =
-						true;
+					__atomic_store_n(&mmio_table[slot_idx].rx_flag,
+						1, __ATOMIC_SEQ_CST);
+
+					// Wake the reader of this slot, if asleep
+					if (__atomic_load_n(&mmio_table[slot_idx].waiters, __ATOMIC_SEQ_CST))
+						ase_futex_wake(&mmio_table[slot_idx].rx_flag);
 				} else if (io_s.mmio_rsp_pkt->write_en == MMIO_WRITE_REQ) {
 					// MMIO Write response (for credit count only)
-					mmio_table[slot_idx].tx_flag =
-						false;
-					mmio_table[slot_idx].rx_flag =
-						false;
+					mmio_slot_release(slot_idx);
 				}
 #ifdef ASE_DEBUG
 				else {
@@ -337,7 +416,7 @@ void send_swreset(void)
 {
 	ASE_MSG("\n");
 	ASE_MSG("Issuing Soft Reset... \n");
-	while (count_mmio_tid_used() != 0) {
+	while (count_mmio_rsp_pending() != 0) {
 		sleep(1);
 	}
 
@@ -378,6 +457,7 @@ void session_init(void)
 	FUNC_CALL_ENTRY;
 
 	int rc = 0;
+	char *str_env;
 
 	// Start clock
 	clock_gettime(CLOCK_MONOTONIC, &start_time_snapshot);
@@ -426,6 +506,10 @@ void session_init(void)
 
 		ASE_INFO("Initializing simulation session ... \n");
 
+		// Use the simulator's shared memory rings if it created them
+		if (ase_mq_ring_attach() == 0)
+			ASE_MSG("Using shared memory rings for messaging\n");
+
 		app2sim_alloc_tx =
 			mqueue_open(mq_array[0].name, mq_array[0].perm_flag);
 		app2sim_mmioreq_tx =
@@ -492,9 +576,6 @@ void session_init(void)
 		}
 #endif
 
-		// Set MMIO Tid to 0
-		io_s.glbl_mmio_tid = 0;
-
 		// Thread error integer
 		int thr_err;
 
@@ -504,13 +585,16 @@ void session_init(void)
 		// Session start
 		ASE_MSG("Session started\n");
 
-		// Initialize session with PID
-		ase_portctrl(ASE_INIT, getpid());
+		// Initialize session with PID. Simulators with a session socket
+		// do it in one round trip.
+		if (session_handshake() != 0) {
+			ase_portctrl(ASE_INIT, getpid());
 
-		// Wait till session file is created
-		poll_for_session_id();
+			// Wait till session file is created
+			poll_for_session_id();
 
-		get_timestamp(tstamp_string);
+			get_timestamp(tstamp_string);
+		}
 
 		// Creating CSR map
 		ASE_MSG("Creating MMIO ...\n");
@@ -524,6 +608,11 @@ void session_init(void)
 			MMIO_AFU_OFFSET);
 		mmio_exist_status = ESTABLISHED;
 
+		// Nothing reads the shadow back (pointer access to MMIO is not
+		// supported), so env(ASE_MMIO_SHADOW)=0 lets writes skip it
+		str_env = getenv("ASE_MMIO_SHADOW");
+		mmio_shadow_enable = !(str_env && (strtol(str_env, NULL, 10) == 0));
+
 		ASE_MSG("AFU MMIO Virtual Base Address = %p\n",
 			(void *)mmio_afu_vbase);
 
@@ -544,9 +633,6 @@ void session_init(void)
 
 		// Start MMIO read response watcher watcher thread
 		ASE_MSG("Starting MMIO Read Response watcher ... \n");
-		rc = pthread_mutex_init(&io_s.mmio_port_lock, NULL);
-		if (rc != 0)
-			ASE_ERR("Failed to initialize the pthread_mutex_lock\n");
 		thr_err = pthread_create(&io_s.mmio_watch_tid, NULL,
 			&mmio_response_watcher, NULL);
 		if (thr_err != 0) {
@@ -555,19 +641,31 @@ void session_init(void)
 			ASE_MSG("SUCCESS\n");
 		}
 
-		ASE_MSG("Starting UMsg watcher ... \n");
+		umsg_lines_init();
 
-		// Initiate UMsg watcher
-		thr_err = pthread_create(&umas_s.umsg_watch_tid, NULL, &umsg_watcher, NULL);
-		if (thr_err != 0) {
-			failure_cleanup();
+		// UMsgs are sent by umsg_send() (fpgaTriggerUmsg) and by a watcher
+		// that polls the UMAS region for plain stores. env(ASE_UMSG_POLL)=0
+		// turns the watcher off, leaving exactly one UMsg per trigger.
+		str_env = getenv("ASE_UMSG_POLL");
+		umas_s.umsg_poll = !(str_env && (strtol(str_env, NULL, 10) == 0));
+		if (umas_s.umsg_poll) {
+			ASE_MSG("Starting UMsg watcher ... \n");
+
+			// Initiate UMsg watcher
+			thr_err = pthread_create(&umas_s.umsg_watch_tid, NULL, &umsg_watcher, NULL);
+			if (thr_err != 0) {
+				failure_cleanup();
+			} else {
+				ASE_MSG("SUCCESS\n");
+			}
 		} else {
-			ASE_MSG("SUCCESS\n");
+			ASE_MSG("UMsg watcher disabled, UMsgs are sent only when triggered\n");
 		}
 
 		// Initiate memory bus watcher
 		ASE_MSG("Starting memory bus watcher ... \n");
 		membus_exist_status = ESTABLISHED;
+		membus_rd_workers_start();
 		thr_err = pthread_create(&membus_s.membus_rd_watch_tid, NULL, &membus_rd_watcher, NULL);
 		if (thr_err != 0) {
 			failure_cleanup();
@@ -603,8 +701,11 @@ void session_init(void)
 			mmio_table[ii].tid = 0;
 			mmio_table[ii].data = 0;
 			mmio_table[ii].tx_flag = false;
-			mmio_table[ii].rx_flag = false;
+			mmio_table[ii].rx_flag = 0;
+			mmio_table[ii].waiters = 0;
+			mmio_table[ii].gen = 0;
 		}
+		mmio_slot_mask = 0;
 
 		// Session status
 		session_exist_status = ESTABLISHED;
@@ -722,10 +823,10 @@ void session_deinit(void)
 		if (umas_exist_status == ESTABLISHED) {
 			ASE_MSG("Closing Watcher threads\n");
 
-			// Update status
+			// Update status and close the UMsg thread before the
+			// region it watches goes away
 			umas_exist_status = NOT_ESTABLISHED;
-			// Close UMsg thread
-			pthread_cancel(umas_s.umsg_watch_tid);
+			umsg_watcher_stop();
 			cleanup_umas();
 		}
 #ifdef ASE_DEBUG
@@ -736,8 +837,9 @@ void session_deinit(void)
 		// Um-mapping CSR region
 		ASE_MSG("Deallocating MMIO map\n");
 		if (mmio_exist_status == ESTABLISHED) {
-			// Waiting for pending MMIO requests to complete
-			while (count_mmio_tid_used() != 0) {
+			// Waiting for pending MMIO requests to complete. Completed
+			// asynchronous reads that were never claimed don't count.
+			while (count_mmio_rsp_pending() != 0) {
 				sleep(1);
 			}
 			cleanup_mmio();
@@ -757,14 +859,18 @@ void session_deinit(void)
 			if (pthread_cancel(membus_s.membus_rd_watch_tid) != 0) {
 				fprintf(stderr, "Memory bus pthread_cancel failed -- Ignoring\n");
 			} else {
+				ase_mq_ring_wakeup();
 				pthread_join(membus_s.membus_rd_watch_tid, NULL);
 			}
 
 			if (pthread_cancel(membus_s.membus_wr_watch_tid) != 0) {
 				fprintf(stderr, "Memory bus pthread_cancel failed -- Ignoring\n");
 			} else {
+				ase_mq_ring_wakeup();
 				pthread_join(membus_s.membus_wr_watch_tid, NULL);
 			}
+
+			membus_rd_workers_stop();
 		}
 
 		// Stop message bus watcher
@@ -775,6 +881,7 @@ void session_deinit(void)
 			if (pthread_cancel(pcie_msg_s.pcie_msg_watch_tid) != 0) {
 				fprintf(stderr, "PCIe message bus pthread_cancel failed -- Ignoring\n");
 			} else {
+				ase_mq_ring_wakeup();
 				pthread_join(pcie_msg_s.pcie_msg_watch_tid, NULL);
 			}
 		}
@@ -792,20 +899,16 @@ void session_deinit(void)
 	} else {
 		ASE_MSG("Session already deinitialized, call ignored !\n");
 	}
-	// close message queue
-	close_mq();
-
-	// Lock deinit
-	if (pthread_mutex_unlock(&io_s.mmio_port_lock) != 0) {
-		ASE_MSG("Trying to shutdown mutex unlock\n");
-	}
-
-	// Stop running threads
-	pthread_cancel(umas_s.umsg_watch_tid);
-	pthread_join(umas_s.umsg_watch_tid, NULL);
+	// Stop running threads before the message queues go away. A
+	// watcher sleeping on a ring is woken to reach a cancellation point.
+	umsg_watcher_stop();
 	pthread_cancel(io_s.mmio_watch_tid);
+	ase_mq_ring_wakeup();
 	pthread_join(io_s.mmio_watch_tid, NULL);
 
+	// close message queue
+	close_mq();
+
 	if (io_s.mmio_rsp_pkt) {
 		free(io_s.mmio_rsp_pkt);
 		io_s.mmio_rsp_pkt = NULL;
@@ -835,48 +938,47 @@ void session_deinit(void)
 }
 
 /*
- * Get a scoreboard slot
+ * Get MMIO Slot by TID
+ * - The slot is encoded in the tid, the rest only validates it
  */
-static int find_empty_mmio_scoreboard_slot(void)
+int get_scoreboard_slot_by_tid(int in_tid)
 {
-	int ii;
-	int idx;
-	for (ii = 0; ii < MMIO_MAX_OUTSTANDING; ii = ii + 1) {
-		idx = ii % MMIO_MAX_OUTSTANDING;
-		if ((mmio_table[idx].tx_flag == false)
-			&& (mmio_table[idx].rx_flag == false))
-			return idx;
-	}
-	return 0xFFFF;
+	int slot_idx = in_tid & MMIO_SLOT_BITMASK;
+
+	if ((in_tid < 0) || (in_tid > (int) MMIO_TID_BITMASK) ||
+	    (__atomic_load_n(&mmio_table[slot_idx].tx_flag, __ATOMIC_ACQUIRE) != true) ||
+	    (mmio_table[slot_idx].tid != in_tid))
+		return 0xFFFF;
+
+	return slot_idx;
 }
 
 
 /*
- * Get MMIO Slot by TID
+ * Count MMIO TIDs in use
  */
-int get_scoreboard_slot_by_tid(int in_tid)
+int count_mmio_tid_used(void)
 {
-	int ii;
-	for (ii = 0; ii < MMIO_MAX_OUTSTANDING; ii = ii + 1) {
-		if ((mmio_table[ii].tx_flag == true)
-			&& (mmio_table[ii].tid == in_tid))
-			return ii;
-	}
-	return 0xFFFF;
+	return __builtin_popcountll(__atomic_load_n(&mmio_slot_mask, __ATOMIC_ACQUIRE));
 }
 
 
 /*
- * Count MMIO TIDs in use
+ * Count MMIO requests still waiting for a response
  */
-int count_mmio_tid_used(void)
+static int count_mmio_rsp_pending(void)
 {
-	int ii;
+	uint64_t mask = __atomic_load_n(&mmio_slot_mask, __ATOMIC_ACQUIRE);
+	int slot_idx;
 	int cnt = 0;
 
-	for (ii = 0; ii < MMIO_MAX_OUTSTANDING; ii = ii + 1)
-		if (mmio_table[ii].tx_flag == true)
+	while (mask) {
+		slot_idx = __builtin_ctzll(mask);
+		mask &= mask - 1;
+		if ((mmio_table[slot_idx].tx_flag == true) &&
+		    (__atomic_load_n(&mmio_table[slot_idx].rx_flag, __ATOMIC_ACQUIRE) == 0))
 			cnt++;
+	}
 
 	return cnt;
 }
@@ -884,32 +986,29 @@ int count_mmio_tid_used(void)
 
 /*
  * MMIO Request call
+ * - Claims a scoreboard slot, stamps the packet's tid and sends it
  * - Return index value
  */
 int mmio_request_put(struct mmio_t *pkt)
 {
 	FUNC_CALL_ENTRY;
 
+	// Update scoreboard
+	int mmiotable_idx;
+	mmiotable_idx = mmio_slot_alloc();
+	pkt->slot_idx = mmiotable_idx;
+	pkt->tid = mmio_table[mmiotable_idx].tid;
+	mmio_table[mmiotable_idx].data = pkt->qword[0];
+
 #ifdef ASE_DEBUG
 	print_mmiopkt(fp_mmioaccess_log, "Sent", pkt);
 #endif
 
-	// Update scoreboard
-	int mmiotable_idx;
-	mmiotable_idx = find_empty_mmio_scoreboard_slot();
-	if (mmiotable_idx != 0xFFFF) {
-		pkt->slot_idx = mmiotable_idx;
-		mmio_table[mmiotable_idx].tx_flag = true;
-		mmio_table[mmiotable_idx].rx_flag = false;
-		mmio_table[mmiotable_idx].tid = pkt->tid;
-		mmio_table[mmiotable_idx].data = pkt->qword[0];
-	} else {
-		ASE_ERR
-			("ASE Error generating MMIO TID, simulation cannot proceed !\n");
-		raise(SIGABRT);
-	}
+	// Pages pinned for the request are logged before it
+	pin_notes_flush();
 
-	// Send packet
+	// Send packet. The queue takes concurrent senders, so requests from
+	// different threads are not serialized here.
 	mqueue_send(app2sim_mmioreq_tx, (char *) pkt, sizeof(mmio_t));
 
 	FUNC_CALL_EXIT;
@@ -923,6 +1022,29 @@ int mmio_request_put(struct mmio_t *pkt)
 	return mmiotable_idx;
 }
 
+/*
+ * mmio_wait_response : Wait for the read response in a scoreboard slot.
+ * Spin briefly since responses are often quick, then sleep on the
+ * slot's own rx_flag until the MMIO response watcher sets it.
+ */
+static void mmio_wait_response(int slot_idx)
+{
+	volatile struct mmio_scoreboard_line_t *line = &mmio_table[slot_idx];
+	int spin = 0;
+
+	while (__atomic_load_n(&line->rx_flag, __ATOMIC_ACQUIRE) == 0) {
+		if (spin < ASE_SPIN_LIMIT) {
+			ase_cpu_relax();
+			spin++;
+			continue;
+		}
+
+		__atomic_fetch_add(&line->waiters, 1, __ATOMIC_SEQ_CST);
+		ase_futex_wait(&line->rx_flag, 0, 0);
+		__atomic_fetch_sub(&line->waiters, 1, __ATOMIC_SEQ_CST);
+	}
+}
+
 /*
  * Deinitialize before exit
  */
@@ -945,45 +1067,31 @@ void mmio_write32(int offset, int afu_idx, uint32_t data)
 		ASE_ERR("MMIO Write Error\n");
 		raise(SIGABRT);
 	} else {
-		mmio_t *mmio_pkt;
-		mmio_pkt =
-			(struct mmio_t *) ase_malloc(sizeof(struct mmio_t));
-
-		mmio_pkt->write_en = MMIO_WRITE_REQ;
-		mmio_pkt->width = MMIO_WIDTH_32;
-		mmio_pkt->addr = offset;
-		ase_memcpy(mmio_pkt->qword, &data, sizeof(uint32_t));
-		mmio_pkt->resp_en = 0;
-		mmio_pkt->afu_idx = afu_idx;
-
-		// Critical Section
-		if (pthread_mutex_lock(&io_s.mmio_port_lock) != 0) {
-			ASE_ERR("pthread_mutex_lock could not attain lock !\n");
-			exit_cleanup();
-		}
-
-		mmio_pkt->tid = generate_mmio_tid();
-		mmio_request_put(mmio_pkt);
+		// Built in place, mmio_request_put() copies it to the queue
+		mmio_t mmio_pkt = {
+			.write_en = MMIO_WRITE_REQ,
+			.width = MMIO_WIDTH_32,
+			.addr = offset,
+			.resp_en = 0,
+			.afu_idx = afu_idx
+		};
+		ase_memcpy(mmio_pkt.qword, &data, sizeof(uint32_t));
 
-		if (pthread_mutex_unlock(&io_s.mmio_port_lock) != 0) {
-			ASE_ERR
-				("Mutex unlock failure ... Application Exit here\n");
-			session_deinit();
-			exit(1);
-		}
+		// Claim a slot and send
+		mmio_request_put(&mmio_pkt);
 
 		// Write to MMIO map
-		uint32_t *mmio_vaddr;
-		mmio_vaddr =
-			(uint32_t *) ((uint64_t) mmio_afu_vbase + offset);
-		ase_memcpy(mmio_vaddr, (char *) &data, sizeof(uint32_t));
+		if (mmio_shadow_enable) {
+			uint32_t *mmio_vaddr;
+			mmio_vaddr =
+				(uint32_t *) ((uint64_t) mmio_afu_vbase + offset);
+			ase_memcpy(mmio_vaddr, (char *) &data, sizeof(uint32_t));
+		}
 
 		// Display
-		ASE_MSG("MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%08x\n",
-			mmio_pkt->tid, mmio_pkt->addr, data);
-
-		free(mmio_pkt);
-		mmio_pkt = NULL;
+		if (ASE_MSG_ENABLED())
+			ASE_MSG("MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%08x\n",
+				mmio_pkt.tid, mmio_pkt.addr, data);
 	}
 
 	FUNC_CALL_EXIT;
@@ -1002,44 +1110,30 @@ void mmio_write64(int offset, int afu_idx, uint64_t data)
 		ASE_ERR("MMIO Write Error\n");
 		raise(SIGABRT);
 	} else {
-		mmio_t *mmio_pkt;
-		mmio_pkt =
-			(struct mmio_t *) ase_malloc(sizeof(struct mmio_t));
-
-		mmio_pkt->write_en = MMIO_WRITE_REQ;
-		mmio_pkt->width = MMIO_WIDTH_64;
-		mmio_pkt->addr = offset;
-		ase_memcpy(mmio_pkt->qword, &data, sizeof(uint64_t));
-		mmio_pkt->resp_en = 0;
-		mmio_pkt->afu_idx = afu_idx;
-
-		// Critical section
-		if (pthread_mutex_lock(&io_s.mmio_port_lock) != 0) {
-			ASE_ERR("pthread_mutex_lock could not attain lock !\n");
-			exit_cleanup();
-		}
-
-		mmio_pkt->tid = generate_mmio_tid();
-		mmio_request_put(mmio_pkt);
+		mmio_t mmio_pkt = {
+			.write_en = MMIO_WRITE_REQ,
+			.width = MMIO_WIDTH_64,
+			.addr = offset,
+			.resp_en = 0,
+			.afu_idx = afu_idx
+		};
+		mmio_pkt.qword[0] = data;
 
-		if (pthread_mutex_unlock(&io_s.mmio_port_lock) != 0) {
-			ASE_ERR("Mutex unlock failure ... Application Exit here\n");
-			exit_cleanup();
-		}
+		// Claim a slot and send
+		mmio_request_put(&mmio_pkt);
 
 		// Write to MMIO Map
-		uint64_t *mmio_vaddr;
-		mmio_vaddr =
-		(uint64_t *) ((uint64_t) mmio_afu_vbase + offset);
-		*mmio_vaddr = data;
-
-
-		ASE_MSG("MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%llx\n",
-			mmio_pkt->tid, mmio_pkt->addr,
-			(unsigned long long) data);
+		if (mmio_shadow_enable) {
+			uint64_t *mmio_vaddr;
+			mmio_vaddr =
+			(uint64_t *) ((uint64_t) mmio_afu_vbase + offset);
+			*mmio_vaddr = data;
+		}
 
-		free(mmio_pkt);
-		mmio_pkt = NULL;
+		if (ASE_MSG_ENABLED())
+			ASE_MSG("MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%llx\n",
+				mmio_pkt.tid, mmio_pkt.addr,
+				(unsigned long long) data);
 	}
 
 	FUNC_CALL_EXIT;
@@ -1058,45 +1152,30 @@ void mmio_write512(int offset, int afu_idx, const void *data)
 		ASE_ERR("MMIO Write Error\n");
 		raise(SIGABRT);
 	} else {
-		mmio_t *mmio_pkt;
-		mmio_pkt =
-			(struct mmio_t *) ase_malloc(sizeof(struct mmio_t));
-
-		mmio_pkt->write_en = MMIO_WRITE_REQ;
-		mmio_pkt->width = MMIO_WIDTH_512;
-		mmio_pkt->addr = offset;
-		ase_memcpy(mmio_pkt->qword, data, 64);
-		mmio_pkt->resp_en = 0;
-		mmio_pkt->afu_idx = afu_idx;
-
-		// Critical Section
-		if (pthread_mutex_lock(&io_s.mmio_port_lock) != 0) {
-			ASE_ERR("pthread_mutex_lock could not attain lock !\n");
-			exit_cleanup();
-		}
-
-		mmio_pkt->tid = generate_mmio_tid();
-		mmio_request_put(mmio_pkt);
+		mmio_t mmio_pkt = {
+			.write_en = MMIO_WRITE_REQ,
+			.width = MMIO_WIDTH_512,
+			.addr = offset,
+			.resp_en = 0,
+			.afu_idx = afu_idx
+		};
+		ase_memcpy(mmio_pkt.qword, data, 64);
 
-		if (pthread_mutex_unlock(&io_s.mmio_port_lock) != 0) {
-			ASE_ERR
-				("Mutex unlock failure ... Application Exit here\n");
-			session_deinit();
-			exit(1);
-		}
+		// Claim a slot and send
+		mmio_request_put(&mmio_pkt);
 
 		// Write to MMIO map
-		void *mmio_vaddr;
-		mmio_vaddr =
-			(void *) ((uint64_t) mmio_afu_vbase + offset);
-		ase_memcpy(mmio_vaddr, data, 64);
+		if (mmio_shadow_enable) {
+			void *mmio_vaddr;
+			mmio_vaddr =
+				(void *) ((uint64_t) mmio_afu_vbase + offset);
+			ase_memcpy(mmio_vaddr, data, 64);
+		}
 
 		// Display
-		ASE_MSG("MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%08x\n",
-			mmio_pkt->tid, mmio_pkt->addr, data);
-
-		free(mmio_pkt);
-		mmio_pkt = NULL;
+		if (ASE_MSG_ENABLED())
+			ASE_MSG("MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%08x\n",
+				mmio_pkt.tid, mmio_pkt.addr, data);
 	}
 
 	FUNC_CALL_EXIT;
@@ -1118,6 +1197,35 @@ void mmio_write512(int offset, int afu_idx, const void *data)
  * -------------------------------------
  *
  */
+/*
+ * Send an MMIO read request and return its scoreboard slot
+ */
+static int mmio_read_send(int offset, int afu_idx, int width)
+{
+	int slot_idx;
+	mmio_t mmio_pkt = {
+		.write_en = MMIO_READ_REQ,
+		.width = width,
+		.addr = offset,
+		.resp_en = 0,
+		.afu_idx = afu_idx
+	};
+
+	// Claim a slot and send
+	slot_idx = mmio_request_put(&mmio_pkt);
+
+	if (ASE_MSG_ENABLED())
+		ASE_MSG("MMIO Read      : tid = 0x%03x, offset = 0x%x\n",
+			mmio_pkt.tid, mmio_pkt.addr);
+
+#ifdef ASE_DEBUG
+	ASE_DBG("slot_idx = %d\n", slot_idx);
+#endif
+
+	return slot_idx;
+}
+
+
 /*
  * MMIO Read 32-bit
  */
@@ -1131,57 +1239,21 @@ void mmio_read32(int offset, int afu_idx, uint32_t *data32)
 		ASE_ERR("MMIO Read Error\n");
 		raise(SIGABRT);
 	} else {
-		mmio_t *mmio_pkt;
-		mmio_pkt =
-			(struct mmio_t *) ase_malloc(sizeof(struct mmio_t));
-
-		mmio_pkt->write_en = MMIO_READ_REQ;
-		mmio_pkt->width = MMIO_WIDTH_32;
-		mmio_pkt->addr = offset;
-		mmio_pkt->resp_en = 0;
-		mmio_pkt->afu_idx = afu_idx;
-
-		// Critical section
-		if (pthread_mutex_lock(&io_s.mmio_port_lock) != 0) {
-			ASE_ERR("pthread_mutex_lock could not attain lock !\n");
-			exit_cleanup();
-		}
-
-		mmio_pkt->tid = generate_mmio_tid();
-		slot_idx = mmio_request_put(mmio_pkt);
-
-		if (pthread_mutex_unlock(&io_s.mmio_port_lock) != 0) {
-			ASE_ERR("Mutex unlock failure ... Application Exit here\n");
-			exit_cleanup();
-		}
-
-		ASE_MSG("MMIO Read      : tid = 0x%03x, offset = 0x%x\n",
-			mmio_pkt->tid, mmio_pkt->addr);
-
-#ifdef ASE_DEBUG
-		ASE_DBG("slot_idx = %d\n", slot_idx);
-#endif
+		slot_idx = mmio_read_send(offset, afu_idx, MMIO_WIDTH_32);
 
 		// Wait until correct response found
-		while (mmio_table[slot_idx].rx_flag != true) {
-			usleep(1);
-		}
+		mmio_wait_response(slot_idx);
 
 		// Write data
 		*data32 = (uint32_t) mmio_table[slot_idx].data;
 
 		// Display
+		if (ASE_MSG_ENABLED())
+			ASE_MSG("MMIO Read Resp : tid = 0x%03x, %08x\n",
+				mmio_table[slot_idx].tid, (uint32_t) *data32);
 
-		ASE_MSG("MMIO Read Resp : tid = 0x%03x, %08x\n",
-			mmio_table[slot_idx].tid, (uint32_t) *data32);
-
-
-		// Reset scoreboard flags
-		mmio_table[slot_idx].tx_flag = false;
-		mmio_table[slot_idx].rx_flag = false;
-
-		free(mmio_pkt);
-		mmio_pkt = NULL;
+		// Free the scoreboard slot
+		mmio_slot_release(slot_idx);
 	}
 
 	FUNC_CALL_EXIT;
@@ -1201,61 +1273,103 @@ void mmio_read64(int offset, int afu_idx, uint64_t *data64)
 		ASE_ERR("MMIO Read Error\n");
 		raise(SIGABRT);
 	} else {
-		mmio_t *mmio_pkt;
-		mmio_pkt =
-			(struct mmio_t *) ase_malloc(sizeof(struct mmio_t));
-
-		mmio_pkt->write_en = MMIO_READ_REQ;
-		mmio_pkt->width = MMIO_WIDTH_64;
-		mmio_pkt->addr = offset;
-		mmio_pkt->resp_en = 0;
-		mmio_pkt->afu_idx = afu_idx;
-
-		// Critical section
-		if (pthread_mutex_lock(&io_s.mmio_port_lock) != 0) {
-			ASE_ERR("pthread_mutex_lock could not attain lock !\n");
-			exit_cleanup();
-		}
-
-		mmio_pkt->tid = generate_mmio_tid();
-		slot_idx = mmio_request_put(mmio_pkt);
-
-		if (pthread_mutex_unlock(&io_s.mmio_port_lock) != 0) {
-			ASE_ERR("Mutex unlock failure ... Application Exit here\n");
-			exit_cleanup();
-		}
-
-		ASE_MSG
-			("MMIO Read      : tid = 0x%03x, offset = 0x%x\n",
-			mmio_pkt->tid, mmio_pkt->addr);
-
-#ifdef ASE_DEBUG
-		ASE_DBG("slot_idx = %d\n", slot_idx);
-#endif
+		slot_idx = mmio_read_send(offset, afu_idx, MMIO_WIDTH_64);
 
 		// Wait for correct response to be back
-		while (mmio_table[slot_idx].rx_flag != true) {
-			usleep(1);
-		};
+		mmio_wait_response(slot_idx);
 
 		// Write data
 		*data64 = mmio_table[slot_idx].data;
 
 		// Display
+		if (ASE_MSG_ENABLED())
+			ASE_MSG
+				("MMIO Read Resp : tid = 0x%03x, data = %llx\n",
+				 mmio_table[slot_idx].tid,
+				 (unsigned long long) *data64);
+
+		// Free the scoreboard slot
+		mmio_slot_release(slot_idx);
+	}
+
+	FUNC_CALL_EXIT;
+}
+
+
+/*
+ * Asynchronous MMIO read
+ * - The request is sent and a token describing it is returned. The
+ *   response is collected later by mmio_read_async_wait(), allowing
+ *   up to MMIO_MAX_ASYNC_READS reads to be in flight together.
+ * - Token: tid in bits 63:32, 64-bit width flag in bit 31, slot in 15:0
+ * - Returns 0 on success and -1 when the window is full
+ */
+#define MMIO_ASYNC_TOKEN_WIDTH64   (UINT64_C(1) << 31)
+
+int mmio_read_async(int offset, int afu_idx, int width, uint64_t *token)
+{
+	FUNC_CALL_ENTRY;
+	int slot_idx;
+
+	if (offset < 0) {
+		ASE_ERR("Requested offset is not in AFU MMIO region\n");
+		ASE_ERR("MMIO Read Error\n");
+		raise(SIGABRT);
+	}
+
+	// Claim a place in the window
+	if (__atomic_add_fetch(&mmio_async_reads, 1, __ATOMIC_SEQ_CST) > MMIO_MAX_ASYNC_READS) {
+		__atomic_sub_fetch(&mmio_async_reads, 1, __ATOMIC_SEQ_CST);
+		FUNC_CALL_EXIT;
+		return -1;
+	}
+
+	slot_idx = mmio_read_send(offset, afu_idx, width);
+
+	*token = ((uint64_t) mmio_table[slot_idx].tid << 32) | (uint64_t) slot_idx;
+	if (width == MMIO_WIDTH_64)
+		*token |= MMIO_ASYNC_TOKEN_WIDTH64;
+
+	FUNC_CALL_EXIT;
+	return 0;
+}
+
+
+/*
+ * Wait for an asynchronous MMIO read and release its scoreboard slot
+ * - Returns 0 on success and -1 if the token is not an outstanding read
+ */
+int mmio_read_async_wait(uint64_t token, uint64_t *data)
+{
+	FUNC_CALL_ENTRY;
+
+	int slot_idx = token & 0xffff;
+	int tid = token >> 32;
+
+	if ((slot_idx >= MMIO_MAX_OUTSTANDING) ||
+	    (get_scoreboard_slot_by_tid(tid) != slot_idx)) {
+		FUNC_CALL_EXIT;
+		return -1;
+	}
+
+	mmio_wait_response(slot_idx);
+
+	*data = mmio_table[slot_idx].data;
+	if (!(token & MMIO_ASYNC_TOKEN_WIDTH64))
+		*data = (uint32_t) *data;
+
+	if (ASE_MSG_ENABLED())
 		ASE_MSG
 			("MMIO Read Resp : tid = 0x%03x, data = %llx\n",
-			 mmio_table[slot_idx].tid,
-			 (unsigned long long) *data64);
+			 tid, (unsigned long long) *data);
 
-		// Reset scoreboard flags
-		mmio_table[slot_idx].tx_flag = false;
-		mmio_table[slot_idx].rx_flag = false;
+	// Free the scoreboard slot
+	mmio_slot_release(slot_idx);
 
-		free(mmio_pkt);
-		mmio_pkt = NULL;
-	}
+	__atomic_sub_fetch(&mmio_async_reads, 1, __ATOMIC_SEQ_CST);
 
 	FUNC_CALL_EXIT;
+	return 0;
 }
 
 /*
@@ -1271,34 +1385,76 @@ void shm_error(const char *msg)
 }
 
 /*
- * Note pinned pages. This is used only for logging in the simulator.
+ * Send the pinned page notes batched so far. Called with portctrl_lock
+ * held.
  */
-void note_pinned_page(uint64_t va, uint64_t iova, uint64_t length)
+static void pin_notes_send(void)
 {
-	struct buffer_t mem;
-	ase_memset(&mem, 0, sizeof(mem));
-	mem.is_pinned = true;
-	mem.valid = true;
-	mem.vbase = va;
-	mem.fake_paddr = iova;
-	mem.memsize = length;
+	struct ase_portctrl_req *req = (struct ase_portctrl_req *) pin_notes_msg;
 
-	char tmp_msg[ASE_MQ_MSGSIZE] = { 0, };
-	ase_buffer_t_to_str(&mem, tmp_msg);
-	mqueue_send(app2sim_alloc_tx, tmp_msg, ASE_MQ_MSGSIZE);
+	if (pin_notes_count == 0)
+		return;
+
+	ase_memset(req, 0, sizeof(*req));
+	req->version = ASE_CTRL_VERSION;
+	req->cmd = ASE_PIN_NOTES;
+	req->num_notes = pin_notes_count;
+	mqueue_send(app2sim_portctrl_req_tx, (char *) pin_notes_msg,
+		    sizeof(*req) + pin_notes_count * sizeof(struct ase_pin_note));
+
+	__atomic_store_n(&pin_notes_count, 0, __ATOMIC_RELAXED);
 }
 
-void note_unpinned_page(uint64_t iova, uint64_t length)
+/*
+ * Send batched pinned page notes, so the simulator logs them ahead of
+ * the request that follows.
+ */
+static void pin_notes_flush(void)
 {
-	struct buffer_t mem;
-	ase_memset(&mem, 0, sizeof(mem));
-	mem.is_pinned = true;
-	mem.fake_paddr = iova;
-	mem.memsize = length;
+	if (__atomic_load_n(&pin_notes_count, __ATOMIC_RELAXED) == 0)
+		return;
 
-	char tmp_msg[ASE_MQ_MSGSIZE] = { 0, };
-	ase_buffer_t_to_str(&mem, tmp_msg);
-	mqueue_send(app2sim_dealloc_tx, tmp_msg, ASE_MQ_MSGSIZE);
+	pthread_mutex_lock(&portctrl_lock);
+	pin_notes_send();
+	pthread_mutex_unlock(&portctrl_lock);
+}
+
+/*
+ * Note pinned and unpinned pages. They are used only for logging in the
+ * simulator, so they are batched and dropped entirely when the
+ * simulator's workspace log is off.
+ */
+static void pin_note_add(uint64_t va, uint64_t iova, uint64_t length, bool pinned)
+{
+	struct ase_pin_note *note;
+
+	if (!(ctrl_features & ASE_FEATURE_PIN_NOTES))
+		return;
+
+	pthread_mutex_lock(&portctrl_lock);
+
+	note = (struct ase_pin_note *) ((struct ase_portctrl_req *) pin_notes_msg + 1);
+	note += pin_notes_count;
+	note->va = va;
+	note->iova = iova;
+	note->length = length;
+	note->pinned = pinned;
+
+	__atomic_store_n(&pin_notes_count, pin_notes_count + 1, __ATOMIC_RELAXED);
+	if (pin_notes_count == ASE_PIN_NOTES_MAX)
+		pin_notes_send();
+
+	pthread_mutex_unlock(&portctrl_lock);
+}
+
+void note_pinned_page(uint64_t va, uint64_t iova, uint64_t length)
+{
+	pin_note_add(va, iova, length, true);
+}
+
+void note_unpinned_page(uint64_t iova, uint64_t length)
+{
+	pin_note_add(0, iova, length, false);
 }
 
 /*
@@ -1541,6 +1697,12 @@ void free_buffers(void)
 	buf_head = NULL;
 	buf_end = NULL;
 
+	uint64_t tlb_hits, tlb_misses;
+	ase_host_memory_tlb_stats(&tlb_hits, &tlb_misses);
+	if (tlb_hits + tlb_misses)
+		ASE_INFO_2("Host memory IOTLB: %" PRIu64 " hits, %" PRIu64 " misses\n",
+			   tlb_hits, tlb_misses);
+
 	ase_host_memory_terminate();
 
 	asebuf_index_count = 0;
@@ -1572,57 +1734,24 @@ void free_buffers(void)
 
 
 /*
- * umsg_send: Write data to umsg region
- */
-/*void umsg_send(int umsg_id, uint64_t *umsg_data)
-{
-	ase_memcpy((char *) umsg_addr_array[umsg_id], (char *) umsg_data,
-		   sizeof(uint64_t));
-}*/
-
-
-/*
- * umsg_set_attribute: Set UMSG Hint setting
- */
-void umsg_set_attribute(uint32_t hint_mask)
-{
-	// Send hint transaction
-	ase_portctrl(UMSG_MODE, hint_mask);
-}
-
-
-/*
- * Umsg watcher thread
- * Setup UMSG tracker addresses, and watch for activity
+ * Set up the UMsg line addresses and the mirror of data last sent.
  */
-void *umsg_watcher(void *arg)
+static void umsg_lines_init(void)
 {
-	UNUSED_PARAM(arg);
-	// Mark as thread that can be cancelled anytime
-	pthread_setcanceltype(PTHREAD_CANCEL_ENABLE, NULL);
-
-	// Generic index
 	int cl_index;
 
-	// UMsg old data
-	char umsg_old_data[NUM_UMSG_PER_AFU][CL_BYTE_WIDTH];
+	pthread_mutex_init(&umas_s.umsg_lock, NULL);
 
-	// Declare and Allocate umsgcmd_t packet
-	umsgcmd_t *umsg_pkt;
-	umsg_pkt = (struct umsgcmd_t *) ase_malloc(sizeof(struct umsgcmd_t));
-
-	// Patrol each UMSG line
 	for (cl_index = 0; cl_index < NUM_UMSG_PER_AFU; cl_index++) {
-		// Original copy
-		ase_memcpy((char *) umsg_old_data[cl_index],
-				(char *) ((uint64_t) umas_s.umas_region->vbase +
-					umsg_byteindex_arr[cl_index]),
-					CL_BYTE_WIDTH);
-
 		// Calculate addres
 		umas_s.umsg_addr_array[cl_index] =
 			(char *) ((uint64_t) umas_s.umas_region->vbase +
 				umsg_byteindex_arr[cl_index]);
+
+		// Original copy
+		ase_memcpy(umas_s.umsg_mirror[cl_index],
+				umas_s.umsg_addr_array[cl_index],
+				CL_BYTE_WIDTH);
 #ifdef ASE_DEBUG
 
 		ASE_DBG("umas_s.umsg_addr_array[%d] = %p\n", cl_index,
@@ -1633,44 +1762,130 @@ void *umsg_watcher(void *arg)
 
 	// Set UMsg initialized flag
 	umas_init_flag = 1;
+}
 
-	// While application is running
-	while (umas_exist_status == ESTABLISHED) {
-		// Walk through each line
-		for (cl_index = 0; cl_index < NUM_UMSG_PER_AFU; cl_index++) {
-			if (memcmp
-				(umas_s.umsg_addr_array[cl_index],
-				 umsg_old_data[cl_index],
-				 CL_BYTE_WIDTH) != 0) {
-				// Construct UMsg packet
-				umsg_pkt->id = cl_index;
-				ase_memcpy((char *) umsg_pkt->qword,
-						(char *)
-						umas_s.umsg_addr_array[cl_index],
-						CL_BYTE_WIDTH);
-
-				// Send UMsg
-				mqueue_send(app2sim_umsg_tx,
-						(char *) umsg_pkt,
-						sizeof(struct umsgcmd_t));
-
-				// Update local mirror
-				ase_memcpy((char *)
-						umsg_old_data[cl_index],
-						(char *) umsg_pkt->qword,
-						CL_BYTE_WIDTH);
-			}
-		}
-		usleep(1);
-	}
 
-	// Free memory
-	ase_free_buffer((char *) umsg_pkt);
+/*
+ * Send a UMsg holding the current contents of a line and update the
+ * mirror. Called with umas_s.umsg_lock held.
+ */
+static void umsg_line_send(int cl_index)
+{
+	umsgcmd_t umsg_pkt;
+
+	// Construct UMsg packet
+	ase_memset(&umsg_pkt, 0, sizeof(umsg_pkt));
+	umsg_pkt.id = cl_index;
+	ase_memcpy((char *) umsg_pkt.qword, umas_s.umsg_addr_array[cl_index],
+		   CL_BYTE_WIDTH);
 
-	return 0;
+	// Send UMsg
+	mqueue_send(app2sim_umsg_tx, (char *) &umsg_pkt, sizeof(umsg_pkt));
+
+	// Update local mirror
+	ase_memcpy(umas_s.umsg_mirror[cl_index], (char *) umsg_pkt.qword,
+		   CL_BYTE_WIDTH);
 }
 
-STATIC ase_host_memory_status membus_op_status(uint64_t va, uint64_t pa, uint64_t bytes)
+
+/*
+ * umsg_send: Write data to the first word of a UMsg line and send the
+ * UMsg. Unlike a plain store, which the watcher finds only if the line
+ * differs from the last UMsg at its next scan, every call sends exactly
+ * one UMsg.
+ */
+void umsg_send(int umsg_id, const uint64_t *umsg_data)
+{
+	if ((umsg_id < 0) || (umsg_id >= NUM_UMSG_PER_AFU)) {
+		ASE_ERR("UMsg ID %d out of range\n", umsg_id);
+		return;
+	}
+
+	pthread_mutex_lock(&umas_s.umsg_lock);
+	ase_memcpy(umas_s.umsg_addr_array[umsg_id], (const char *) umsg_data,
+		   sizeof(uint64_t));
+	umsg_line_send(umsg_id);
+	pthread_mutex_unlock(&umas_s.umsg_lock);
+}
+
+
+/*
+ * umsg_set_attribute: Set UMSG Hint setting
+ */
+void umsg_set_attribute(uint32_t hint_mask)
+{
+	// Send hint transaction
+	ase_portctrl(UMSG_MODE, hint_mask);
+}
+
+
+/*
+ * Stop the UMsg watcher, if running. It is woken to notice that the
+ * session is closing and joined. It is not cancelled, since it may hold
+ * umsg_lock.
+ */
+static void umsg_watcher_stop(void)
+{
+	if (!umas_s.umsg_poll)
+		return;
+
+	umas_exist_status = NOT_ESTABLISHED;
+	__atomic_fetch_add(&umas_s.umsg_doorbell, 1, __ATOMIC_SEQ_CST);
+	ase_futex_wake(&umas_s.umsg_doorbell);
+	pthread_join(umas_s.umsg_watch_tid, NULL);
+	umas_s.umsg_poll = false;
+}
+
+
+/*
+ * Umsg watcher thread
+ * Setup UMSG tracker addresses, and watch for activity
+ */
+void *umsg_watcher(void *arg)
+{
+	UNUSED_PARAM(arg);
+
+	// Generic index
+	int cl_index;
+
+	// Polling interval. Doubles while the UMsg lines are quiet, up to
+	// UMSG_POLL_MAX_US, and drops back as soon as a line changes.
+	useconds_t poll_us = 1;
+	bool umsg_sent;
+
+	// While application is running
+	while (umas_exist_status == ESTABLISHED) {
+		uint32_t bell = __atomic_load_n(&umas_s.umsg_doorbell, __ATOMIC_SEQ_CST);
+		umsg_sent = false;
+
+		// Walk through each line
+		pthread_mutex_lock(&umas_s.umsg_lock);
+		for (cl_index = 0; cl_index < NUM_UMSG_PER_AFU; cl_index++) {
+			if (memcmp
+				(umas_s.umsg_addr_array[cl_index],
+				 umas_s.umsg_mirror[cl_index],
+				 CL_BYTE_WIDTH) != 0) {
+				umsg_sent = true;
+				umsg_line_send(cl_index);
+			}
+		}
+		pthread_mutex_unlock(&umas_s.umsg_lock);
+
+		if (umsg_sent)
+			poll_us = 1;
+		else if (poll_us < UMSG_POLL_MAX_US)
+			poll_us <<= 1;
+
+		// Plain stores to the UMAS region raise no event, so the lines
+		// are polled. Sleep on the doorbell in between, which is rung
+		// when the session closes.
+		ase_futex_wait(&umas_s.umsg_doorbell, bell, poll_us * 1000L);
+	}
+
+	return 0;
+}
+
+STATIC ase_host_memory_status membus_op_status(uint64_t va, uint64_t pa, uint64_t bytes)
 {
 	ase_host_memory_status st;
 
@@ -1685,11 +1900,18 @@ STATIC ase_host_memory_status membus_op_status(uint64_t va, uint64_t pa, uint64_
 		st = HOST_MEM_STATUS_ILLEGAL_4KB;
 	} else if (va == 0) {
 		st = HOST_MEM_STATUS_NOT_PINNED;
+	} else if (ase_vma_tracking() && ase_host_memory_ref_unmapped()) {
+		// libase-preload reports munmap() and friends. Pinned pages that
+		// are unmapped without being unpinned first are flagged in the
+		// page table and the flag was returned by the translation of va.
+		st = HOST_MEM_STATUS_NOT_MAPPED;
 	} else {
 		// We use mincore to detect whether the virtual address is mapped.
 		// mincore returns an error when it isn't. This will detect most cases
 		// where the user code pins a page and subsequently unmaps the
 		// page without unpinnning it with fpgaReleaseBuffer() first.
+		// The C library unmaps memory internally without passing through
+		// libase-preload, so the check is needed even with the flag above.
 		//
 		// There is still a race here. The user code could unmap the page
 		// after this check and before the simulator reads or writes the
@@ -1771,119 +1993,407 @@ static uint64_t membus_atomic_upd(void *va, uint32_t data_bytes, uint32_t atomic
 
 
 /*
- * Service simulator memory read/write requests.
+ * Read requests may be served by a pool of workers, sized by the
+ * ASE_MEMBUS_RD_WORKERS environment variable. membus_rd_watcher receives
+ * requests from the simulator and queues them. Requests with the same tag
+ * are served in order, so protocols that don't use tags (CCI-P) still
+ * see responses in request order. Requests with different tags may
+ * complete out of order and are matched by tag in the simulator, so a
+ * large read or an ATS translation doesn't block small reads behind it.
+ *
+ * Writes are posted and carry no tag. They stay in order on a single
+ * thread, membus_wr_watcher.
  */
-static void *membus_rd_watcher(void *arg)
-{
-	UNUSED_PARAM(arg);
-	// Mark as thread that can be cancelled anytime
-	pthread_setcanceltype(PTHREAD_CANCEL_ENABLE, NULL);
+#define MEMBUS_RD_WORKERS_ENV "ASE_MEMBUS_RD_WORKERS"
+#define MEMBUS_RD_DEFAULT_WORKERS 4
+#define MEMBUS_RD_MAX_WORKERS 32
+
+// Queue slots. Must be a power of 2.
+#define MEMBUS_RD_QUEUE_SIZE 1024
+// Queued requests a worker searches for one with an idle tag
+#define MEMBUS_RD_SEARCH_DEPTH 64
+
+typedef struct {
+	ase_host_memory_read_req req;
+	bool taken;
+} membus_rd_slot_t;
+
+static membus_rd_slot_t membus_rd_queue[MEMBUS_RD_QUEUE_SIZE];
+// Oldest slot not yet taken and next free slot
+static uint32_t membus_rd_head, membus_rd_tail;
+static pthread_mutex_t membus_rd_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+// Futex words. membus_rd_work is bumped when a request is queued or a tag
+// goes idle, membus_rd_space when a slot is taken. Wakes are sent only
+// when a thread is sleeping.
+static volatile uint32_t membus_rd_work;
+static volatile uint32_t membus_rd_space;
+static uint32_t membus_rd_work_sleepers;
+static bool membus_rd_space_sleeper;
+// Set under membus_rd_queue_lock to end the pool
+static bool membus_rd_stop;
+
+static int membus_rd_num_workers;
+static pthread_t membus_rd_worker_tid[MEMBUS_RD_MAX_WORKERS];
+// Tag in service by each worker, valid when busy is set
+static uint32_t membus_rd_worker_tag[MEMBUS_RD_MAX_WORKERS];
+static bool membus_rd_worker_busy[MEMBUS_RD_MAX_WORKERS];
+
+// Responses are a header followed by a payload and must not interleave
+static pthread_mutex_t membus_rd_rsp_lock = PTHREAD_MUTEX_INITIALIZER;
 
-	ase_host_memory_read_req rd_req;
+
+/*
+ * Serve one read, atomic or ATS translation request and send the response.
+ */
+static void membus_rd_serve(const ase_host_memory_read_req *rd_req)
+{
 	ase_host_memory_read_rsp rd_rsp;
 	ase_memset(&rd_rsp, 0, sizeof(rd_rsp));
 
 	// Buffer for payload in response to an address translation request
 	uint64_t ats_rsp_payload[16];
-	ase_memset(&ats_rsp_payload, 0, sizeof(ats_rsp_payload));
 
-	pcie_atc_active = false;
+	bool is_ats_req = (rd_req->addr_type == HOST_MEM_AT_REQ_TRANS);
+	bool need_mem_unlock = false;
+
+	if (!is_ats_req)
+	{
+		// Normal read
+		rd_rsp.pa = rd_req->addr;
+		if (rd_req->addr_type == HOST_MEM_AT_UNTRANS)
+			rd_rsp.va = ase_host_memory_iova_to_va(rd_req->afu_idx, rd_req->addr, true);
+		else
+			rd_rsp.va = ase_host_memory_pa_to_va(rd_req->addr, true);
+		rd_rsp.status = HOST_MEM_STATUS_VALID;
+		need_mem_unlock = true;
+
+		if (!rd_rsp.va)
+		{
+			ASE_ERR("Read from unmapped IOVA 0x%016" PRIx64 "\n", rd_req->addr);
+			raise(SIGABRT);
+		}
+	}
+	else
+	{
+		// Address translation. Request address is virtual.
+		rd_rsp.pa = rd_req->addr;
+		rd_rsp.va = rd_req->addr;
+		rd_rsp.status = HOST_MEM_STATUS_VALID;
+
+		// Address translation cache is active
+		pcie_atc_active = true;
+
+		ase_memset(&ats_rsp_payload, 0, sizeof(ats_rsp_payload));
+
+		uint64_t page_len;
+		uint64_t pa = ase_host_memory_va_to_pa(rd_req->addr, &page_len);
+		if (pa == INT64_C(-1))
+		{
+			ASE_ERR("PCIe ATS error looking up VA 0x%016" PRIx64 "\n", rd_req->addr);
+			raise(SIGABRT);
+		}
 
-	// While application is running
-	while (membus_exist_status == ESTABLISHED) {
-		if (mqueue_recv(sim2app_membus_rd_req_rx, (char *) &rd_req, sizeof(rd_req)) == ASE_MSG_PRESENT) {
-			bool is_ats_req = (rd_req.addr_type == HOST_MEM_AT_REQ_TRANS);
-			bool need_mem_unlock = false;
+		// Encode the address for transmission, setting R+W flag bits
+		ats_rsp_payload[0] = ase_pcie_ats_pa_enc(pa, page_len, 3);
+	}
 
-			if (!is_ats_req)
-			{
-				// Normal read
-				rd_rsp.pa = rd_req.addr;
-				if (rd_req.addr_type == HOST_MEM_AT_UNTRANS)
-					rd_rsp.va = ase_host_memory_iova_to_va(rd_req.afu_idx, rd_req.addr, true);
-				else
-					rd_rsp.va = ase_host_memory_pa_to_va(rd_req.addr, true);
-				rd_rsp.status = HOST_MEM_STATUS_VALID;
-				need_mem_unlock = true;
-
-				if (!rd_rsp.va)
-				{
-					ASE_ERR("Read from unmapped IOVA 0x%016" PRIx64 "\n", rd_req.addr);
-					raise(SIGABRT);
-				}
-			}
-			else
-			{
-				// Address translation. Request address is virtual.
-				rd_rsp.pa = rd_req.addr;
-				rd_rsp.va = rd_req.addr;
-				rd_rsp.status = HOST_MEM_STATUS_VALID;
+	rd_rsp.data_bytes = rd_req->data_bytes;
+	rd_rsp.tag = rd_req->tag;
+	rd_rsp.afu_idx = rd_req->afu_idx;
+	if (rd_rsp.status != HOST_MEM_STATUS_VALID) {
+		rd_rsp.data_bytes = 0;
+	}
 
-				// Address translation cache is active
-				pcie_atc_active = true;
+	// Atomic updates are computed before taking the response lock
+	uint64_t rd_rsp_data64 = 0;
+	uint32_t rd_rsp_data32 = 0;
+	if ((rd_rsp.status == HOST_MEM_STATUS_VALID) && rd_rsp.data_bytes &&
+	    !is_ats_req && (rd_req->req == HOST_MEM_REQ_ATOMIC))
+	{
+		if ((rd_req->data_bytes != 4) && (rd_req->data_bytes != 8))
+		{
+			ASE_ERR("Illegal atomic function size: %d\n", rd_req->data_bytes);
+			raise(SIGABRT);
+		}
 
-				ase_memset(&ats_rsp_payload, 0, sizeof(ats_rsp_payload));
+		rd_rsp_data64 = membus_atomic_upd((void *) rd_rsp.va, rd_req->data_bytes,
+						  rd_req->atomic_func,
+						  rd_req->atomic_wr_data[0],
+						  rd_req->atomic_wr_data[1]);
+		rd_rsp_data32 = rd_rsp_data64;
+	}
 
-				uint64_t page_len;
-				uint64_t pa = ase_host_memory_va_to_pa(rd_req.addr, &page_len);
-				if (pa == INT64_C(-1))
-				{
-					ASE_ERR("PCIe ATS error looking up VA 0x%016" PRIx64 "\n", rd_req.addr);
-					raise(SIGABRT);
-				}
+	pthread_mutex_lock(&membus_rd_rsp_lock);
 
-				// Encode the address for transmission, setting R+W flag bits
-				ats_rsp_payload[0] = ase_pcie_ats_pa_enc(pa, page_len, 3);
-			}
+	mqueue_send(app2sim_membus_rd_rsp_tx, (char *) &rd_rsp, sizeof(rd_rsp));
+	if ((rd_rsp.status == HOST_MEM_STATUS_VALID) && rd_rsp.data_bytes) {
+
+		if (is_ats_req)
+		{
+			// Address translation response
+			mqueue_send(app2sim_membus_rd_rsp_tx, (char *) &ats_rsp_payload, rd_rsp.data_bytes);
+		}
+		else if (rd_req->req != HOST_MEM_REQ_ATOMIC)
+		{
+			// Normal read (not atomic)
+			mqueue_send(app2sim_membus_rd_rsp_tx, (char *) rd_rsp.va, rd_rsp.data_bytes);
+		}
+		else if (rd_req->data_bytes == 4)
+		{
+			// Atomic update
+			mqueue_send(app2sim_membus_rd_rsp_tx, (char *)&rd_rsp_data32, 4);
+		}
+		else
+		{
+			mqueue_send(app2sim_membus_rd_rsp_tx, (char *)&rd_rsp_data64, 8);
+		}
+	}
+
+	pthread_mutex_unlock(&membus_rd_rsp_lock);
 
-			rd_rsp.data_bytes = rd_req.data_bytes;
-			rd_rsp.tag = rd_req.tag;
-			rd_rsp.afu_idx = rd_req.afu_idx;
-			if (rd_rsp.status != HOST_MEM_STATUS_VALID) {
-				rd_rsp.data_bytes = 0;
+	if (need_mem_unlock)
+		ase_host_memory_unlock();
+}
+
+
+/*
+ * Find the oldest queued request that can be served now: its tag is not
+ * in service and no older request with the same tag is still queued.
+ * Returns the slot index or -1. Called with membus_rd_queue_lock held.
+ */
+static int membus_rd_find(void)
+{
+	uint32_t skipped_tags[MEMBUS_RD_SEARCH_DEPTH];
+	int num_skipped = 0;
+	int depth = 0;
+
+	for (uint32_t i = membus_rd_head; i != membus_rd_tail; i += 1) {
+		membus_rd_slot_t *slot = &membus_rd_queue[i & (MEMBUS_RD_QUEUE_SIZE - 1)];
+		if (slot->taken)
+			continue;
+		if (depth++ == MEMBUS_RD_SEARCH_DEPTH)
+			break;
+
+		uint32_t tag = slot->req.tag;
+		bool blocked = false;
+
+		for (int s = 0; s < num_skipped; s += 1) {
+			if (skipped_tags[s] == tag) {
+				blocked = true;
+				break;
 			}
+		}
 
-			mqueue_send(app2sim_membus_rd_rsp_tx, (char *) &rd_rsp, sizeof(rd_rsp));
-			if ((rd_rsp.status == HOST_MEM_STATUS_VALID) && rd_rsp.data_bytes) {
+		for (int w = 0; !blocked && (w < membus_rd_num_workers); w += 1) {
+			if (membus_rd_worker_busy[w] && (membus_rd_worker_tag[w] == tag))
+				blocked = true;
+		}
 
-				if (is_ats_req)
-				{
-					// Address translation response
-					mqueue_send(app2sim_membus_rd_rsp_tx, (char *) &ats_rsp_payload, rd_rsp.data_bytes);
-				}
-				else if (rd_req.req != HOST_MEM_REQ_ATOMIC)
-				{
-					// Normal read (not atomic)
-					mqueue_send(app2sim_membus_rd_rsp_tx, (char *) rd_rsp.va, rd_rsp.data_bytes);
-				}
-				else
-				{
-					// Atomic update
-					uint64_t rd_rsp_data64;
-					rd_rsp_data64 = membus_atomic_upd((void *) rd_rsp.va, rd_req.data_bytes,
-									  rd_req.atomic_func,
-									  rd_req.atomic_wr_data[0],
-									  rd_req.atomic_wr_data[1]);
-
-					if (rd_req.data_bytes == 4)
-					{
-						uint32_t rd_rsp_data32 = rd_rsp_data64;
-						mqueue_send(app2sim_membus_rd_rsp_tx, (char *)&rd_rsp_data32, 4);
-					}
-					else if (rd_req.data_bytes == 8)
-					{
-						mqueue_send(app2sim_membus_rd_rsp_tx, (char *)&rd_rsp_data64, 8);
-					}
-					else
-					{
-						ASE_ERR("Illegal atomic function size: %d\n", rd_req.data_bytes);
-						raise(SIGABRT);
-					}
-				}
+		if (!blocked)
+			return i & (MEMBUS_RD_QUEUE_SIZE - 1);
+
+		skipped_tags[num_skipped++] = tag;
+	}
+
+	return -1;
+}
+
+
+/*
+ * THREAD: read request worker
+ */
+static void *membus_rd_worker(void *arg)
+{
+	int w = (int)(intptr_t) arg;
+	ase_host_memory_read_req rd_req;
+	uint32_t work;
+
+	pthread_mutex_lock(&membus_rd_queue_lock);
+	while (!membus_rd_stop) {
+		int idx = membus_rd_find();
+		if (idx < 0) {
+			// Nothing to do. Spin briefly, then sleep until the queue
+			// changes or the pool is stopped.
+			work = membus_rd_work;
+			pthread_mutex_unlock(&membus_rd_queue_lock);
+
+			for (int spin = 0; (spin < ASE_SPIN_LIMIT) &&
+				    (__atomic_load_n(&membus_rd_work, __ATOMIC_RELAXED) == work); spin += 1)
+				ase_cpu_relax();
+
+			pthread_mutex_lock(&membus_rd_queue_lock);
+			if (membus_rd_work == work) {
+				membus_rd_work_sleepers += 1;
+				pthread_mutex_unlock(&membus_rd_queue_lock);
+				ase_futex_wait(&membus_rd_work, work, 0);
+				pthread_mutex_lock(&membus_rd_queue_lock);
+				membus_rd_work_sleepers -= 1;
 			}
+			continue;
+		}
 
-			if (need_mem_unlock)
-				ase_host_memory_unlock();
+		rd_req = membus_rd_queue[idx].req;
+		membus_rd_queue[idx].taken = true;
+		while ((membus_rd_head != membus_rd_tail) &&
+		       membus_rd_queue[membus_rd_head & (MEMBUS_RD_QUEUE_SIZE - 1)].taken)
+			membus_rd_head += 1;
+
+		membus_rd_worker_tag[w] = rd_req.tag;
+		membus_rd_worker_busy[w] = true;
+
+		// The receiver may be waiting for a free slot
+		bool wake_space = membus_rd_space_sleeper;
+		membus_rd_space += 1;
+		pthread_mutex_unlock(&membus_rd_queue_lock);
+		if (wake_space)
+			ase_futex_wake(&membus_rd_space);
+
+		membus_rd_serve(&rd_req);
+
+		pthread_mutex_lock(&membus_rd_queue_lock);
+		membus_rd_worker_busy[w] = false;
+
+		// Requests with the same tag may be waiting
+		if (membus_rd_head != membus_rd_tail) {
+			__atomic_fetch_add(&membus_rd_work, 1, __ATOMIC_RELAXED);
+			if (membus_rd_work_sleepers)
+				ase_futex_wake(&membus_rd_work);
+		}
+	}
+	pthread_mutex_unlock(&membus_rd_queue_lock);
+
+	return 0;
+}
+
+
+/*
+ * Queue a request for the workers, waiting for a free slot if the
+ * queue is full.
+ */
+static void membus_rd_queue_push(const ase_host_memory_read_req *rd_req)
+{
+	uint32_t space;
+
+	pthread_mutex_lock(&membus_rd_queue_lock);
+	while ((membus_rd_tail - membus_rd_head) == MEMBUS_RD_QUEUE_SIZE) {
+		// No worker will free a slot
+		if (membus_rd_stop) {
+			pthread_mutex_unlock(&membus_rd_queue_lock);
+			return;
+		}
+
+		space = membus_rd_space;
+		membus_rd_space_sleeper = true;
+		pthread_mutex_unlock(&membus_rd_queue_lock);
+		ase_futex_wait(&membus_rd_space, space, 0);
+		pthread_mutex_lock(&membus_rd_queue_lock);
+		membus_rd_space_sleeper = false;
+	}
+
+	membus_rd_slot_t *slot = &membus_rd_queue[membus_rd_tail & (MEMBUS_RD_QUEUE_SIZE - 1)];
+	slot->req = *rd_req;
+	slot->taken = false;
+	membus_rd_tail += 1;
+
+	__atomic_fetch_add(&membus_rd_work, 1, __ATOMIC_RELAXED);
+	bool wake_work = (membus_rd_work_sleepers != 0);
+	pthread_mutex_unlock(&membus_rd_queue_lock);
+
+	if (wake_work)
+		ase_futex_wake(&membus_rd_work);
+}
+
+
+/*
+ * Start the read worker pool. With a single worker, requests are served
+ * by membus_rd_watcher itself and no pool is created.
+ */
+static void membus_rd_workers_start(void)
+{
+	// By default, leave a CPU for the simulator
+	int num_workers = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+	if (num_workers > MEMBUS_RD_DEFAULT_WORKERS)
+		num_workers = MEMBUS_RD_DEFAULT_WORKERS;
+
+	char *env = getenv(MEMBUS_RD_WORKERS_ENV);
+	if (env)
+		num_workers = atoi(env);
+	if (num_workers < 1)
+		num_workers = 1;
+	if (num_workers > MEMBUS_RD_MAX_WORKERS)
+		num_workers = MEMBUS_RD_MAX_WORKERS;
+
+	// Without workers, membus_rd_watcher sends responses itself and may
+	// have been cancelled in a previous session holding the lock
+	pthread_mutex_init(&membus_rd_rsp_lock, NULL);
+
+	membus_rd_stop = false;
+	membus_rd_head = 0;
+	membus_rd_tail = 0;
+	membus_rd_work_sleepers = 0;
+	membus_rd_space_sleeper = false;
+	membus_rd_num_workers = 0;
+	if (num_workers == 1)
+		return;
+
+	for (int w = 0; w < num_workers; w += 1) {
+		membus_rd_worker_busy[w] = false;
+		if (pthread_create(&membus_rd_worker_tid[w], NULL, &membus_rd_worker,
+				   (void *)(intptr_t) w) != 0) {
+			ASE_ERR("Failed to start memory read worker %d\n", w);
+			break;
+		}
+		membus_rd_num_workers += 1;
+	}
+
+	ASE_MSG("Memory read requests served by %d workers\n", membus_rd_num_workers);
+}
+
+
+/*
+ * Stop the read worker pool. Called after membus_rd_watcher has exited.
+ * Workers finish the request in hand, drop the rest of the queue and
+ * exit. They are never cancelled, since a worker may hold the queue lock
+ * or a page reference. A worker blocked sending a response waits for the
+ * simulator to drain the queue, and mqueue_send() ends the process if the
+ * simulator is gone.
+ */
+static void membus_rd_workers_stop(void)
+{
+	pthread_mutex_lock(&membus_rd_queue_lock);
+	membus_rd_stop = true;
+	__atomic_fetch_add(&membus_rd_work, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&membus_rd_space, 1, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&membus_rd_queue_lock);
+	ase_futex_wake(&membus_rd_work);
+	ase_futex_wake(&membus_rd_space);
+
+	for (int w = 0; w < membus_rd_num_workers; w += 1)
+		pthread_join(membus_rd_worker_tid[w], NULL);
+	membus_rd_num_workers = 0;
+}
+
+
+/*
+ * Service simulator memory read/write requests.
+ */
+static void *membus_rd_watcher(void *arg)
+{
+	UNUSED_PARAM(arg);
+	// Mark as thread that can be cancelled anytime
+	pthread_setcanceltype(PTHREAD_CANCEL_ENABLE, NULL);
+
+	ase_host_memory_read_req rd_req;
+
+	pcie_atc_active = false;
+
+	// While application is running
+	while (membus_exist_status == ESTABLISHED) {
+		if (mqueue_recv(sim2app_membus_rd_req_rx, (char *) &rd_req, sizeof(rd_req)) == ASE_MSG_PRESENT) {
+			if (membus_rd_num_workers)
+				membus_rd_queue_push(&rd_req);
+			else
+				membus_rd_serve(&rd_req);
 
 			// Check PCIe for PCIe ATS timeout errors. ASE doesn't get an event
 			// for every simulated cycle. Use memory traffic as a proxy for time.
@@ -1921,6 +2431,9 @@ static void *membus_wr_watcher(void *arg)
 	ase_host_memory_write_rsp wr_rsp;
 	ase_memset(&wr_rsp, 0, sizeof(wr_rsp));
 
+	// Successful NAK_ONLY writes not yet acknowledged by a watermark
+	uint32_t wr_unacked = 0;
+
 	// Allocate a buffer to hold the data
 	char *data = ase_malloc(HOST_MEM_MAX_DATA_SIZE);
 	int r;
@@ -1941,6 +2454,7 @@ static void *membus_wr_watcher(void *arg)
 			}
 
 			wr_rsp.pa = wr_req.addr;
+			wr_rsp.seq = wr_req.seq;
 			if (wr_req.addr_type == HOST_MEM_AT_UNTRANS)
 				wr_rsp.va = ase_host_memory_iova_to_va(wr_req.afu_idx, wr_req.addr, true);
 			else
@@ -2003,7 +2517,14 @@ static void *membus_wr_watcher(void *arg)
 			}
 			ase_host_memory_unlock();
 
-			mqueue_send(app2sim_membus_wr_rsp_tx, (char *) &wr_rsp, sizeof(wr_rsp));
+			// Failed writes are always reported. Successful ones are
+			// acknowledged in groups when the simulator allows it.
+			if ((wr_rsp.status != HOST_MEM_STATUS_VALID) ||
+			    !(wr_req.flags & HOST_MEM_WR_FLAG_NAK_ONLY) ||
+			    (++wr_unacked == HOST_MEM_WR_ACK_INTERVAL)) {
+				mqueue_send(app2sim_membus_wr_rsp_tx, (char *) &wr_rsp, sizeof(wr_rsp));
+				wr_unacked = 0;
+			}
 
 			// Check PCIe for PCIe ATS timeout errors. ASE doesn't get an event
 			// for every simulated cycle. Use memory traffic as a proxy for time.
@@ -2011,6 +2532,12 @@ static void *membus_wr_watcher(void *arg)
 				ASE_ERR("Aborting!\n");
 				raise(SIGABRT);
 			}
+		} else if (wr_unacked) {
+			// No more requests queued. Send a watermark covering the
+			// writes completed so far.
+			wr_rsp.status = HOST_MEM_STATUS_VALID;
+			mqueue_send(app2sim_membus_wr_rsp_tx, (char *) &wr_rsp, sizeof(wr_rsp));
+			wr_unacked = 0;
 		}
 	}
 
@@ -2158,6 +2685,10 @@ static uint64_t ilog2_ceil(uint64_t n)
  */
 void __attribute__((visibility("default"))) ase_mem_unmap_hook(void *va, size_t length)
 {
+	// Zero-copy buffers in the range will no longer match the application's
+	// memory. Requests to them are sent to the application again.
+	ase_zcopy_va_changed((uint64_t)va, length);
+
 	// Invalidate pages only if an address translation request has been seen.
 	// This way ASE sends address space invalidation messages only to AFUs that
 	// are caching translations.
@@ -2196,7 +2727,7 @@ static int send_fd(int sock_fd, int fd, struct event_request *req)
 	char buf[CMSG_SPACE(sizeof(int))];
 
 	ase_memset(buf, 0x0, sizeof(buf));
-	struct iovec io = { .iov_base = req, .iov_len = sizeof(struct event_request *) };
+	struct iovec io = { .iov_base = req, .iov_len = sizeof(struct event_request) };
 
 	cmsg = (struct cmsghdr *)buf;
 	cmsg->cmsg_level = SOL_SOCKET;
@@ -2212,6 +2743,12 @@ static int send_fd(int sock_fd, int fd, struct event_request *req)
 	msg.msg_flags = 0;
 	int *fd_ptr = (int *)CMSG_DATA(cmsg);
 	*fd_ptr = fd;
+
+	// Requests without a file descriptor
+	if (fd < 0) {
+		msg.msg_control = NULL;
+		msg.msg_controllen = 0;
+	}
 	if (sendmsg(sock_fd, &msg, 0) == -1) {
 		ASE_ERR("error sending message. errno = %s\n", strerror(errno));
 		close(sock_fd);
@@ -2220,6 +2757,14 @@ static int send_fd(int sock_fd, int fd, struct event_request *req)
 	return 0;
 }
 
+/*
+ * Event handle registered for each interrupt vector, -1 if none. The
+ * simulator receives its own copy of the descriptor with a different
+ * number, so vectors are unregistered by number.
+ */
+static pthread_mutex_t intr_vector_lock = PTHREAD_MUTEX_INITIALIZER;
+static int intr_vector_fd[MAX_USR_INTRS] = { [0 ... MAX_USR_INTRS - 1] = -1 };
+
 /*
  * Register event handle
  */
@@ -2248,11 +2793,18 @@ int register_event(int event_handle, int flags)
 	} else {
 		struct event_request req;
 
+		ase_memset(&req, 0, sizeof(req));
 		req.type = REGISTER_EVENT;
 		req.flags = flags;
 		res = send_fd(sock_fd, event_handle, &req);
 	}
 
+	if ((res == 0) && (flags >= 0) && (flags < MAX_USR_INTRS)) {
+		pthread_mutex_lock(&intr_vector_lock);
+		intr_vector_fd[flags] = event_handle;
+		pthread_mutex_unlock(&intr_vector_lock);
+	}
+
 	close(sock_fd);
 	return res;
 }
@@ -2266,6 +2818,7 @@ int unregister_event(int event_handle)
 	int res;
 	struct event_request req;
 	int sock_fd;
+	int i;
 
 	res = generate_sockname(saddr.sun_path);
 	if (res < 0) {
@@ -2288,13 +2841,107 @@ int unregister_event(int event_handle)
 	} else {
 		ase_memset(&req, 0, sizeof(req));
 		req.type = UNREGISTER_EVENT;
-		res = send_fd(sock_fd, event_handle, &req);
+
+		// Vectors registered with this handle
+		pthread_mutex_lock(&intr_vector_lock);
+		for (i = 0; i < MAX_USR_INTRS; i++) {
+			if (intr_vector_fd[i] == event_handle)
+				req.vectors |= UINT64_C(1) << i;
+		}
+		pthread_mutex_unlock(&intr_vector_lock);
+
+		res = send_fd(sock_fd, -1, &req);
+	}
+
+	if (res == 0) {
+		pthread_mutex_lock(&intr_vector_lock);
+		for (i = 0; i < MAX_USR_INTRS; i++) {
+			if ((req.vectors & (UINT64_C(1) << i)) &&
+			    (intr_vector_fd[i] == event_handle))
+				intr_vector_fd[i] = -1;
+		}
+		pthread_mutex_unlock(&intr_vector_lock);
 	}
 
 	close(sock_fd);
 	return res;
 }
 
+/*
+ * Send a request to the event server and wait for its status reply
+ */
+static int event_request_sync(int fd, struct event_request *req)
+{
+	struct sockaddr_un saddr;
+	int res;
+	int sock_fd;
+	int32_t status;
+
+	saddr.sun_family = AF_UNIX;
+	res = generate_sockname(saddr.sun_path);
+	if (res < 0) {
+		return 1;
+	}
+	/* open socket */
+	sock_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock_fd < 0) {
+		ASE_ERR("Error opening socket: %s\n", strerror(errno));
+		return 1;
+	}
+	res = connect(sock_fd, (struct sockaddr *) &saddr,
+			  sizeof(struct sockaddr_un));
+	if (res < 0) {
+		ASE_ERR("%s: Error connecting to stream socket: %s\n",
+			__func__, strerror(errno));
+		close(sock_fd);
+		return 1;
+	}
+
+	// send_fd() closes the socket on error
+	if (send_fd(sock_fd, fd, req) != 0) {
+		return 1;
+	}
+
+	if (TEMP_FAILURE_RETRY(recv(sock_fd, &status, sizeof(status), MSG_WAITALL)) != sizeof(status)) {
+		ASE_ERR("%s: No reply from event server\n", __func__);
+		status = 1;
+	}
+
+	close(sock_fd);
+	return (status != 0);
+}
+
+/*
+ * Share a zero-copy DMA buffer with the simulator. Returns once the
+ * simulator has mapped it.
+ */
+int register_dma_buffer(int fd, int32_t afu_idx, uint64_t iova, uint64_t length)
+{
+	struct event_request req;
+
+	ase_memset(&req, 0, sizeof(req));
+	req.type = REGISTER_DMA_BUFFER;
+	req.afu_idx = afu_idx;
+	req.iova = iova;
+	req.length = length;
+	return event_request_sync(fd, &req);
+}
+
+/*
+ * Drop the simulator's mapping of a zero-copy DMA buffer. Must complete
+ * before the IOVA is released and can be reused.
+ */
+int unregister_dma_buffer(int32_t afu_idx, uint64_t iova)
+{
+	struct event_request req;
+
+	ase_memset(&req, 0, sizeof(req));
+	req.type = UNREGISTER_DMA_BUFFER;
+	req.afu_idx = afu_idx;
+	req.iova = iova;
+	return event_request_sync(-1, &req);
+}
+
 /*
  * ase_portctrl: Send port control message to simulator
  *
@@ -2306,42 +2953,104 @@ int unregister_event(int event_handle)
  */
 void __attribute__ ((optimize("O0"))) ase_portctrl(ase_portctrl_cmd command, int value)
 {
-	char ctrl_msg[ASE_MQ_MSGSIZE]  = { 0 };
-	char rx_msg[ASE_MQ_MSGSIZE] = { 0 };
-
-	// ASE Capability register
-	struct ase_capability_t tmp_cap;
+	struct ase_portctrl_req req;
+	struct ase_portctrl_rsp rsp;
 
 	// construct message
-	snprintf(ctrl_msg, ASE_MQ_MSGSIZE, "%d %d", (int)command, value);
-
-	// Send message
-	mqueue_send(app2sim_portctrl_req_tx, ctrl_msg, ASE_MQ_MSGSIZE);
+	ase_memset(&req, 0, sizeof(req));
+	req.version = ASE_CTRL_VERSION;
+	req.cmd = command;
+	req.value = value;
+	req.features = APP_FEATURES;
+
+	// Send message, after any pinned page notes
+	pthread_mutex_lock(&portctrl_lock);
+	pin_notes_send();
+	mqueue_send(app2sim_portctrl_req_tx, (char *) &req, sizeof(req));
+	pthread_mutex_unlock(&portctrl_lock);
 
 	// Receive message
-	mqueue_recv(sim2app_portctrl_rsp_rx, rx_msg, ASE_MQ_MSGSIZE);
-
-	// Copy to ase_capability
-	ase_memcpy(&tmp_cap, rx_msg, sizeof(struct ase_capability_t));
-
-	// Check capability register integrity
-	if (command == ASE_INIT) {
-		// Set Capability register only when ASE_INIT is used
-		ase_memcpy(&ase_capability, &tmp_cap, sizeof(struct ase_capability_t));
-
-		// Make a check for the magic word
-		if (memcmp(ase_capability.magic_word, ASE_UNIQUE_ID, sizeof(ASE_UNIQUE_ID)) != 0) {
-			// Restore defaults
-			ASE_MSG("ASE Capability register was corrupted, loading defaults\n");
-			ase_capability.umsg_feature = 0;
-			ase_capability.intr_feature = 0;
-			ase_capability.mmio_512bit = 0;
-		}
+	ase_memset(&rsp, 0, sizeof(rsp));
+	mqueue_recv(sim2app_portctrl_rsp_rx, (char *) &rsp, sizeof(rsp));
+
+	// Set Capability register only when ASE_INIT is used
+	if (command == ASE_INIT)
+		set_capability(&rsp);
+}
+
+
+/*
+ * Set the ASE capability register from the features negotiated with
+ * the simulator
+ */
+static void set_capability(const struct ase_portctrl_rsp *rsp)
+{
+	if (rsp->version != ASE_CTRL_VERSION) {
+		ASE_ERR("Simulator port control protocol version %u, expected %u.\n"
+			"Rebuild the application and simulator from the same ASE release.\n",
+			rsp->version, ASE_CTRL_VERSION);
+		session_deinit();
+		exit(1);
+	}
+
+	ctrl_features = rsp->features;
+	ase_capability.umsg_feature = (ctrl_features & ASE_FEATURE_UMSG) ? 1 : 0;
+	ase_capability.intr_feature = (ctrl_features & ASE_FEATURE_INTR) ? 1 : 0;
+	ase_capability.mmio_512bit = (ctrl_features & ASE_FEATURE_MMIO512) ? 1 : 0;
+
+	// Print ASE Capabilities on console
+	ASE_MSG("ASE Capabilities: Base %s %s %s\n",
+		ase_capability.umsg_feature ? "UMsg" : "",
+		ase_capability.intr_feature ? "Intr" : "",
+		ase_capability.mmio_512bit  ? "MMIO512" : "");
+}
+
+
+/*
+ * Start the session over the simulator's session socket. The reply
+ * carries the session ID and capabilities, so neither ASE_INIT nor the
+ * session ID file is needed. Returns non-zero if the simulator has no
+ * session socket or refused the request.
+ */
+static int session_handshake(void)
+{
+	struct sockaddr_un saddr;
+	struct ase_session_req req;
+	struct ase_session_rsp rsp;
+	int sock_fd;
+	int len;
+
+	saddr.sun_family = AF_UNIX;
+	len = snprintf(saddr.sun_path, sizeof(saddr.sun_path), "%s/%s",
+		       ase_workdir_path, ASE_SESSION_SOCKNAME);
+	if ((len < 0) || (len >= (int)sizeof(saddr.sun_path)))
+		return 1;
+
+	sock_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (sock_fd < 0)
+		return 1;
+
+	if (connect(sock_fd, (struct sockaddr *) &saddr, sizeof(saddr)) < 0) {
+		close(sock_fd);
+		return 1;
+	}
 
-		// Print ASE Capabilities on console
-		ASE_MSG("ASE Capabilities: Base %s %s %s\n",
-			ase_capability.umsg_feature ? "UMsg" : "",
-			ase_capability.intr_feature ? "Intr" : "",
-			ase_capability.mmio_512bit  ? "MMIO512" : "");
+	ase_memset(&req, 0, sizeof(req));
+	req.version = ASE_CTRL_VERSION;
+	req.pid = getpid();
+	req.features = APP_FEATURES;
+	if ((send(sock_fd, &req, sizeof(req), MSG_NOSIGNAL) != sizeof(req)) ||
+	    (TEMP_FAILURE_RETRY(recv(sock_fd, &rsp, sizeof(rsp), MSG_WAITALL)) != sizeof(rsp)) ||
+	    (rsp.status != 0)) {
+		close(sock_fd);
+		return 1;
 	}
+	close(sock_fd);
+
+	ase_memcpy(tstamp_string, rsp.session_id, sizeof(tstamp_string));
+	tstamp_string[sizeof(tstamp_string) - 1] = '\0';
+	set_capability(&rsp.ctrl);
+
+	ASE_MSG("Session started over the session socket\n");
+	return 0;
 }
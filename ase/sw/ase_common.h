@@ -112,10 +112,20 @@
 #define MMIO_TID_BITWIDTH          9
 #define MMIO_TID_BITMASK           (uint32_t)(pow((uint32_t)2, MMIO_TID_BITWIDTH)-1)
 #define MMIO_MAX_OUTSTANDING       64
+// A tid carries its scoreboard slot in the low bits and a per-slot
+// generation count above them, so responses index the scoreboard directly.
+#define MMIO_SLOT_BITWIDTH         6
+#define MMIO_SLOT_BITMASK          (MMIO_MAX_OUTSTANDING - 1)
+// Asynchronous reads that may be in flight at once. One scoreboard slot is
+// kept for blocking accesses so they can't be starved by unclaimed reads.
+#define MMIO_MAX_ASYNC_READS       (MMIO_MAX_OUTSTANDING - 1)
 
 // Number of UMsgs per AFU
 #define NUM_UMSG_PER_AFU           8
 
+// Longest idle interval of the UMsg watcher (usec)
+#define UMSG_POLL_MAX_US           256
+
 // UMAS region
 #define UMAS_LENGTH                (NUM_UMSG_PER_AFU * ASE_PAGESIZE)
 #define UMAS_REGION_MEMSIZE        (2*1024*1024)
@@ -127,6 +137,10 @@
 // Max number of user interrupts
 #define MAX_USR_INTRS              64
 
+// Longest time an AFU interrupt is held waiting for the application to
+// register its event handle (msec)
+#define INTR_PENDING_MAX_MS        1000
+
 /*
  * ASE Debug log-level
  * -------------------
@@ -218,6 +232,10 @@ int generate_sockname(char *);
 	ase_print(ASE_LOG_MESSAGE, LOG_PREFIX format, ## __VA_ARGS__)
 #endif
 
+// ASE_MSG output is on. Hot paths test this first so that a silenced
+// message costs no argument setup or formatting.
+#define ASE_MSG_ENABLED()  (get_loglevel() != ASE_LOG_SILENT)
+
 #ifdef ASE_DBG
 #undef ASE_DBG
 #endif
@@ -253,6 +271,9 @@ extern char tstamp_filepath[ASE_FILEPATH_LEN];
 #define ASE_READY_FILENAME ".ase_ready.pid"
 #define APP_LOCK_FILENAME  ".app_lock.pid"
 
+// Session socket, see struct ase_session_req
+#define ASE_SESSION_SOCKNAME ".ase_session.sock"
+
 // ASE Mode macros
 #define ASE_MODE_DAEMON_NO_SIMKILL   1
 #define ASE_MODE_DAEMON_SIMKILL      2
@@ -304,7 +325,8 @@ typedef enum {
     AFU_RESET,
     ASE_SIMKILL,
     ASE_INIT,
-    UMSG_MODE
+    UMSG_MODE,
+    ASE_PIN_NOTES
 } ase_portctrl_cmd;
 
 // Test complete separator
@@ -481,6 +503,20 @@ int ase_strncpy_s(char *, size_t, const char *, size_t);
 int ase_strcmp_s(const char *, size_t, const char *, int *);
 int ase_memset_s(void *, size_t, int, size_t);
 
+// Adaptive waits: spin up to ASE_SPIN_LIMIT times, then sleep on a futex
+#define ASE_SPIN_LIMIT   1000
+int ase_futex_wait(volatile uint32_t *, uint32_t, long);
+void ase_futex_wake(volatile uint32_t *);
+
+static inline void ase_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#else
+	__asm__ __volatile__("" : : : "memory");
+#endif
+}
+
 // Message queue operations
 void ipc_init(void);
 int mqueue_open(char *, int);
@@ -488,6 +524,10 @@ void mqueue_close(int);
 
 void mqueue_send(int, const char *, int);
 int mqueue_recv(int, char *, int);
+int mqueue_recv_fifo(int, char *, int, int *);
+#ifdef SIM_SIDE
+bool mqueue_rx_pending(void);
+#endif
 
 // Timestamp functions
 void put_timestamp(void);
@@ -529,7 +569,6 @@ extern "C" {
 	// MMIO activity
 	int get_scoreboard_slot_by_tid(int);
 	int count_mmio_tid_used(void);
-	uint32_t generate_mmio_tid(void);
 	int mmio_request_put(struct mmio_t *);
 	void mmio_response_get(struct mmio_t *);
 	void mmio_write32(int, int, uint32_t);
@@ -537,10 +576,12 @@ extern "C" {
 	void mmio_read32(int, int, uint32_t *);
 	void mmio_read64(int, int, uint64_t *);
 	void mmio_write512(int, int, const void *);
+	int mmio_read_async(int, int, int, uint64_t *);
+	int mmio_read_async_wait(uint64_t, uint64_t *);
 
 	// UMSG functions
 	// uint64_t *umsg_get_address(int);
-	//void umsg_send(int, uint64_t *);
+	void umsg_send(int, const uint64_t *);
 	void umsg_set_attribute(uint32_t);
 	// Driver activity
 	void ase_portctrl(ase_portctrl_cmd, int);
@@ -612,16 +653,31 @@ extern struct ipc_t mq_array[ASE_MQ_INSTANCES];
 #define SOCKNAME "/tmp/ase_event_server_"
 enum request_type {
 	REGISTER_EVENT = 0,
-	UNREGISTER_EVENT = 1
+	UNREGISTER_EVENT = 1,
+	// Zero-copy DMA buffers (see ase_zcopy.h). The simulator replies
+	// with an int32_t status.
+	REGISTER_DMA_BUFFER = 2,
+	UNREGISTER_DMA_BUFFER = 3
 };
 
 struct event_request {
 	enum request_type type;
 	int flags;
+
+	// DMA buffer requests only
+	int32_t afu_idx;
+	uint32_t rsvd;
+	uint64_t iova;
+	uint64_t length;
+
+	// UNREGISTER_EVENT only, a bit mask of interrupt vectors
+	uint64_t vectors;
 };
 
 int register_event(int event_handle, int flags);
 int unregister_event(int event_handle);
+int register_dma_buffer(int fd, int32_t afu_idx, uint64_t iova, uint64_t length);
+int unregister_dma_buffer(int32_t afu_idx, uint64_t iova);
 
 // ---------------------------------------------------------------------
 // Enable memory test function
@@ -674,9 +730,18 @@ struct ase_cfg_t {
 	int enable_cl_view;
 	int usr_tps;
 	int phys_memory_available_gb;
+	int enable_ipc_rings;
+	int write_combine_cycles;
 };
 extern struct ase_cfg_t *cfg;
 
+// HSSI channel plugins named in ase.cfg (HSSI_PLUGIN, HSSI_PLUGIN_CHAN<n>).
+// NULL selects the default plugin.
+#define ASE_HSSI_MAX_CHANNELS 16
+extern char *hssi_plugin_path[ASE_HSSI_MAX_CHANNELS];
+// Close and unload the plugins at the end of the simulation
+void hssi_plugins_close(void);
+
 /*
  * Data-exchange functions and structures
  */
@@ -728,7 +793,7 @@ void sw_reset_response(void);
 
 // Read system memory line
 void rd_memline_req_dex(cci_pkt *pkt);
-void rd_memline_rsp_dex(cci_pkt *pkt);
+int rd_memline_rsp_dex(cci_pkt *pkt);
 
 // Write system memory line
 void wr_memline_req_dex(cci_pkt *pkt);
@@ -803,15 +868,14 @@ extern int app2sim_pcie_msg_rx;
 #define DEFEATURE_ATOMICS
 
 /*
- * Platform specific switches are enabled here
- * - ase_magic - ensure that the data is legal (0xFACEF00D is default)
+ * Platform specific switches, set from the features negotiated with
+ * the simulator (ASE_FEATURE_*)
  * - umsg_feature - Enable Umsg feature
  * - intr_feature - Enable Interrupt feature
  * - mmio_512bit  - Enable 512-bit MMIO Write
  *
  */
 struct ase_capability_t {
-    char magic_word[sizeof(ASE_UNIQUE_ID)];
     int  umsg_feature;
     int  intr_feature;
     int  mmio_512bit;
@@ -819,6 +883,70 @@ struct ase_capability_t {
 
 extern struct ase_capability_t ase_capability;
 
+/*
+ * Port control protocol. Requests are struct ase_portctrl_req and each
+ * is answered with struct ase_portctrl_rsp, except ASE_PIN_NOTES. The
+ * version is checked on every request, so an application and simulator
+ * built from different releases fail at ASE_INIT. Features are
+ * negotiated at ASE_INIT: the response carries the features both sides
+ * support.
+ */
+#define ASE_CTRL_VERSION          2
+
+#define ASE_FEATURE_UMSG          (1 << 0)
+#define ASE_FEATURE_INTR          (1 << 1)
+#define ASE_FEATURE_MMIO512       (1 << 2)
+// The simulator logs pinned pages, see ASE_PIN_NOTES
+#define ASE_FEATURE_PIN_NOTES     (1 << 3)
+
+struct ase_portctrl_req {
+	uint32_t version;            // ASE_CTRL_VERSION
+	int32_t cmd;                 // ase_portctrl_cmd
+	int32_t value;
+	uint32_t features;           // ASE_INIT: features the application supports
+	uint32_t num_notes;          // ASE_PIN_NOTES: notes following the request
+	uint32_t rsvd;
+};
+
+struct ase_portctrl_rsp {
+	uint32_t version;            // ASE_CTRL_VERSION
+	uint32_t features;           // Negotiated at ASE_INIT
+};
+
+/*
+ * Pinned and unpinned host memory pages, sent only for the simulator's
+ * workspace log. Notes are batched by the application, up to
+ * ASE_PIN_NOTES_MAX in one ASE_PIN_NOTES message.
+ */
+struct ase_pin_note {
+	uint64_t va;
+	uint64_t iova;
+	uint32_t length;
+	uint32_t pinned;             // 0 when the page was unpinned
+};
+
+#define ASE_PIN_NOTES_MAX \
+	((ASE_MQ_MSGSIZE - sizeof(struct ase_portctrl_req)) / sizeof(struct ase_pin_note))
+
+/*
+ * Session handshake. The simulator listens on ASE_SESSION_SOCKNAME in
+ * the work directory. An application sends ase_session_req and gets
+ * ase_session_rsp once the session is set up, in place of ASE_INIT on
+ * the port control channel and the wait for .ase_timestamp. Without
+ * the socket, applications fall back to ASE_INIT.
+ */
+struct ase_session_req {
+	uint32_t version;            // ASE_CTRL_VERSION
+	int32_t pid;
+	uint32_t features;
+};
+
+struct ase_session_rsp {
+	int32_t status;              // 0 when the session was started
+	char session_id[20];         // Same as .ase_timestamp
+	struct ase_portctrl_rsp ctrl;
+};
+
 // ------------------------------------------ //
 #ifdef FPGA_PLATFORM_INTG_XEON
 #define ASE_ENABLE_UMSG_FEATURE
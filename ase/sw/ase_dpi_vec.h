@@ -0,0 +1,139 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Word-level access to DPI-C packed bit vectors.
+//
+// An svBitVecVal vector is an array of 32 bit words, with bit i of the
+// vector in bit (i % 32) of word (i / 32). The svGetPartselBit() and
+// svPutPartselBit() calls in the simulator's DPI library move one field
+// per call through a function that handles arbitrary offsets. TLP
+// headers and payloads are DWORD aligned, so most fields can be read
+// and written directly in the vector's words, and full beats are copied
+// with memcpy().
+//
+// When ASE_DEBUG is defined, every access is checked against the DPI
+// library's part-select functions.
+//
+
+#ifndef _ASE_DPI_VEC_H_
+#define _ASE_DPI_VEC_H_
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "svdpi.h"
+
+// Get "width" (1 to 32) bits starting at bit "lsb"
+static inline uint32_t ase_dpi_get_bits(const svBitVecVal *s, uint32_t lsb, uint32_t width)
+{
+    uint32_t w = lsb >> 5;
+    uint32_t b = lsb & 31;
+    uint64_t v = s[w] >> b;
+    if (b + width > 32)
+        v |= (uint64_t)s[w + 1] << (32 - b);
+    v &= (UINT64_C(1) << width) - 1;
+
+#ifdef ASE_DEBUG
+    svBitVecVal ref;
+    svGetPartselBit(&ref, s, lsb, width);
+    assert((uint32_t)v == (ref & (uint32_t)((UINT64_C(1) << width) - 1)));
+#endif
+
+    return v;
+}
+
+// Set "width" (1 to 32) bits starting at bit "lsb" to the low bits of v
+static inline void ase_dpi_put_bits(svBitVecVal *d, uint32_t v, uint32_t lsb, uint32_t width)
+{
+    uint32_t w = lsb >> 5;
+    uint32_t b = lsb & 31;
+    uint64_t mask = ((UINT64_C(1) << width) - 1) << b;
+    uint64_t x = ((uint64_t)v << b) & mask;
+
+    d[w] = (d[w] & ~(uint32_t)mask) | (uint32_t)x;
+    if (b + width > 32)
+        d[w + 1] = (d[w + 1] & ~(uint32_t)(mask >> 32)) | (uint32_t)(x >> 32);
+
+#ifdef ASE_DEBUG
+    svBitVecVal ref;
+    svGetPartselBit(&ref, d, lsb, width);
+    assert((ref & (uint32_t)((UINT64_C(1) << width) - 1)) ==
+           (v & (uint32_t)((UINT64_C(1) << width) - 1)));
+#endif
+}
+
+// Set bits [lsb, lsb + n_bits) of a vector. Used for keep masks, where
+// each bit covers a byte of data.
+static inline void ase_dpi_set_bits(svBitVecVal *d, uint32_t lsb, uint32_t n_bits)
+{
+    while (n_bits)
+    {
+        uint32_t b = lsb & 31;
+        uint32_t n = (n_bits < 32 - b) ? n_bits : 32 - b;
+        d[lsb >> 5] |= (uint32_t)(((UINT64_C(1) << n) - 1) << b);
+        lsb += n;
+        n_bits -= n;
+    }
+}
+
+// Copy n_dw DWORDs from a vector, starting at DWORD src_dw
+static inline void ase_dpi_get_dwords(uint32_t *dst, const svBitVecVal *src,
+                                      uint32_t src_dw, uint32_t n_dw)
+{
+    src += src_dw;
+    memcpy(dst, src, n_dw * 4);
+
+#ifdef ASE_DEBUG
+    for (uint32_t i = 0; i < n_dw; i += 1)
+    {
+        svBitVecVal ref;
+        svGetPartselBit(&ref, src - src_dw, (src_dw + i) * 32, 32);
+        assert(dst[i] == ref);
+    }
+#endif
+}
+
+// Copy n_dw DWORDs to a vector, starting at DWORD dst_dw
+static inline void ase_dpi_put_dwords(svBitVecVal *dst, uint32_t dst_dw,
+                                      const uint32_t *src, uint32_t n_dw)
+{
+    dst += dst_dw;
+    memcpy(dst, src, n_dw * 4);
+
+#ifdef ASE_DEBUG
+    for (uint32_t i = 0; i < n_dw; i += 1)
+    {
+        svBitVecVal ref;
+        svGetPartselBit(&ref, dst - dst_dw, (dst_dw + i) * 32, 32);
+        assert(src[i] == ref);
+    }
+#endif
+}
+
+#endif // _ASE_DPI_VEC_H_
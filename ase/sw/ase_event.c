@@ -0,0 +1,271 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+#include "ase_common.h"
+#include "ase_event.h"
+#include "ase_zcopy.h"
+
+// AFU interrupts are raised on the simulator thread. Event handles are
+// registered by the event socket server on the IO thread.
+static pthread_mutex_t intr_lock = PTHREAD_MUTEX_INITIALIZER;
+static int intr_event_fds[MAX_USR_INTRS];
+// Time an interrupt was raised with no event registered, 0 if none
+static uint64_t intr_pending_ns[MAX_USR_INTRS];
+// Delivery latency for the session
+static uint32_t intr_num_delivered;
+static uint64_t intr_latency_total_ns;
+static uint64_t intr_latency_max_ns;
+
+
+static uint64_t intr_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+/*
+ * Signal the event of interrupt id, raised at raised_ns. Called with
+ * intr_lock held.
+ */
+static void intr_deliver(int id, uint64_t raised_ns)
+{
+	uint64_t val = 1;
+	uint64_t latency_ns;
+
+	if (write(intr_event_fds[id], &val, sizeof(uint64_t)) < 0) {
+		ASE_ERR("SIM-C : Error writing fd %d errno = %s\n",
+			intr_event_fds[id], strerror(errno));
+		return;
+	}
+
+	latency_ns = intr_time_ns() - raised_ns;
+	intr_num_delivered += 1;
+	intr_latency_total_ns += latency_ns;
+	if (latency_ns > intr_latency_max_ns)
+		intr_latency_max_ns = latency_ns;
+
+	ASE_MSG("SIM-C : AFU Interrupt event %d\n", id);
+}
+
+
+/*
+ * Deliver an interrupt held for a newly registered event, unless it has
+ * waited too long. Called with intr_lock held.
+ */
+static void intr_deliver_pending(int id)
+{
+	if (intr_pending_ns[id] == 0)
+		return;
+
+	if ((intr_time_ns() - intr_pending_ns[id]) > (uint64_t)INTR_PENDING_MAX_MS * 1000000)
+		ASE_ERR("SIM-C : No valid event for AFU interrupt %d within %d ms!\n",
+			id, INTR_PENDING_MAX_MS);
+	else
+		intr_deliver(id, intr_pending_ns[id]);
+
+	intr_pending_ns[id] = 0;
+}
+
+
+/*
+ * Report and clear the interrupt state of a finished session.
+ */
+void ase_event_session_end(void)
+{
+	int id;
+
+	pthread_mutex_lock(&intr_lock);
+
+	for (id = 0; id < MAX_USR_INTRS; id++) {
+		if (intr_pending_ns[id])
+			ASE_ERR("SIM-C : No valid event for AFU interrupt %d!\n", id);
+		intr_pending_ns[id] = 0;
+
+		if (intr_event_fds[id] >= 0)
+			close(intr_event_fds[id]);
+		intr_event_fds[id] = -1;
+	}
+
+	if (intr_num_delivered)
+		ASE_INFO_2("AFU interrupts: %u, latency mean %.1f us, max %.1f us\n",
+			   intr_num_delivered,
+			   (double)intr_latency_total_ns / intr_num_delivered / 1000,
+			   (double)intr_latency_max_ns / 1000);
+	intr_num_delivered = 0;
+	intr_latency_total_ns = 0;
+	intr_latency_max_ns = 0;
+
+	pthread_mutex_unlock(&intr_lock);
+}
+
+
+/*
+ * ASE Interrupt generator handle
+ */
+void ase_interrupt_generator(int id)
+{
+	uint64_t now;
+
+	if (id >= MAX_USR_INTRS) {
+		ASE_ERR("SIM-C : Interrupt #%d > avail. interrupts (%d)!\n",
+			id, MAX_USR_INTRS);
+		return;
+	}
+
+	now = intr_time_ns();
+
+	pthread_mutex_lock(&intr_lock);
+	if (intr_event_fds[id] >= 0) {
+		intr_deliver(id, now);
+	} else if (intr_pending_ns[id] == 0) {
+		// Event registration is asynchronous and may not have been
+		// seen yet. Hold the interrupt, like a pending bit, until it is.
+		intr_pending_ns[id] = now;
+		ASE_MSG("SIM-C : AFU Interrupt %d pending, no event registered\n", id);
+	}
+	pthread_mutex_unlock(&intr_lock);
+}
+
+
+/*
+ * Reset the interrupt vectors at simulator start
+ */
+void ase_event_init(void)
+{
+	int i;
+
+	pthread_mutex_lock(&intr_lock);
+	for (i = 0; i < MAX_USR_INTRS; i++) {
+		intr_event_fds[i] = -1;
+		intr_pending_ns[i] = 0;
+	}
+	pthread_mutex_unlock(&intr_lock);
+}
+
+
+/*
+ * Serve one request from a connected event socket
+ */
+int ase_event_request(int sock_fd)
+{
+	struct msghdr msg = {0};
+	char buf[CMSG_SPACE(sizeof(int))];
+	struct event_request req = { .type = 0, .flags = 0 };
+	struct iovec io = { .iov_base = &req, .iov_len = sizeof(req) };
+	struct cmsghdr *cmsg;
+	int *fdptr;
+
+	ase_memset(buf, '\0', sizeof(buf));
+	msg.msg_iov = &io;
+	msg.msg_iovlen = 1;
+	msg.msg_control = buf;
+	msg.msg_controllen = sizeof(buf);
+
+	cmsg = (struct cmsghdr *)buf;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+
+	msg.msg_name = NULL;
+	msg.msg_namelen = 0;
+	msg.msg_iov = &io;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cmsg;
+	msg.msg_controllen = CMSG_LEN(sizeof(int));
+	msg.msg_flags = 0;
+
+	if (recvmsg(sock_fd, &msg, 0) < 0) {
+		ASE_ERR("SIM-C : Unable to rcvmsg from socket\n");
+		return 1;
+	}
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+
+	// Requests without a descriptor
+	if (req.type == UNREGISTER_EVENT) {
+		int i;
+
+		if (cmsg != NULL)
+			close(*(int *)CMSG_DATA(cmsg));
+
+		pthread_mutex_lock(&intr_lock);
+		for (i = 0; i < MAX_USR_INTRS; i++) {
+			if ((req.vectors & (UINT64_C(1) << i)) && (intr_event_fds[i] >= 0)) {
+				close(intr_event_fds[i]);
+				intr_event_fds[i] = -1;
+			}
+		}
+		pthread_mutex_unlock(&intr_lock);
+		return 0;
+	}
+
+	// Zero-copy DMA buffer requests are acknowledged with a status so
+	// the application knows the mapping is in place (or gone).
+	if (req.type == UNREGISTER_DMA_BUFFER) {
+		int32_t status = ase_zcopy_unmap(req.afu_idx, req.iova);
+		send(sock_fd, &status, sizeof(status), MSG_NOSIGNAL);
+		return 0;
+	}
+
+	if (cmsg == NULL) {
+		ASE_ERR("SIM-C : Null pointer from rcvmsg socket\n");
+		return 1;
+	}
+
+	int vector_id = 0;
+
+	fdptr = (int *)CMSG_DATA(cmsg);
+
+	if (req.type == REGISTER_DMA_BUFFER) {
+		int32_t status = ase_zcopy_map(*fdptr, req.afu_idx, req.iova, req.length);
+		// The mapping holds its own reference to the memfd
+		close(*fdptr);
+		send(sock_fd, &status, sizeof(status), MSG_NOSIGNAL);
+		return 0;
+	}
+
+	if (req.type == REGISTER_EVENT) {
+		vector_id = req.flags;
+		if ((vector_id < 0) || (vector_id >= MAX_USR_INTRS)) {
+			ASE_ERR("SIM-C : Event for interrupt #%d > avail. interrupts (%d)!\n",
+				vector_id, MAX_USR_INTRS);
+			close(*fdptr);
+			return 1;
+		}
+
+		pthread_mutex_lock(&intr_lock);
+		if (intr_event_fds[vector_id] >= 0)
+			close(intr_event_fds[vector_id]);
+		intr_event_fds[vector_id] = *fdptr;
+		intr_deliver_pending(vector_id);
+		pthread_mutex_unlock(&intr_lock);
+	}
+	return 0;
+}
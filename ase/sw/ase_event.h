@@ -0,0 +1,54 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+//
+// Event socket requests and AFU interrupt delivery.
+//
+// The application registers an eventfd for each interrupt vector by
+// passing it over the event socket. The descriptor arrives with a new
+// number, so the simulator keeps its copy per vector and unregistering
+// names the vectors rather than the descriptor. The same socket carries
+// the zero-copy DMA buffer requests of ase_zcopy.h.
+//
+// Requests are served on the message queue IO thread. Interrupts are
+// raised on the simulator thread by ase_interrupt_generator(). An
+// interrupt raised while its vector has no event is held, like a pending
+// bit, until an event is registered.
+//
+
+#ifndef _ASE_EVENT_H_
+#define _ASE_EVENT_H_
+
+// Reset the interrupt vectors at simulator start
+void ase_event_init(void);
+
+// Serve one request from a connected event socket. Returns 0 on success.
+int ase_event_request(int sock_fd);
+
+// Report and clear the interrupt state of a finished session
+void ase_event_session_end(void);
+
+#endif // _ASE_EVENT_H_
@@ -34,6 +34,8 @@
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdint.h>
 #include <inttypes.h>
@@ -44,15 +46,75 @@
 #include <opae/mem_alloc.h>
 #include "ase_common.h"
 #include "ase_host_memory.h"
+#include "ase_vma.h"
+#include "ase_zcopy.h"
 #include "token.h"
 
 #define KB 1024
 #define MB (1024 * KB)
 #define GB (1024UL * MB)
 
-static pthread_mutex_t ase_pt_lock = PTHREAD_MUTEX_INITIALIZER;
+// Serializes page table updates. Lookups don't take the lock. The lock is
+// recursive because updates call mmap() and munmap(), which may enter
+// ase_host_memory_va_mapped() through the libase-preload hooks.
+static pthread_mutex_t ase_pt_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
 bool ase_pt_enable_debug = 0;
 
+/*
+ * Readers walk the page table without a lock. Before a lookup, a reader
+ * publishes the address it is translating in its slot below, tagged with
+ * the table being searched. The slot is a reference to the page: it is
+ * held until the reader's access is complete and ase_host_memory_unlock()
+ * is called. Writers change the table first and then wait for readers
+ * holding a reference to an affected page before the unpin returns or
+ * table nodes are freed. Readers of other pages never wait and never
+ * stall writers.
+ */
+#define ASE_PT_MAX_READERS 128
+#define ASE_PT_KEY_TAG_SHIFT 58
+#define ASE_PT_TAG_PA 1
+#define ASE_PT_TAG_IOVA(afu_idx) ((afu_idx) + 2)
+#define ASE_PT_NUM_TAGS (ASE_MAX_TOKENS + 2)
+
+/*
+ * Each reader also has a small software IOTLB, caching recent page
+ * translations so that DMA to the same page doesn't walk the table.
+ * Entries hold the key of the page base, tagged like reader references,
+ * and the page size. An entry is valid only while the generation of its
+ * table is unchanged. Writers bump the generation whenever a page is
+ * dropped or remapped, before waiting for readers.
+ */
+#define ASE_PT_TLB_ENTRIES 8
+
+struct ase_pt_tlb_entry {
+	uint64_t key;
+	uint64_t page_mask;
+	uint64_t va;
+	uint32_t gen;
+	bool unmapped;
+};
+
+struct ase_pt_reader {
+	uint64_t key;
+	bool in_use;
+
+	// Owned by the thread holding the slot
+	bool ref_unmapped;
+	uint32_t tlb_next;
+	uint64_t tlb_hits;
+	uint64_t tlb_misses;
+	struct ase_pt_tlb_entry tlb[ASE_PT_TLB_ENTRIES];
+} __attribute__((aligned(64)));
+
+static struct ase_pt_reader ase_pt_readers[ASE_PT_MAX_READERS];
+static uint32_t ase_pt_gen[ASE_PT_NUM_TAGS];
+
+// IOTLB counters from threads that have exited
+static uint64_t ase_pt_tlb_hits, ase_pt_tlb_misses;
+static __thread struct ase_pt_reader *ase_pt_my_reader;
+static pthread_key_t ase_pt_reader_key;
+static pthread_once_t ase_pt_reader_once = PTHREAD_ONCE_INIT;
+
 /*
  * Tracking structures for IOVA-addressed pinned pages. ASE uses the same
  * code as the OPAE SDK's vfio library to manage the IOVA address space.
@@ -73,20 +135,32 @@ static struct mem_alloc iova_mem_alloc;
 static uint64_t *ase_pa_pt_root;
 
 /*
- * Cache the most recent result of ase_host_memory_va_page_len() because
- * walking /proc/self/smaps is slow. A contiguous range of pages has
- * a single entry in smaps.
+ * Bounds of all VAs ever pinned. munmap() and mmap() outside the bounds
+ * can't affect pinned pages and skip searching the tables.
  */
-static bool cached_page_len_valid;
-static unsigned long long cached_page_range_start, cached_page_range_end;
-static unsigned cached_page_len;
+static uint64_t ase_pt_va_min = UINT64_MAX;
+static uint64_t ase_pt_va_max;
 
 STATIC int ase_pt_length_to_level(uint64_t length);
 static uint64_t ase_pt_level_to_bit_idx(int pt_level);
 static void ase_pt_delete_tree(uint64_t *pt, int pt_level);
-static uint64_t ase_pt_lookup_addr(uint64_t pa, uint64_t *pt_root, int *pt_level);
+static uint64_t ase_pt_lookup_addr(uint64_t pa, uint64_t *pt_root, int *pt_level, bool *unmapped);
+static bool ase_pt_mark_va_range(uint64_t *pt, int pt_level, uint64_t va, uint64_t va_end, bool unmapped);
 static int ase_pt_pin_page(uint64_t va, uint64_t iova, uint64_t *pt_root, int pt_level);
 static int ase_pt_unpin_page(uint64_t iova, uint64_t *pt_root, int pt_level);
+static uint64_t ase_pt_key(uint64_t *pt_root, uint64_t addr);
+static void ase_pt_tlb_shootdown(uint64_t key);
+static void ase_pt_wait_readers(uint64_t key, uint64_t length);
+
+
+/*
+ * Release the page table update lock.
+ */
+static void ase_pt_unlock(void)
+{
+	if (pthread_mutex_unlock(&ase_pt_lock))
+		ASE_ERR("pthread_mutex_lock could not unlock !\n");
+}
 
 
 /*
@@ -109,7 +183,7 @@ int ase_host_memory_alloc_iova(int32_t afu_idx, uint64_t *iova, uint64_t length)
 
 	int status = mem_alloc_get(&iova_mem_alloc, iova, length);
 
-	ase_host_memory_unlock();
+	ase_pt_unlock();
 	return status;
 }
 
@@ -134,25 +208,26 @@ int ase_host_memory_pin(int32_t afu_idx, void *va, uint64_t iova, uint64_t lengt
 		goto err_unlock;
 
 	if (ase_iova_pt_root[afu_idx] == NULL) {
-		ase_iova_pt_root[afu_idx] = mmap(NULL, 4096, PROT_READ | PROT_WRITE,
-					MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
-		if (ase_iova_pt_root[afu_idx] == MAP_FAILED) {
+		uint64_t *pt_root = mmap(NULL, 4096, PROT_READ | PROT_WRITE,
+					 MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
+		if (pt_root == MAP_FAILED) {
 			ASE_ERR("Simulated IOVA page table out of memory!\n");
 			return -1;
 		}
-		ase_memset(ase_iova_pt_root[afu_idx], 0, 4096);
+		ase_memset(pt_root, 0, 4096);
+		__atomic_store_n(&ase_iova_pt_root[afu_idx], pt_root, __ATOMIC_RELEASE);
 	}
 
 	status = ase_pt_pin_page((uint64_t)va, iova, ase_iova_pt_root[afu_idx], pt_level);
 	if (status)
 		goto err_unlock;
 
-	ase_host_memory_unlock();
+	ase_pt_unlock();
 	note_pinned_page((uint64_t)va, iova, length);
 	return 0;
 
 err_unlock:
-	ase_host_memory_unlock();
+	ase_pt_unlock();
 	return status;
 }
 
@@ -169,7 +244,7 @@ int ase_host_memory_free_iova(int32_t afu_idx, uint64_t iova)
 
 	int status = mem_alloc_put(&iova_mem_alloc, iova);
 
-	ase_host_memory_unlock();
+	ase_pt_unlock();
 	return status;
 }
 
@@ -183,6 +258,9 @@ int ase_host_memory_unpin(int32_t afu_idx, uint64_t iova, uint64_t length)
 
 	assert(afu_idx >= 0 && afu_idx < ASE_MAX_TOKENS);
 
+	// The simulator must not access unpinned pages directly
+	ase_zcopy_drop(afu_idx, iova, length);
+
 	if (pthread_mutex_lock(&ase_pt_lock)) {
 		ASE_ERR("pthread_mutex_lock could not attain lock !\n");
 		return -1;
@@ -198,43 +276,137 @@ int ase_host_memory_unpin(int32_t afu_idx, uint64_t iova, uint64_t length)
 			ASE_ERR("Error removing page from IOVA page table (%d)\n", status);
 	}
 
-	ase_host_memory_unlock();
+	ase_pt_unlock();
 	note_unpinned_page(iova, length);
 	return status;
 }
 
 /*
- * Translate from simulated IOVA address space. Optionally hold the lock
- * after translation so that the buffer remains pinned. Callers that set
- * "lock" must call ase_host_memory_unlock() or subsequent calls to
- * ase_host_memory functions will deadlock.
+ * Reader slots are claimed by a thread on first use and released when
+ * the thread exits.
  */
-uint64_t ase_host_memory_iova_to_va(int32_t afu_idx, uint64_t iova, bool lock)
+static void ase_pt_reader_release(void *arg)
 {
-	assert(afu_idx >= 0 && afu_idx < ASE_MAX_TOKENS);
+	struct ase_pt_reader *r = (struct ase_pt_reader *) arg;
 
-	if (pthread_mutex_lock(&ase_pt_lock)) {
-		ASE_ERR("pthread_mutex_lock could not attain lock !\n");
-		return 0;
+	__atomic_add_fetch(&ase_pt_tlb_hits, r->tlb_hits, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&ase_pt_tlb_misses, r->tlb_misses, __ATOMIC_RELAXED);
+	__atomic_store_n(&r->tlb_hits, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&r->tlb_misses, 0, __ATOMIC_RELAXED);
+	ase_memset(r->tlb, 0, sizeof(r->tlb));
+
+	__atomic_store_n(&r->key, 0, __ATOMIC_RELEASE);
+	__atomic_store_n(&r->in_use, false, __ATOMIC_RELEASE);
+}
+
+static void ase_pt_reader_key_init(void)
+{
+	pthread_key_create(&ase_pt_reader_key, ase_pt_reader_release);
+}
+
+static struct ase_pt_reader *ase_pt_reader_get(void)
+{
+	if (ase_pt_my_reader)
+		return ase_pt_my_reader;
+
+	pthread_once(&ase_pt_reader_once, ase_pt_reader_key_init);
+
+	for (int i = 0; i < ASE_PT_MAX_READERS; i += 1) {
+		bool in_use = false;
+		if (__atomic_compare_exchange_n(&ase_pt_readers[i].in_use, &in_use, true,
+						false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+			ase_pt_my_reader = &ase_pt_readers[i];
+			pthread_setspecific(ase_pt_reader_key, ase_pt_my_reader);
+			return ase_pt_my_reader;
+		}
 	}
 
-	// Is the page pinned?
+	ASE_ERR("More than %d threads access simulated host memory!\n", ASE_PT_MAX_READERS);
+	return NULL;
+}
+
+/*
+ * Lock-free translation through the table for "tag", whose root is
+ * published in *root_p. With "lock" set the caller keeps a reference to
+ * the page until ase_host_memory_unlock().
+ */
+static uint64_t ase_pt_translate(uint64_t **root_p, uint64_t tag, uint64_t addr, bool lock)
+{
+	struct ase_pt_reader *r = ase_pt_reader_get();
+	uint64_t key = (tag << ASE_PT_KEY_TAG_SHIFT) | addr;
+	struct ase_pt_tlb_entry *e;
+	uint64_t *pt_root;
 	int pt_level;
 	uint64_t va;
-	va = ase_pt_lookup_addr(iova, ase_iova_pt_root[afu_idx], &pt_level);
+	bool unmapped;
 
-	if (!va)
-	{
-		ase_host_memory_unlock();
+	if (!r)
 		return 0;
+
+	// Publish the reference before reading the generation or the table.
+	// A writer changing the table after this point finds it and waits
+	// for the release. A writer that changed it before has already
+	// bumped the generation, invalidating cached entries.
+	__atomic_store_n(&r->key, key, __ATOMIC_SEQ_CST);
+	uint32_t gen = __atomic_load_n(&ase_pt_gen[tag], __ATOMIC_SEQ_CST);
+
+	// The root is read only after the reference is visible. A table
+	// being torn down is unpublished before the writer waits for
+	// readers, so either it is seen as gone here or the writer waits
+	// for this walk to finish before freeing it.
+	pt_root = __atomic_load_n(root_p, __ATOMIC_SEQ_CST);
+	if (pt_root == NULL) {
+		__atomic_store_n(&r->key, 0, __ATOMIC_RELEASE);
+		return 0;
+	}
+
+	for (int i = 0; i < ASE_PT_TLB_ENTRIES; i += 1) {
+		e = &r->tlb[i];
+		if ((e->gen == gen) && (((key ^ e->key) & ~e->page_mask) == 0)) {
+			__atomic_store_n(&r->tlb_hits, r->tlb_hits + 1, __ATOMIC_RELAXED);
+			if (!lock)
+				__atomic_store_n(&r->key, 0, __ATOMIC_RELEASE);
+			r->ref_unmapped = e->unmapped;
+			return e->va | (addr & e->page_mask);
+		}
 	}
 
-	if (!lock)
-		ase_host_memory_unlock();
+	__atomic_store_n(&r->tlb_misses, r->tlb_misses + 1, __ATOMIC_RELAXED);
+
+	va = ase_pt_lookup_addr(addr, pt_root, &pt_level, &unmapped);
+	if (!va || !lock)
+		__atomic_store_n(&r->key, 0, __ATOMIC_RELEASE);
+	if (!va)
+		return 0;
 
-	// Return VA: page base and offset from IOVA
-	uint64_t offset = iova & ((UINT64_C(1) << ase_pt_level_to_bit_idx(pt_level)) - 1);
-	return va | offset;
+	// Fill a TLB entry. It is tagged with the generation read before the
+	// walk, so an update that raced with the walk invalidates it.
+	uint64_t page_mask = (UINT64_C(1) << ase_pt_level_to_bit_idx(pt_level)) - 1;
+	e = &r->tlb[r->tlb_next];
+	r->tlb_next = (r->tlb_next + 1) % ASE_PT_TLB_ENTRIES;
+	e->key = key & ~page_mask;
+	e->page_mask = page_mask;
+	e->va = va;
+	e->gen = gen;
+	e->unmapped = unmapped;
+	r->ref_unmapped = unmapped;
+
+	// Return VA: page base and offset from the address
+	return va | (addr & page_mask);
+}
+
+
+/*
+ * Translate from simulated IOVA address space. Optionally keep a
+ * reference to the page after translation so that the buffer remains
+ * pinned. Callers that set "lock" must call ase_host_memory_unlock()
+ * when the access is complete or attempts to unpin the page will hang.
+ */
+uint64_t ase_host_memory_iova_to_va(int32_t afu_idx, uint64_t iova, bool lock)
+{
+	assert(afu_idx >= 0 && afu_idx < ASE_MAX_TOKENS);
+
+	return ase_pt_translate(&ase_iova_pt_root[afu_idx], ASE_PT_TAG_IOVA(afu_idx), iova, lock);
 }
 
 
@@ -265,79 +437,7 @@ static inline uint64_t ase_host_memory_gen_xor_mask(int pt_level)
  */
 int64_t ase_host_memory_va_page_len(uint64_t va)
 {
-	int64_t page_size;
-	char line[4096];
-
-	if (cached_page_len_valid && (cached_page_range_start <= va) && (va < cached_page_range_end))
-		return cached_page_len;
-
-	page_size = 0;
-
-	FILE *f = fopen("/proc/self/smaps", "r");
-	if (f == NULL)
-	{
-		return -1;
-	}
-
-	while (fgets(line, sizeof(line), f))
-	{
-		unsigned long long start, end;
-		char* tmp0;
-		char* tmp1;
-
-		// Range entries begin with <start va>-<end va>
-		start = strtoll(line, &tmp0, 16);
-		// Was a number found and is the next character a dash?
-		if ((tmp0 == line) || (*tmp0 != '-'))
-		{
-			// No -- not a range
-			continue;
-		}
-
-		end = strtoll(++tmp0, &tmp1, 16);
-		// Keep searching if not a number or the address isn't in range.
-		if ((tmp0 == tmp1) || (start > va) || (end <= va))
-		{
-			continue;
-		}
-
-		while (fgets(line, sizeof(line), f))
-		{
-			// Look for KernelPageSize
-			unsigned page_kb;
-			int ret = sscanf(line, "KernelPageSize: %u kB", &page_kb);
-			if (ret == 0)
-				continue;
-
-			fclose(f);
-
-			if (ret < 1 || page_kb == 0) {
-				return -1;
-			}
-
-			// page_kb is reported in kB. Convert to bytes.
-			int64_t sz = -1;
-			if (page_kb >= 1048576)
-				sz = GB;
-			else if (page_kb >= 2048)
-				sz = 2 * MB;
-			else if (page_kb >= 4)
-				sz = 4 * KB;
-			else
-				return -1;
-
-			cached_page_len_valid = true;
-			cached_page_range_start = start;
-			cached_page_range_end = end;
-			cached_page_len = sz;
-
-			return sz;
-		}
-	}
-
-	// We couldn't find an entry for this addr in smaps.
-	fclose(f);
-	return 0;
+	return ase_vma_page_len(va);
 }
 
 
@@ -370,7 +470,7 @@ uint64_t ase_host_memory_va_to_pa(uint64_t va, uint64_t *length)
 	// Is the address already in the table?
 	uint64_t cur_table_va;
 	int cur_pt_level;
-	cur_table_va = ase_pt_lookup_addr(pa, ase_pa_pt_root, &cur_pt_level);
+	cur_table_va = ase_pt_lookup_addr(pa, ase_pa_pt_root, &cur_pt_level, NULL);
 	if (cur_table_va)
 	{
 		if (cur_table_va != va || cur_pt_level != pt_level)
@@ -386,39 +486,18 @@ uint64_t ase_host_memory_va_to_pa(uint64_t va, uint64_t *length)
 out_unlock:
 	if (length)
 		*length = page_len;
-	ase_host_memory_unlock();
+	ase_pt_unlock();
 	return pa;
 
 err_unlock:
-	ase_host_memory_unlock();
+	ase_pt_unlock();
 	return INT64_C(-1);
 }
 
 
 uint64_t ase_host_memory_pa_to_va(uint64_t pa, bool lock)
 {
-	if (pthread_mutex_lock(&ase_pt_lock)) {
-		ASE_ERR("pthread_mutex_lock could not attain lock !\n");
-		return 0;
-	}
-
-	// Is the page pinned?
-	int pt_level;
-	uint64_t va;
-	va = ase_pt_lookup_addr(pa, ase_pa_pt_root, &pt_level);
-
-	if (!va)
-	{
-		ase_host_memory_unlock();
-		return 0;
-	}
-
-	if (!lock)
-		ase_host_memory_unlock();
-
-	// Return VA: page base and offset from IOVA
-	uint64_t offset = pa & ((UINT64_C(1) << ase_pt_level_to_bit_idx(pt_level)) - 1);
-	return va | offset;
+	return ase_pt_translate(&ase_pa_pt_root, ASE_PT_TAG_PA, pa, lock);
 }
 
 
@@ -449,16 +528,80 @@ void ase_host_memory_inval_va_range(uint64_t va, uint64_t length)
 		va += page_len;
 	}
 
-	ase_host_memory_unlock();
+	ase_pt_unlock();
 }
 
 
+/*
+ * Drop the page reference held by the calling thread after a translation
+ * with "lock" set.
+ */
 void ase_host_memory_unlock(void)
 {
-	cached_page_len_valid = false;
+	if (ase_pt_my_reader)
+		__atomic_store_n(&ase_pt_my_reader->key, 0, __ATOMIC_RELEASE);
+}
 
-	if (pthread_mutex_unlock(&ase_pt_lock))
-		ASE_ERR("pthread_mutex_lock could not unlock !\n");
+
+/*
+ * Was the page referenced by the calling thread's most recent translation
+ * unmapped while pinned?
+ */
+bool ase_host_memory_ref_unmapped(void)
+{
+	return ase_pt_my_reader && ase_pt_my_reader->ref_unmapped;
+}
+
+
+/*
+ * Flag pinned pages in [va, va + length) as unmapped or, when "mapped" is
+ * set, clear the flag. Called from the libase-preload hooks after the
+ * address space changes.
+ */
+void ase_host_memory_va_mapped(uint64_t va, uint64_t length, bool mapped)
+{
+	uint64_t va_end = va + length;
+
+	if ((va_end <= __atomic_load_n(&ase_pt_va_min, __ATOMIC_RELAXED)) ||
+	    (va >= __atomic_load_n(&ase_pt_va_max, __ATOMIC_RELAXED)))
+		return;
+
+	if (pthread_mutex_lock(&ase_pt_lock)) {
+		ASE_ERR("pthread_mutex_lock could not attain lock !\n");
+		return;
+	}
+
+	for (int i = 0; i < ASE_MAX_TOKENS; i += 1) {
+		if (ase_iova_pt_root[i] &&
+		    ase_pt_mark_va_range(ase_iova_pt_root[i], 3, va, va_end, !mapped))
+			ase_pt_tlb_shootdown(ase_pt_key(ase_iova_pt_root[i], 0));
+	}
+
+	if (ase_pa_pt_root &&
+	    ase_pt_mark_va_range(ase_pa_pt_root, 3, va, va_end, !mapped))
+		ase_pt_tlb_shootdown(ase_pt_key(ase_pa_pt_root, 0));
+
+	ase_pt_unlock();
+}
+
+
+/*
+ * Sum IOTLB hits and misses over all threads, past and present.
+ */
+void ase_host_memory_tlb_stats(uint64_t *hits, uint64_t *misses)
+{
+	uint64_t h = __atomic_load_n(&ase_pt_tlb_hits, __ATOMIC_RELAXED);
+	uint64_t m = __atomic_load_n(&ase_pt_tlb_misses, __ATOMIC_RELAXED);
+
+	for (int i = 0; i < ASE_PT_MAX_READERS; i += 1) {
+		h += __atomic_load_n(&ase_pt_readers[i].tlb_hits, __ATOMIC_RELAXED);
+		m += __atomic_load_n(&ase_pt_readers[i].tlb_misses, __ATOMIC_RELAXED);
+	}
+
+	if (hits)
+		*hits = h;
+	if (misses)
+		*misses = m;
 }
 
 
@@ -492,10 +635,15 @@ void ase_host_memory_terminate_afu(int32_t afu_idx)
 	if (afu_idx < 0 || afu_idx >= ASE_MAX_TOKENS)
 		return;
 
-	if (ase_iova_pt_root[afu_idx])
+	uint64_t *pt_root = ase_iova_pt_root[afu_idx];
+	if (pt_root)
 	{
-		ase_pt_delete_tree(ase_iova_pt_root[afu_idx], 3);
-		ase_iova_pt_root[afu_idx] = NULL;
+		// Unpublish the table and wait for readers still walking it
+		uint64_t key = ase_pt_key(pt_root, 0);
+		__atomic_store_n(&ase_iova_pt_root[afu_idx], NULL, __ATOMIC_SEQ_CST);
+		ase_pt_wait_readers(key, UINT64_C(1) << ASE_PT_KEY_TAG_SHIFT);
+
+		ase_pt_delete_tree(pt_root, 3);
 	}
 }
 
@@ -511,10 +659,17 @@ void ase_host_memory_terminate(void)
 	}
 	mem_alloc_destroy(&iova_mem_alloc);
 
-	ase_pt_delete_tree(ase_pa_pt_root, 3);
-	ase_pa_pt_root = NULL;
+	uint64_t *pt_root = ase_pa_pt_root;
+	if (pt_root)
+	{
+		uint64_t key = ase_pt_key(pt_root, 0);
+		__atomic_store_n(&ase_pa_pt_root, NULL, __ATOMIC_SEQ_CST);
+		ase_pt_wait_readers(key, UINT64_C(1) << ASE_PT_KEY_TAG_SHIFT);
+
+		ase_pt_delete_tree(pt_root, 3);
+	}
 
-	ase_host_memory_unlock();
+	ase_pt_unlock();
 }
 
 
@@ -542,6 +697,12 @@ void ase_host_memory_terminate(void)
  */
 #define ASE_PT_ADDR_MASK UINT64_C(0x7ffffffffffff000)
 
+/*
+ * Flag in a terminal entry, set when the VA range of a pinned page is
+ * unmapped without unpinning the page first.
+ */
+#define ASE_PT_FLAG_UNMAPPED UINT64_C(0x100)
+
 /*
  * Test whether page table entry is terminal -- a reference to a user
  * memory page instead of another level in the page table.
@@ -559,7 +720,7 @@ static inline uint8_t ase_pt_incr_refcnt(uint64_t *pt)
 {
 	if (*pt == 0) {
 		// Not set yet -- initialize with high bit set and a refcount of 1
-		*pt = ((uint64_t)1 << 63) | 1;
+		__atomic_store_n(pt, ((uint64_t)1 << 63) | 1, __ATOMIC_RELEASE);
 	} else {
 		// Increment the refcount (stored in the low 8 bits)
 		uint64_t v = *pt;
@@ -569,7 +730,7 @@ static inline uint8_t ase_pt_incr_refcnt(uint64_t *pt)
 
 		// Preserve all but the low 8 bits and add 1 to the low 8 bits
 		v = (v & ~(uint64_t)0xff) | ((uint8_t)v + 1);
-		*pt = v;
+		__atomic_store_n(pt, v, __ATOMIC_RELEASE);
 	}
 
 	uint8_t c = *pt;
@@ -592,7 +753,7 @@ static inline uint8_t ase_pt_decr_refcnt(uint64_t *pt)
 
 	// Preserve all but the low 8 bits and add 1 to the low 8 bits
 	v = (v & ~(uint64_t)0xff) | ((uint8_t)v - 1);
-	*pt = v;
+	__atomic_store_n(pt, v, __ATOMIC_SEQ_CST);
 
 	uint8_t c = *pt;
 	assert(c != 0xff);
@@ -609,11 +770,13 @@ static inline uint8_t ase_pt_get_refcnt(uint64_t pt)
 }
 
 /*
- * Set the address in a page table entry, preserving metadata.
+ * Set the address in a page table entry, preserving metadata other than
+ * the unmapped flag, which applies to the old address.
  */
 static inline void ase_pt_set_addr(uint64_t *pt, uint64_t addr)
 {
-	*pt = (addr & ASE_PT_ADDR_MASK) | (*pt & ~ASE_PT_ADDR_MASK);
+	__atomic_store_n(pt, (addr & ASE_PT_ADDR_MASK) | (*pt & ~(ASE_PT_ADDR_MASK | ASE_PT_FLAG_UNMAPPED)),
+			 __ATOMIC_RELEASE);
 }
 
 static inline uint64_t ase_pt_get_addr(uint64_t pt_entry)
@@ -727,11 +890,107 @@ static void ase_pt_delete_tree(uint64_t *pt, int pt_level)
 }
 
 
+/*
+ * Reader reference key for an address in the table at pt_root. The table
+ * is identified by a tag in the high bits.
+ */
+static uint64_t ase_pt_key(uint64_t *pt_root, uint64_t addr)
+{
+	uint64_t tag = ASE_PT_TAG_PA;
+
+	if (pt_root != ase_pa_pt_root) {
+		for (int i = 0; i < ASE_MAX_TOKENS; i += 1) {
+			if (pt_root == ase_iova_pt_root[i]) {
+				tag = ASE_PT_TAG_IOVA(i);
+				break;
+			}
+		}
+	}
+
+	return (tag << ASE_PT_KEY_TAG_SHIFT) | addr;
+}
+
+/*
+ * Invalidate IOTLB entries for the table holding key. Called after
+ * the table is updated.
+ */
+static void ase_pt_tlb_shootdown(uint64_t key)
+{
+	__atomic_add_fetch(&ase_pt_gen[key >> ASE_PT_KEY_TAG_SHIFT], 1, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Wait for readers holding references in [key, key + length). Called
+ * after the table is updated. Cached translations of the table are
+ * invalidated first.
+ */
+static void ase_pt_wait_readers(uint64_t key, uint64_t length)
+{
+	uint64_t r_key;
+	int spins;
+
+	ase_pt_tlb_shootdown(key);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	for (int i = 0; i < ASE_PT_MAX_READERS; i += 1) {
+		spins = 0;
+		while (1) {
+			r_key = __atomic_load_n(&ase_pt_readers[i].key, __ATOMIC_ACQUIRE);
+			if ((r_key < key) || (r_key - key >= length))
+				break;
+
+			if (spins++ < ASE_SPIN_LIMIT)
+				ase_cpu_relax();
+			else
+				sched_yield();
+		}
+	}
+}
+
+/*
+ * Set or clear ASE_PT_FLAG_UNMAPPED in pinned pages with VAs overlapping
+ * [va, va_end). Returns true if any entry changed. Called with the lock
+ * held.
+ */
+static bool ase_pt_mark_va_range(uint64_t *pt, int pt_level, uint64_t va, uint64_t va_end, bool unmapped)
+{
+	bool changed = false;
+	uint64_t page_len = UINT64_C(1) << ase_pt_level_to_bit_idx(pt_level);
+
+	for (int idx = 0; idx < 512; idx++) {
+		uint64_t pte = pt[idx];
+		if (pte == 0)
+			continue;
+
+		if ((pt_level > 0) && !ase_pt_entry_is_terminal((uint64_t *)pte)) {
+			changed |= ase_pt_mark_va_range((uint64_t *)pte, pt_level - 1, va, va_end, unmapped);
+			continue;
+		}
+
+		// Terminal entry, either a huge page or a 4KB page in a leaf
+		if (!ase_pt_get_refcnt(pte))
+			continue;
+
+		uint64_t page_va = ase_pt_get_addr(pte);
+		if ((page_va >= va_end) || (page_va + page_len <= va))
+			continue;
+
+		uint64_t new_pte = unmapped ? (pte | ASE_PT_FLAG_UNMAPPED) : (pte & ~ASE_PT_FLAG_UNMAPPED);
+		if (new_pte != pte) {
+			__atomic_store_n(&pt[idx], new_pte, __ATOMIC_RELEASE);
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
 /*
  * Return mapped address stored in the table or NULL if not found.
- * The level at which it is found is stored *pt_level.
+ * The level at which it is found is stored *pt_level. When "unmapped"
+ * is not NULL, it is set if the page was unmapped while pinned.
  */
-static uint64_t ase_pt_lookup_addr(uint64_t pa, uint64_t *pt_root, int *pt_level)
+static uint64_t ase_pt_lookup_addr(uint64_t pa, uint64_t *pt_root, int *pt_level, bool *unmapped)
 {
 	*pt_level = -1;
 
@@ -748,9 +1007,11 @@ static uint64_t ase_pt_lookup_addr(uint64_t pa, uint64_t *pt_root, int *pt_level
 		// here are simple virtual pointers. We can do this since the table
 		// isn't actually translating -- it is simply indicating whether a
 		// physical address is pinned.
-		pt = (uint64_t *) pt[ase_pt_idx(pa, level)];
+		pt = (uint64_t *) __atomic_load_n(&pt[ase_pt_idx(pa, level)], __ATOMIC_ACQUIRE);
 		if (ase_pt_entry_is_terminal(pt)) {
 			*pt_level = level;
+			if (unmapped)
+				*unmapped = (uint64_t)pt & ASE_PT_FLAG_UNMAPPED;
 			return ase_pt_get_addr((uint64_t)pt);
 		}
 
@@ -761,9 +1022,12 @@ static uint64_t ase_pt_lookup_addr(uint64_t pa, uint64_t *pt_root, int *pt_level
 	// of pointers. We do this to save space since the table only has to
 	// indicate whether a page is valid.
 	int idx = ase_pt_idx(pa, 0);
-	if (pt && ase_pt_get_refcnt(pt[idx])) {
+	uint64_t pte = pt ? __atomic_load_n(&pt[idx], __ATOMIC_ACQUIRE) : 0;
+	if (ase_pt_get_refcnt(pte)) {
 		*pt_level = 0;
-		return ase_pt_get_addr(pt[idx]);
+		if (unmapped)
+			*unmapped = pte & ASE_PT_FLAG_UNMAPPED;
+		return ase_pt_get_addr(pte);
 	}
 
 	// Not found
@@ -793,15 +1057,16 @@ static int ase_pt_pin_page(uint64_t va, uint64_t iova, uint64_t *pt_root, int pt
 	while (level != pt_level) {
 		idx = ase_pt_idx(iova, level);
 		if (pt[idx] == 0) {
-			pt[idx] = (uint64_t)mmap(NULL, 4096, PROT_READ | PROT_WRITE,
-						 MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
-			if (pt[idx] == (uint64_t)MAP_FAILED) {
+			void *pt_new = mmap(NULL, 4096, PROT_READ | PROT_WRITE,
+					    MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
+			if (pt_new == MAP_FAILED) {
 				ASE_ERR("Simulated page table out of memory!\n");
-				pt[idx] = 0;
 				return -1;
 			}
 
-			ase_memset((void *)pt[idx], 0, (level > 1) ? 4096 : 512);
+			ase_memset(pt_new, 0, (level > 1) ? 4096 : 512);
+			// Readers may walk the new node as soon as it is stored
+			__atomic_store_n(&pt[idx], (uint64_t)pt_new, __ATOMIC_RELEASE);
 		}
 
 		if (ase_pt_entry_is_terminal((uint64_t *)pt[idx])) {
@@ -819,13 +1084,30 @@ static int ase_pt_pin_page(uint64_t va, uint64_t iova, uint64_t *pt_root, int pt
 			// Smaller pages in the same address range are already pinned.
 			// What should we do? mmap() allows overwriting existing
 			// mappings, so we behave like it for now.
-			ase_pt_delete_tree((uint64_t *)pt[idx], level - 1);
-			pt[idx] = 0;
+			uint64_t *pt_old = (uint64_t *)pt[idx];
+			__atomic_store_n(&pt[idx], 0, __ATOMIC_SEQ_CST);
+			ase_pt_wait_readers(ase_pt_key(pt_root, iova & ~(length - 1)), length);
+			ase_pt_delete_tree(pt_old, level - 1);
 		}
 	}
 
+	// Pinning an existing page at a new VA changes the translation
+	uint64_t pte_old = pt[idx];
+	bool remap = ase_pt_get_refcnt(pte_old) && (ase_pt_get_addr(pte_old) != (va & ASE_PT_ADDR_MASK));
+
+	// The caller confirmed that va is mapped. A stale unmapped flag is
+	// dropped along with the old address.
+	bool was_unmapped = pte_old & ASE_PT_FLAG_UNMAPPED;
+
 	ase_pt_incr_refcnt(&pt[idx]);
 	ase_pt_set_addr(&pt[idx], va);
+	if (remap || was_unmapped)
+		ase_pt_tlb_shootdown(ase_pt_key(pt_root, iova));
+
+	if (va < ase_pt_va_min)
+		__atomic_store_n(&ase_pt_va_min, va, __ATOMIC_RELAXED);
+	if (va + length > ase_pt_va_max)
+		__atomic_store_n(&ase_pt_va_max, va + length, __ATOMIC_RELAXED);
 
 	if (ase_pt_enable_debug) {
 		printf("\nASE simulated page table (pinned VA 0x%" PRIx64 ", %s 0x%" PRIx64 "):\n",
@@ -874,7 +1156,8 @@ static int ase_pt_unpin_page(uint64_t iova, uint64_t *pt_root, int pt_level)
 		}
 		if (ase_pt_decr_refcnt(&pt[idx]) == 0) {
 			// Reference count is 0. Clear the page.
-			pt[idx] = 0;
+			__atomic_store_n(&pt[idx], 0, __ATOMIC_SEQ_CST);
+			ase_pt_wait_readers(ase_pt_key(pt_root, iova & ~(length - 1)), length);
 		}
 	} else if (pt) {
 		// Drop a 4KB page
@@ -882,7 +1165,10 @@ static int ase_pt_unpin_page(uint64_t iova, uint64_t *pt_root, int pt_level)
 			// Attempt to unpin non-existent page
 			return -1;
 		}
-		ase_pt_decr_refcnt(&pt[idx]);
+		if (ase_pt_decr_refcnt(&pt[idx]) == 0) {
+			// Readers still copying finish before the page is released
+			ase_pt_wait_readers(ase_pt_key(pt_root, iova & ~(length - 1)), length);
+		}
 	}
 
 	if (ase_pt_enable_debug) {
@@ -41,6 +41,10 @@
 // in Linux to reclassify an existing memory page as shared.  Handling all
 // accesses on the application side makes shared mapping unnecessary.
 //
+// The exception is the optional zero-copy mode (ase_zcopy.h), in which
+// buffers allocated by fpgaPrepareBuffer() are shared with the simulator
+// from the start.
+//
 
 //
 // Requests types that may be sent from simulator to application.
@@ -79,6 +83,15 @@ typedef uint64_t ase_host_memory_status;
 #define HOST_MEM_ATOMIC_OP_SWAP 2
 #define HOST_MEM_ATOMIC_OP_CAS 3
 
+// Write request flags
+//   NAK_ONLY: respond only if the write fails. Successful writes are
+//             acknowledged by a watermark response (see below).
+#define HOST_MEM_WR_FLAG_NAK_ONLY 1
+
+// In NAK_ONLY mode, the application sends a watermark after this many
+// successful writes and whenever the write request queue is empty.
+#define HOST_MEM_WR_ACK_INTERVAL 32
+
 //
 // Read request, simulator to application. Also used for atomic updates.
 //
@@ -140,12 +153,15 @@ typedef struct {
 	uint8_t byte_en;
 	uint8_t first_be;        // 4 bit byte mask in first DWORD
 	uint8_t last_be;         // 4 bit byte mask in last DWORD
-	uint8_t rsvd;
+	uint8_t flags;           // HOST_MEM_WR_FLAG_*
 
 	uint32_t data_bytes;     // Size of the data payload the follows in the message stream
 
 	int32_t afu_idx;         // Emulated AFU index. The FPGA-side emulation
 	                         // will turn this into a PF/VF number.
+
+	uint32_t seq;            // Sequence number, returned in responses
+	uint32_t dummy_pad;      // 64 bit alignment
 } ase_host_memory_write_req;
 
 //
@@ -163,6 +179,13 @@ typedef struct {
 
 	// Was the request to a valid address?
 	ase_host_memory_status status;
+
+	// Writes are handled in order. A response acknowledges the request
+	// with this sequence number and all requests before it. In NAK_ONLY
+	// mode, a response with status HOST_MEM_STATUS_VALID is a watermark
+	// and pa/va are not meaningful.
+	uint32_t seq;
+	uint32_t dummy_pad; // 64 bit alignment
 } ase_host_memory_write_rsp;
 
 
@@ -179,15 +202,29 @@ int ase_host_memory_free_iova(int32_t afu_idx, uint64_t iova);
 // Unpin the page at IOVA.
 int ase_host_memory_unpin(int32_t afu_idx, uint64_t iova, uint64_t length);
 
-// Translate from simulated IOVA address space.  By setting "lock"
-// in the request, the internal page table lock is not released on
+// Translate from simulated IOVA address space. Lookups don't block
+// and may run in parallel on any number of threads. By setting "lock"
+// in the request, the calling thread keeps a reference to the page on
 // return. This allows a caller to be sure that a page will remain
-// in the table long enough to access the data to which pa points.
-// Callers using "lock" must call ase_host_memory_unlock() to
-// release the page table lock and avoid deadlocks.
+// in the table long enough to access the data to which pa points:
+// unpinning the page waits for the reference. Callers using "lock"
+// must call ase_host_memory_unlock() to drop the reference.
 uint64_t ase_host_memory_iova_to_va(int32_t afu_idx, uint64_t iova, bool lock);
 void ase_host_memory_unlock(void);
 
+// Was the page referenced by the calling thread's most recent translation
+// unmapped while still pinned? Only pages unmapped through the wrappers in
+// libase-preload are detected.
+bool ase_host_memory_ref_unmapped(void);
+
+// Called by libase-preload hooks when [va, va + length) is unmapped or
+// mapped again. Pinned pages in the range are flagged accordingly.
+void ase_host_memory_va_mapped(uint64_t va, uint64_t length, bool mapped);
+
+// Lookups are cached in a small per-thread IOTLB. Report the total
+// hits and misses in all threads.
+void ase_host_memory_tlb_stats(uint64_t *hits, uint64_t *misses);
+
 // Translate a VA to simulated physical address space and add
 // the address to the PA->VA tracking table. This is used by the
 // PCIe ATS emulation. It is not a translation to IOVA!
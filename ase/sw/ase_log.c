@@ -0,0 +1,557 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Asynchronous log writer. See ase_log.h.
+//
+// The ring is a byte array indexed by free-running 64 bit positions.
+// Producers reserve space by advancing log_head with a CAS and commit
+// a record by setting its state. The single consumer (the writer
+// thread, or the posting thread in the fallback cases) copies records
+// into per-file staging buffers in position order, zeroes the space it
+// consumed and advances log_tail. Zeroed space is what lets a consumer
+// tell a reserved but uncommitted record from a committed one.
+//
+
+#include "ase_common.h"
+#include "ase_log.h"
+
+#include <sys/uio.h>
+
+#define ASE_LOG_RING_SIZE        (4 << 20)
+#define ASE_LOG_RING_MASK        ((uint64_t)ASE_LOG_RING_SIZE - 1)
+// Largest single record. Bigger writes are split.
+#define ASE_LOG_MAX_REC          (ASE_LOG_RING_SIZE / 4)
+#define ASE_LOG_STAGE_SIZE       (64 << 10)
+
+#define LOG_REC_FREE             0
+#define LOG_REC_DATA             1
+#define LOG_REC_PAD              2
+
+#define LOG_REC_SPAN(len)        (((len) + sizeof(log_rec_hdr) + 7) & ~7)
+
+typedef struct {
+	uint32_t len;		// Payload length. Records start 8B aligned.
+	uint16_t id;
+	uint16_t state;
+} log_rec_hdr;
+
+struct log_file {
+	bool in_use;
+	int fd;
+	char path[ASE_FILEPATH_LEN];
+
+	// Consumer side staging buffer
+	char *stage;
+	uint32_t staged;
+
+	// ASE_LOG_FLUSH=sync: records are built in scratch under sync_lock
+	pthread_mutex_t sync_lock;
+	char *scratch;
+	uint32_t scratch_size;
+};
+
+static struct log_file log_files[ASE_LOG_MAX_FILES];
+static pthread_mutex_t log_files_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static char *log_ring;
+static uint64_t log_head __attribute__((aligned(64)));
+static uint64_t log_tail __attribute__((aligned(64)));
+
+// Writer thread state. log_kick wakes the writer early, log_drained
+// counts completed consumer passes and log_space wakes producers
+// waiting for a full ring.
+static uint32_t log_kick __attribute__((aligned(64)));
+static uint32_t log_kick_pending;
+static uint32_t log_drained;
+static uint32_t log_space;
+static uint32_t log_space_waiters;
+
+static pthread_mutex_t log_consumer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t log_writer_tid;
+static volatile bool log_writer_running;
+static bool log_writer_stop;
+
+static pthread_once_t log_init_once = PTHREAD_ONCE_INIT;
+
+
+//
+// Flush interval in ms, or -1 for ASE_LOG_FLUSH=sync
+//
+static int log_flush_ms(void)
+{
+	static int flush_ms = -2;
+
+	if (flush_ms == -2) {
+		char *str_env = getenv(ASE_LOG_FLUSH_ENV);
+
+		flush_ms = ASE_LOG_FLUSH_MS;
+		if (str_env) {
+			if (strcmp(str_env, "sync") == 0)
+				flush_ms = -1;
+			else if (atoi(str_env) > 0)
+				flush_ms = atoi(str_env);
+		}
+	}
+
+	return flush_ms;
+}
+
+
+static void log_write_fd(struct log_file *f, const char *buf, size_t len)
+{
+	ssize_t n;
+
+	while (len) {
+		n = write(f->fd, buf, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			ASE_ERR("Log write to %s failed: %s\n", f->path, strerror(errno));
+			return;
+		}
+		buf += n;
+		len -= n;
+	}
+}
+
+
+static void log_flush_stage(struct log_file *f)
+{
+	if (f->staged) {
+		log_write_fd(f, f->stage, f->staged);
+		f->staged = 0;
+	}
+}
+
+
+//
+// Consume every committed record, stopping at the first uncommitted one.
+// Caller holds log_consumer_lock.
+//
+static void log_consume(void)
+{
+	uint64_t tail = log_tail;
+	uint64_t head = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+	log_rec_hdr *rh;
+	struct log_file *f;
+	uint32_t len, n;
+	uint16_t state;
+	int i;
+
+	while (tail < head) {
+		rh = (log_rec_hdr *) (log_ring + (tail & ASE_LOG_RING_MASK));
+		state = __atomic_load_n(&rh->state, __ATOMIC_ACQUIRE);
+		if (state == LOG_REC_FREE)
+			break;
+
+		n = rh->len;
+		len = LOG_REC_SPAN(n);
+		if (state == LOG_REC_DATA) {
+			f = &log_files[rh->id];
+			if (f->staged + n > ASE_LOG_STAGE_SIZE)
+				log_flush_stage(f);
+			if (n > ASE_LOG_STAGE_SIZE) {
+				log_write_fd(f, (char *) (rh + 1), n);
+			} else {
+				memcpy(f->stage + f->staged, rh + 1, n);
+				f->staged += n;
+			}
+		}
+
+		memset(rh, 0, len);
+		tail += len;
+		__atomic_store_n(&log_tail, tail, __ATOMIC_RELEASE);
+	}
+
+	for (i = 0; i < ASE_LOG_MAX_FILES; i += 1)
+		if (log_files[i].in_use)
+			log_flush_stage(&log_files[i]);
+
+	__atomic_add_fetch(&log_drained, 1, __ATOMIC_RELEASE);
+	if (__atomic_load_n(&log_space_waiters, __ATOMIC_ACQUIRE)) {
+		__atomic_add_fetch(&log_space, 1, __ATOMIC_RELEASE);
+		ase_futex_wake(&log_space);
+	}
+	ase_futex_wake(&log_drained);
+}
+
+
+static void log_kick_writer(void)
+{
+	if (!__atomic_exchange_n(&log_kick_pending, 1, __ATOMIC_ACQ_REL)) {
+		__atomic_add_fetch(&log_kick, 1, __ATOMIC_RELEASE);
+		ase_futex_wake(&log_kick);
+	}
+}
+
+
+static void *log_writer(void *arg)
+{
+	long flush_ns = (long) log_flush_ms() * 1000000L;
+	uint32_t kick;
+
+	UNUSED_PARAM(arg);
+
+	while (1) {
+		kick = __atomic_load_n(&log_kick, __ATOMIC_ACQUIRE);
+		__atomic_store_n(&log_kick_pending, 0, __ATOMIC_RELEASE);
+
+		pthread_mutex_lock(&log_consumer_lock);
+		log_consume();
+		pthread_mutex_unlock(&log_consumer_lock);
+
+		if (__atomic_load_n(&log_writer_stop, __ATOMIC_ACQUIRE))
+			break;
+		ase_futex_wait(&log_kick, kick, flush_ns);
+	}
+
+	return NULL;
+}
+
+
+//
+// Wait until everything posted before the call is written
+//
+static void log_sync(void)
+{
+	uint64_t target = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+	uint32_t drained;
+
+	while (__atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) < target) {
+		if (!log_writer_running) {
+			pthread_mutex_lock(&log_consumer_lock);
+			log_consume();
+			pthread_mutex_unlock(&log_consumer_lock);
+			// Only an uncommitted record stops the consumer
+			if (__atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) < target)
+				sched_yield();
+			continue;
+		}
+
+		drained = __atomic_load_n(&log_drained, __ATOMIC_ACQUIRE);
+		log_kick_writer();
+		if (__atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) < target)
+			ase_futex_wait(&log_drained, drained, 1000000L);
+	}
+}
+
+
+//
+// Stop the writer at exit and write out the rest of the ring. Records
+// posted later (stdio flushing open log streams during exit) are written
+// by the posting thread.
+//
+static void log_shutdown(void)
+{
+	if (!log_writer_running)
+		return;
+
+	__atomic_store_n(&log_writer_stop, true, __ATOMIC_RELEASE);
+	log_kick_writer();
+	pthread_join(log_writer_tid, NULL);
+	log_writer_running = false;
+
+	pthread_mutex_lock(&log_consumer_lock);
+	log_consume();
+	pthread_mutex_unlock(&log_consumer_lock);
+}
+
+
+static void log_init(void)
+{
+	if (log_flush_ms() < 0)
+		return;
+
+	if (posix_memalign((void **) &log_ring, 64, ASE_LOG_RING_SIZE) != 0) {
+		ASE_ERR("Failed to allocate the log ring, writing logs synchronously\n");
+		return;
+	}
+	memset(log_ring, 0, ASE_LOG_RING_SIZE);
+
+	if (pthread_create(&log_writer_tid, NULL, &log_writer, NULL) != 0) {
+		ASE_ERR("Failed to start the log writer, writing logs synchronously\n");
+		free(log_ring);
+		log_ring = NULL;
+		return;
+	}
+
+	log_writer_running = true;
+	atexit(log_shutdown);
+}
+
+
+int ase_log_open(const char *path)
+{
+	struct log_file *f = NULL;
+	int id;
+
+	pthread_once(&log_init_once, log_init);
+
+	pthread_mutex_lock(&log_files_lock);
+	for (id = 0; id < ASE_LOG_MAX_FILES; id += 1) {
+		if (!log_files[id].in_use) {
+			f = &log_files[id];
+			break;
+		}
+	}
+	if (!f) {
+		pthread_mutex_unlock(&log_files_lock);
+		ASE_ERR("Too many open logs, can't open %s\n", path);
+		return -1;
+	}
+
+	f->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (f->fd < 0) {
+		pthread_mutex_unlock(&log_files_lock);
+		ASE_ERR("Failed to open log file %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	// The consumer walks the table
+	pthread_mutex_lock(&log_consumer_lock);
+	ase_string_copy(f->path, path, ASE_FILEPATH_LEN);
+	if (log_ring)
+		f->stage = (char *) ase_malloc(ASE_LOG_STAGE_SIZE);
+	f->staged = 0;
+	pthread_mutex_init(&f->sync_lock, NULL);
+	f->scratch = NULL;
+	f->scratch_size = 0;
+	f->in_use = true;
+	pthread_mutex_unlock(&log_consumer_lock);
+	pthread_mutex_unlock(&log_files_lock);
+
+	return id;
+}
+
+
+void *ase_log_reserve(int id, uint32_t len)
+{
+	struct log_file *f = &log_files[id];
+	uint64_t head, tail, off, pad, need, span;
+	log_rec_hdr *rh;
+	uint32_t space;
+	int spins = 0;
+
+	span = LOG_REC_SPAN(len);
+	if (span > ASE_LOG_MAX_REC)
+		return NULL;
+
+	if (!log_ring) {
+		pthread_mutex_lock(&f->sync_lock);
+		if (f->scratch_size < span) {
+			free(f->scratch);
+			f->scratch = (char *) ase_malloc(span);
+			f->scratch_size = span;
+		}
+		memset(f->scratch, 0, span);
+		rh = (log_rec_hdr *) f->scratch;
+		rh->len = len;
+		return rh + 1;
+	}
+
+	head = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+	while (1) {
+		// A record doesn't wrap. Pad to the end of the ring instead.
+		off = head & ASE_LOG_RING_MASK;
+		pad = (off + span > ASE_LOG_RING_SIZE) ? ASE_LOG_RING_SIZE - off : 0;
+		need = pad + span;
+
+		tail = __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE);
+		if (head + need - tail > ASE_LOG_RING_SIZE) {
+			// Full
+			if (!log_writer_running) {
+				pthread_mutex_lock(&log_consumer_lock);
+				log_consume();
+				pthread_mutex_unlock(&log_consumer_lock);
+			} else if (spins < ASE_SPIN_LIMIT) {
+				if (spins++ == 0)
+					log_kick_writer();
+				ase_cpu_relax();
+			} else {
+				space = __atomic_load_n(&log_space, __ATOMIC_ACQUIRE);
+				__atomic_add_fetch(&log_space_waiters, 1, __ATOMIC_ACQ_REL);
+				log_kick_writer();
+				ase_futex_wait(&log_space, space, 1000000L);
+				__atomic_sub_fetch(&log_space_waiters, 1, __ATOMIC_ACQ_REL);
+			}
+			head = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		if (__atomic_compare_exchange_n(&log_head, &head, head + need, true,
+						__ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+			break;
+	}
+
+	if (pad) {
+		rh = (log_rec_hdr *) (log_ring + off);
+		rh->len = pad - sizeof(log_rec_hdr);
+		__atomic_store_n(&rh->state, LOG_REC_PAD, __ATOMIC_RELEASE);
+		off = 0;
+	}
+
+	rh = (log_rec_hdr *) (log_ring + off);
+	rh->len = len;
+	rh->id = id;
+
+	// Kick the writer early once the ring is half full
+	if (head + need - tail > ASE_LOG_RING_SIZE / 2)
+		log_kick_writer();
+
+	return rh + 1;
+}
+
+
+void ase_log_commit(int id, void *rec)
+{
+	struct log_file *f = &log_files[id];
+	log_rec_hdr *rh = (log_rec_hdr *) rec - 1;
+
+	if (!log_ring) {
+		log_write_fd(f, (char *) rec, rh->len);
+		pthread_mutex_unlock(&f->sync_lock);
+		return;
+	}
+
+	__atomic_store_n(&rh->state, LOG_REC_DATA, __ATOMIC_RELEASE);
+
+	if (!log_writer_running) {
+		pthread_mutex_lock(&log_consumer_lock);
+		log_consume();
+		pthread_mutex_unlock(&log_consumer_lock);
+	}
+}
+
+
+void ase_log_write(int id, const void *buf, size_t len)
+{
+	const char *p = (const char *) buf;
+	uint32_t n;
+	void *rec;
+
+	while (len) {
+		n = (len > ASE_LOG_MAX_REC / 2) ? ASE_LOG_MAX_REC / 2 : len;
+		rec = ase_log_reserve(id, n);
+		if (!rec)
+			return;
+		memcpy(rec, p, n);
+		ase_log_commit(id, rec);
+		p += n;
+		len -= n;
+	}
+}
+
+
+void ase_log_close(int id)
+{
+	struct log_file *f = &log_files[id];
+
+	if (log_ring)
+		log_sync();
+
+	pthread_mutex_lock(&log_files_lock);
+	pthread_mutex_lock(&log_consumer_lock);
+	log_flush_stage(f);
+	close(f->fd);
+	free(f->stage);
+	f->stage = NULL;
+	free(f->scratch);
+	f->scratch = NULL;
+	pthread_mutex_destroy(&f->sync_lock);
+	f->in_use = false;
+	pthread_mutex_unlock(&log_consumer_lock);
+	pthread_mutex_unlock(&log_files_lock);
+}
+
+
+//
+// stdio stream on top of a log. Payloads of the records a stream posts
+// are plain bytes.
+//
+static ssize_t log_cookie_write(void *cookie, const char *buf, size_t len)
+{
+	ase_log_write((int)(intptr_t) cookie, buf, len);
+	return len;
+}
+
+
+static int log_cookie_close(void *cookie)
+{
+	ase_log_close((int)(intptr_t) cookie);
+	return 0;
+}
+
+
+FILE *ase_log_fopen(const char *path)
+{
+	cookie_io_functions_t io = {
+		.read = NULL,
+		.write = log_cookie_write,
+		.seek = NULL,
+		.close = log_cookie_close
+	};
+	FILE *fp;
+	int id;
+
+	// Synchronous mode is a plain file, as before
+	if (log_flush_ms() < 0)
+		return fopen(path, "w");
+
+	id = ase_log_open(path);
+	if (id < 0)
+		return NULL;
+
+	fp = fopencookie((void *)(intptr_t) id, "w", io);
+	if (!fp) {
+		ase_log_close(id);
+		return NULL;
+	}
+
+	setvbuf(fp, NULL, _IOFBF, ASE_LOG_STAGE_SIZE);
+	return fp;
+}
+
+
+void ase_log_drain(void)
+{
+	int tries;
+
+	if (!log_ring)
+		return;
+
+	// The writer may be mid pass or may have crashed holding the lock.
+	// Give it a moment, then give up rather than hang in a crash handler.
+	for (tries = 0; tries < 100; tries += 1) {
+		if (pthread_mutex_trylock(&log_consumer_lock) == 0) {
+			log_consume();
+			pthread_mutex_unlock(&log_consumer_lock);
+			return;
+		}
+		usleep(1000);
+	}
+}
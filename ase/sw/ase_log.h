@@ -0,0 +1,81 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Asynchronous log writer shared by the simulator's loggers.
+//
+// Loggers append records to one lock-free, multi-producer byte ring. A
+// background thread moves committed records into per-file staging
+// buffers and writes them out in batches, so the simulator thread never
+// waits on file I/O unless the ring is full.
+//
+// Text logs use ase_log_fopen(), a stdio stream whose flushes post
+// records to the ring: existing fprintf()/fflush() logging code is
+// unchanged. Binary logs reserve records in place and commit them.
+//
+// Flush policy, env(ASE_LOG_FLUSH):
+//   <ms>    Write out posted records at least every <ms> milliseconds,
+//           sooner when the ring is half full. Default 10.
+//   sync    No writer thread. Records are written by the posting thread,
+//           as ASE did before (useful when debugging hangs).
+// Everything posted is written at exit and on a crash (ase_log_drain()).
+//
+
+#ifndef _ASE_LOG_H_
+#define _ASE_LOG_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define ASE_LOG_FLUSH_ENV        "ASE_LOG_FLUSH"
+#define ASE_LOG_FLUSH_MS         10
+#define ASE_LOG_MAX_FILES        16
+
+// Open (truncate) a log file. Returns a log id or -1 on error.
+int ase_log_open(const char *path);
+
+// Reserve "len" bytes for a record of log "id". The record is written
+// in order with the log's other records once ase_log_commit() is
+// called, and must be committed promptly: records behind it wait.
+void *ase_log_reserve(int id, uint32_t len);
+void ase_log_commit(int id, void *rec);
+
+// Post a copy of buf
+void ase_log_write(int id, const void *buf, size_t len);
+
+// Write out everything posted so far and close the log
+void ase_log_close(int id);
+
+// Open a text log as a stdio stream on top of ase_log_open(). Each
+// flush of the stream posts a record. Returns NULL on error.
+FILE *ase_log_fopen(const char *path);
+
+// Write out everything posted so far. Called on fatal signals, so it
+// avoids waiting on the writer thread for long.
+void ase_log_drain(void);
+
+#endif // _ASE_LOG_H_
@@ -0,0 +1,449 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "ase_common.h"
+#include "ase_mq_mux.h"
+
+#define ASE_MQ_MUX_MASK          (ASE_MQ_MUX_SLOTS - 1)
+
+// epoll data of the stop eventfd and flag marking handler indices.
+// Other values are channel indices.
+#define ASE_MQ_MUX_EV_STOP       0xffffffff
+#define ASE_MQ_MUX_EV_HANDLER    0x10000
+
+struct ase_mq_mux_slot_t {
+	int len;
+	char data[ASE_MQ_MSGSIZE];
+};
+
+//
+// Single-producer (IO thread), single-consumer (DPI thread) queue of
+// messages from one FIFO. head and tail are free-running counters.
+//
+struct ase_mq_mux_chan_t {
+	int mq;
+	int dummy_wr_fd;
+	uint32_t tail __attribute__((aligned(64)));
+	uint32_t paused;                // FIFO out of the epoll set while full
+	uint32_t head __attribute__((aligned(64)));
+	struct ase_mq_mux_slot_t slot[ASE_MQ_MUX_SLOTS];
+};
+
+struct ase_mq_mux_handler_ent_t {
+	int fd;
+	ase_mq_mux_handler_t handler;   // NULL when the entry is free
+	void *arg;
+};
+
+static struct ase_mq_mux_chan_t *mq_mux_chan;
+static int mq_mux_num_chan;
+static int mq_mux_epfd = -1;
+static int mq_mux_stop_fd = -1;
+static pthread_t mq_mux_tid;
+static bool mq_mux_running;
+static bool mq_mux_stopping;
+static uint32_t mq_mux_doorbell;
+
+// Held by the IO thread while a handler runs
+static pthread_mutex_t mq_mux_handler_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct ase_mq_mux_handler_ent_t mq_mux_handler[ASE_MQ_MUX_MAX_HANDLERS];
+
+
+static struct ase_mq_mux_chan_t *mq_mux_chan_get(int mq)
+{
+	int i;
+
+	for (i = 0; i < mq_mux_num_chan; i++) {
+		if (mq_mux_chan[i].mq == mq)
+			return &mq_mux_chan[i];
+	}
+
+	return NULL;
+}
+
+
+/*
+ * Watch the FIFO of a channel, or stop watching it with events set to 0
+ */
+static void mq_mux_arm(struct ase_mq_mux_chan_t *ch, uint32_t events)
+{
+	struct epoll_event ev;
+
+	ev.events = events;
+	ev.data.u32 = ch - mq_mux_chan;
+	if (epoll_ctl(mq_mux_epfd, EPOLL_CTL_MOD, ch->mq, &ev) == -1)
+		ase_error_report("epoll_ctl", errno, ASE_OS_MQUEUE_ERR);
+}
+
+
+/*
+ * The queue of a channel is full. Take its FIFO out of the epoll set
+ * until ase_mq_mux_recv() frees a slot. Returns true if the channel was
+ * paused and false if a slot was freed meanwhile.
+ */
+static bool mq_mux_pause(struct ase_mq_mux_chan_t *ch)
+{
+	uint32_t paused = 1;
+
+	// Disarm before publishing paused, so that a re-arm by the consumer
+	// can't be undone here.
+	mq_mux_arm(ch, 0);
+	__atomic_store_n(&ch->paused, 1, __ATOMIC_SEQ_CST);
+
+	if ((ch->tail - __atomic_load_n(&ch->head, __ATOMIC_SEQ_CST)) != ASE_MQ_MUX_SLOTS) {
+		// Space appeared. Whichever side clears paused re-arms.
+		if (__atomic_compare_exchange_n(&ch->paused, &paused, 0, false,
+						__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+			mq_mux_arm(ch, EPOLLIN);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/*
+ * Move every complete message waiting in a FIFO into its queue
+ */
+static void mq_mux_drain(struct ase_mq_mux_chan_t *ch)
+{
+	struct ase_mq_mux_slot_t *slot;
+
+	while (true) {
+		if ((ch->tail - __atomic_load_n(&ch->head, __ATOMIC_ACQUIRE)) == ASE_MQ_MUX_SLOTS) {
+			if (mq_mux_pause(ch))
+				break;
+			continue;
+		}
+
+		slot = &ch->slot[ch->tail & ASE_MQ_MUX_MASK];
+		if (mqueue_recv_fifo(ch->mq, slot->data, ASE_MQ_MSGSIZE,
+				     &slot->len) != ASE_MSG_PRESENT)
+			break;
+
+		__atomic_store_n(&ch->tail, ch->tail + 1, __ATOMIC_SEQ_CST);
+		__atomic_fetch_add(&mq_mux_doorbell, 1, __ATOMIC_SEQ_CST);
+	}
+}
+
+
+/*
+ * Run the handler of a descriptor. The entry may have been freed since
+ * epoll_wait() returned.
+ */
+static void mq_mux_run_handler(uint32_t h)
+{
+	struct ase_mq_mux_handler_ent_t *ent = &mq_mux_handler[h];
+
+	pthread_mutex_lock(&mq_mux_handler_lock);
+	if (ent->handler)
+		ent->handler(ent->fd, ent->arg);
+	pthread_mutex_unlock(&mq_mux_handler_lock);
+}
+
+
+static void *mq_mux_thread(void *arg)
+{
+	UNUSED_PARAM(arg);
+
+	struct epoll_event events[ASE_MQ_MUX_MAX_CHANNELS + ASE_MQ_MUX_MAX_HANDLERS + 1];
+	uint32_t id;
+	int n;
+	int i;
+
+	// Block until there is work. Stopping is signaled by mq_mux_stop_fd.
+	while (!__atomic_load_n(&mq_mux_stopping, __ATOMIC_ACQUIRE)) {
+		n = epoll_wait(mq_mux_epfd, events,
+			       sizeof(events) / sizeof(events[0]), -1);
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			ase_error_report("epoll_wait", errno, ASE_OS_MQTXRX_ERR);
+			break;
+		}
+
+		for (i = 0; i < n; i++) {
+			if (__atomic_load_n(&mq_mux_stopping, __ATOMIC_ACQUIRE))
+				break;
+
+			id = events[i].data.u32;
+			if (id == ASE_MQ_MUX_EV_STOP)
+				continue;
+			else if (id & ASE_MQ_MUX_EV_HANDLER)
+				mq_mux_run_handler(id & ~ASE_MQ_MUX_EV_HANDLER);
+			else
+				mq_mux_drain(&mq_mux_chan[id]);
+		}
+	}
+
+	return NULL;
+}
+
+
+int ase_mq_mux_add(const char *mq_name, int mq)
+{
+	FUNC_CALL_ENTRY;
+
+	struct ase_mq_mux_chan_t *ch;
+	char mq_path[ASE_FILEPATH_LEN];
+
+	if (mq_mux_running || (mq_mux_num_chan == ASE_MQ_MUX_MAX_CHANNELS))
+		return -1;
+
+	if (mq_mux_chan == NULL) {
+		mq_mux_chan = ase_malloc(ASE_MQ_MUX_MAX_CHANNELS *
+					 sizeof(struct ase_mq_mux_chan_t));
+	}
+
+	ch = &mq_mux_chan[mq_mux_num_chan];
+	ch->mq = mq;
+	ch->paused = 0;
+
+	// Hold a write end open so that the FIFO never reports a hang-up
+	// between applications, which would keep epoll_wait() spinning.
+	snprintf(mq_path, sizeof(mq_path), "%s/%s", ase_workdir_path, mq_name);
+	ch->dummy_wr_fd = open(mq_path, O_WRONLY | O_NONBLOCK);
+	if (ch->dummy_wr_fd == -1) {
+		ase_error_report("open", errno, ASE_OS_FOPEN_ERR);
+		return -1;
+	}
+
+	mq_mux_num_chan++;
+
+	FUNC_CALL_EXIT;
+	return 0;
+}
+
+
+int ase_mq_mux_start(void)
+{
+	FUNC_CALL_ENTRY;
+
+	struct epoll_event ev;
+	int i;
+
+	mq_mux_epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (mq_mux_epfd == -1) {
+		ase_error_report("epoll_create1", errno, ASE_OS_MQUEUE_ERR);
+		return -1;
+	}
+
+	mq_mux_stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (mq_mux_stop_fd == -1) {
+		ase_error_report("eventfd", errno, ASE_OS_MQUEUE_ERR);
+		goto err;
+	}
+
+	ev.events = EPOLLIN;
+	ev.data.u32 = ASE_MQ_MUX_EV_STOP;
+	if (epoll_ctl(mq_mux_epfd, EPOLL_CTL_ADD, mq_mux_stop_fd, &ev) == -1) {
+		ase_error_report("epoll_ctl", errno, ASE_OS_MQUEUE_ERR);
+		goto err;
+	}
+
+	for (i = 0; i < mq_mux_num_chan; i++) {
+		ev.events = EPOLLIN;
+		ev.data.u32 = i;
+		if (epoll_ctl(mq_mux_epfd, EPOLL_CTL_ADD, mq_mux_chan[i].mq, &ev) == -1) {
+			ase_error_report("epoll_ctl", errno, ASE_OS_MQUEUE_ERR);
+			goto err;
+		}
+	}
+
+	mq_mux_stopping = false;
+	if (pthread_create(&mq_mux_tid, NULL, &mq_mux_thread, NULL) != 0) {
+		ASE_ERR("Message queue IO thread could not be started\n");
+		goto err;
+	}
+
+	mq_mux_running = true;
+
+	FUNC_CALL_EXIT;
+	return 0;
+
+  err:
+	if (mq_mux_stop_fd != -1)
+		close(mq_mux_stop_fd);
+	mq_mux_stop_fd = -1;
+	close(mq_mux_epfd);
+	mq_mux_epfd = -1;
+	return -1;
+}
+
+
+void ase_mq_mux_stop(void)
+{
+	FUNC_CALL_ENTRY;
+
+	uint64_t val = 1;
+	int i;
+
+	if (mq_mux_running) {
+		mq_mux_running = false;
+
+		// A fatal receive error on the IO thread itself ends up here. The
+		// thread then exits once control returns to its loop.
+		__atomic_store_n(&mq_mux_stopping, true, __ATOMIC_RELEASE);
+		if (write(mq_mux_stop_fd, &val, sizeof(val)) != sizeof(val))
+			ase_error_report("write", errno, ASE_OS_MQUEUE_ERR);
+		if (!pthread_equal(pthread_self(), mq_mux_tid))
+			pthread_join(mq_mux_tid, NULL);
+
+		close(mq_mux_stop_fd);
+		mq_mux_stop_fd = -1;
+		close(mq_mux_epfd);
+		mq_mux_epfd = -1;
+	}
+
+	pthread_mutex_lock(&mq_mux_handler_lock);
+	for (i = 0; i < ASE_MQ_MUX_MAX_HANDLERS; i++)
+		mq_mux_handler[i].handler = NULL;
+	pthread_mutex_unlock(&mq_mux_handler_lock);
+
+	for (i = 0; i < mq_mux_num_chan; i++)
+		close(mq_mux_chan[i].dummy_wr_fd);
+	mq_mux_num_chan = 0;
+
+	FUNC_CALL_EXIT;
+}
+
+
+int ase_mq_mux_add_fd(int fd, ase_mq_mux_handler_t handler, void *arg)
+{
+	FUNC_CALL_ENTRY;
+
+	struct ase_mq_mux_handler_ent_t *ent = NULL;
+	struct epoll_event ev;
+	int h;
+
+	if (!mq_mux_running)
+		return -1;
+
+	pthread_mutex_lock(&mq_mux_handler_lock);
+	for (h = 0; h < ASE_MQ_MUX_MAX_HANDLERS; h++) {
+		if (mq_mux_handler[h].handler == NULL) {
+			ent = &mq_mux_handler[h];
+			ent->fd = fd;
+			ent->handler = handler;
+			ent->arg = arg;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&mq_mux_handler_lock);
+
+	if (ent == NULL) {
+		ASE_ERR("No free IO thread handler for descriptor %d\n", fd);
+		return -1;
+	}
+
+	ev.events = EPOLLIN;
+	ev.data.u32 = ASE_MQ_MUX_EV_HANDLER | h;
+	if (epoll_ctl(mq_mux_epfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+		ase_error_report("epoll_ctl", errno, ASE_OS_MQUEUE_ERR);
+		pthread_mutex_lock(&mq_mux_handler_lock);
+		ent->handler = NULL;
+		pthread_mutex_unlock(&mq_mux_handler_lock);
+		return -1;
+	}
+
+	FUNC_CALL_EXIT;
+	return 0;
+}
+
+
+void ase_mq_mux_del_fd(int fd)
+{
+	FUNC_CALL_ENTRY;
+
+	int h;
+
+	pthread_mutex_lock(&mq_mux_handler_lock);
+	for (h = 0; h < ASE_MQ_MUX_MAX_HANDLERS; h++) {
+		if (mq_mux_handler[h].handler && (mq_mux_handler[h].fd == fd)) {
+			if (mq_mux_epfd != -1)
+				epoll_ctl(mq_mux_epfd, EPOLL_CTL_DEL, fd, NULL);
+			mq_mux_handler[h].handler = NULL;
+		}
+	}
+	pthread_mutex_unlock(&mq_mux_handler_lock);
+
+	FUNC_CALL_EXIT;
+}
+
+
+bool ase_mq_mux_active(void)
+{
+	return mq_mux_running && (mq_mux_num_chan != 0);
+}
+
+
+bool ase_mq_mux_owns(int mq)
+{
+	return mq_mux_running && (mq_mux_chan_get(mq) != NULL);
+}
+
+
+uint32_t ase_mq_mux_doorbell(void)
+{
+	return __atomic_load_n(&mq_mux_doorbell, __ATOMIC_SEQ_CST);
+}
+
+
+int ase_mq_mux_recv(int mq, char *str, int size)
+{
+	struct ase_mq_mux_chan_t *ch = mq_mux_chan_get(mq);
+	struct ase_mq_mux_slot_t *slot;
+	uint32_t head;
+
+	if (ch == NULL)
+		return ASE_MSG_ERROR;
+
+	head = ch->head;
+	if (__atomic_load_n(&ch->tail, __ATOMIC_ACQUIRE) == head)
+		return ASE_MSG_ABSENT;
+
+	slot = &ch->slot[head & ASE_MQ_MUX_MASK];
+	if (slot->len > size) {
+		ASE_ERR("Message size %d too large for buffer (%d)!", slot->len, size);
+		start_simkill_countdown();
+		exit(1);
+	}
+	memcpy(str, slot->data, slot->len);
+
+	__atomic_store_n(&ch->head, head + 1, __ATOMIC_SEQ_CST);
+
+	// Watch the FIFO again if the IO thread stopped while the queue was full
+	if (__atomic_load_n(&ch->paused, __ATOMIC_SEQ_CST) &&
+	    __atomic_exchange_n(&ch->paused, 0, __ATOMIC_SEQ_CST) && mq_mux_running)
+		mq_mux_arm(ch, EPOLLIN);
+
+	return ASE_MSG_PRESENT;
+}
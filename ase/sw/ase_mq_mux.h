@@ -0,0 +1,89 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Simulator-side receive multiplexer for named FIFO message queues.
+//
+// ase_listener() runs on every clock and would otherwise issue a read()
+// on each inbound FIFO per call. Instead, an IO thread waits on all the
+// FIFOs with epoll and moves complete messages into per-channel
+// in-process queues. mqueue_recv() on a registered descriptor pops from
+// those queues, and a doorbell counter tells the listener whether there
+// is anything to pop at all.
+//
+// A channel whose queue is full is taken out of the epoll set until the
+// DPI thread frees a slot, so that it doesn't hold up the others.
+//
+// FIFOs are not registered with the shared memory rings, which need no
+// system calls. The IO thread runs anyway, since it also serves other
+// descriptors, such as the event socket, through handlers.
+//
+
+#ifndef _ASE_MQ_MUX_H_
+#define _ASE_MQ_MUX_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Maximum number of FIFOs handled by the IO thread
+#define ASE_MQ_MUX_MAX_CHANNELS  8
+
+// Messages buffered per channel. Must be a power of 2.
+#define ASE_MQ_MUX_SLOTS         32
+
+// Maximum number of descriptors with handlers
+#define ASE_MQ_MUX_MAX_HANDLERS  4
+
+// Called on the IO thread when fd is readable
+typedef void (*ase_mq_mux_handler_t)(int fd, void *arg);
+
+// Register the inbound FIFO descriptor mq, opened by mqueue_open() from
+// mq_name. Must be called before ase_mq_mux_start().
+int ase_mq_mux_add(const char *mq_name, int mq);
+
+// Start/stop the IO thread. Return 0 on success. On failure mqueue_recv()
+// keeps reading the FIFOs directly.
+int ase_mq_mux_start(void);
+void ase_mq_mux_stop(void);
+
+// Watch fd on the running IO thread. Returns 0 on success.
+int ase_mq_mux_add_fd(int fd, ase_mq_mux_handler_t handler, void *arg);
+// Stop watching fd. The handler is not running when this returns and
+// won't be called again. Must not be called from a handler.
+void ase_mq_mux_del_fd(int fd);
+
+// Is the IO thread receiving from FIFOs?
+bool ase_mq_mux_active(void);
+bool ase_mq_mux_owns(int mq);
+
+// Bumped by the IO thread after every message it queues
+uint32_t ase_mq_mux_doorbell(void);
+
+// Same contract as mqueue_recv(), never blocks
+int ase_mq_mux_recv(int mq, char *str, int size);
+
+#endif // _ASE_MQ_MUX_H_
@@ -0,0 +1,567 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Shared-memory ring transport for ASE message queues.
+//
+// Each ring is a byte stream of records, an 8 byte header holding the
+// message length followed by the payload padded to 8 bytes. The consumer
+// owns "head" and the producers own "tail". All positions are free-running
+// byte offsets, so the ring is empty when head and tail are equal.
+//
+// A ring has a single consumer but may have several producer threads.
+// A producer claims space by advancing "reserve" with a compare-and-swap,
+// copies its record in, then waits for the producers ahead of it to
+// publish before moving "tail" past its own record.
+//
+// A blocked consumer announces itself in rx_waiting and sleeps on the
+// rx_seq futex. The producer checks rx_waiting after publishing a record
+// and wakes the consumer only when needed. Producers waiting for space
+// do the same with tx_waiting and tx_seq.
+//
+
+#include "ase_common.h"
+#include "ase_mq_ring.h"
+
+// "ASERINGS"
+#define ASE_MQ_RING_MAGIC        UINT64_C(0x41534552494E4753)
+#define ASE_MQ_RING_VERSION      2
+
+#define ASE_MQ_RING_MASK         (ASE_MQ_RING_DATA_SIZE - 1)
+#define ASE_MQ_RING_REC_HDR      8
+#define ASE_MQ_RING_ALIGN(n)     (((uint64_t)(n) + 7) & ~UINT64_C(7))
+
+// Sleeping ends wake up at this interval to check that the peer is alive
+#define ASE_MQ_RING_WAIT_NSEC    (100 * 1000 * 1000)
+
+//
+// The layout must be identical on both 64 bit and 32 bit compilations.
+// Producer and consumer fields are on separate cache lines.
+//
+struct ase_mq_ring_t {
+	// Written by the producers
+	uint64_t tail __attribute__((aligned(64)));
+	uint64_t reserve;
+	uint32_t tx_waiting;
+	uint32_t rx_seq;
+
+	// Written by the consumer
+	uint64_t head __attribute__((aligned(64)));
+	uint32_t rx_waiting;
+	uint32_t tx_seq;
+
+	char data[ASE_MQ_RING_DATA_SIZE] __attribute__((aligned(64)));
+};
+
+struct ase_mq_ring_seg_t {
+	uint64_t magic;
+	uint32_t version;
+	uint32_t num_rings;
+	uint32_t data_size;
+	int32_t sim_pid;
+	int32_t app_pid;
+	uint32_t closed;
+	uint32_t doorbell;	// Bumped on every app2sim record
+	struct ase_mq_ring_t ring[ASE_MQ_INSTANCES];
+};
+
+// Process-local view of each channel
+struct ase_mq_ring_desc_t {
+	struct ase_mq_ring_t *ring;
+	bool is_tx;
+	bool nonblock;
+};
+
+static struct ase_mq_ring_seg_t *mq_ring_seg;
+static struct ase_mq_ring_desc_t mq_ring_desc[ASE_MQ_INSTANCES];
+#ifdef SIM_SIDE
+static char mq_ring_path[ASE_FILEPATH_LEN];
+#endif
+
+
+static void mq_ring_path_gen(char *path)
+{
+	snprintf(path, ASE_FILEPATH_LEN, "%s/%s", ase_workdir_path,
+		 ASE_MQ_RING_FILENAME);
+}
+
+/*
+ * Is the other side of the segment still there? A process that died
+ * without cleaning up is detected with kill(pid, 0). Without an attached
+ * application nothing will drain or fill the simulator's rings, so a
+ * blocked simulator must not keep waiting.
+ */
+static bool mq_ring_peer_alive(void)
+{
+	pid_t peer;
+
+	if (__atomic_load_n(&mq_ring_seg->closed, __ATOMIC_ACQUIRE))
+		return false;
+
+#ifdef SIM_SIDE
+	peer = __atomic_load_n(&mq_ring_seg->app_pid, __ATOMIC_ACQUIRE);
+#else
+	peer = mq_ring_seg->sim_pid;
+#endif
+	// No application attached, or it detached
+	if (peer <= 0)
+		return false;
+
+	return !((kill(peer, 0) == -1) && (errno == ESRCH));
+}
+
+/*
+ * Wait until *pos moves away from "seen", spinning briefly before going
+ * to sleep. The waiter count and the position are both accessed with
+ * sequential consistency so that either the peer sees the count or this
+ * side sees the new position.
+ */
+static int mq_ring_wait_pos(uint64_t *pos, uint64_t seen,
+			    uint32_t *waiting, uint32_t *seq)
+{
+	int ret = 0;
+	int spin;
+	uint32_t s;
+
+	for (spin = 0; spin < ASE_SPIN_LIMIT; spin++) {
+		if (__atomic_load_n(pos, __ATOMIC_ACQUIRE) != seen)
+			return 0;
+		ase_cpu_relax();
+	}
+
+	__atomic_fetch_add(waiting, 1, __ATOMIC_SEQ_CST);
+	s = __atomic_load_n(seq, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(pos, __ATOMIC_SEQ_CST) == seen)
+		ret = ase_futex_wait(seq, s, ASE_MQ_RING_WAIT_NSEC);
+	__atomic_fetch_sub(waiting, 1, __ATOMIC_RELAXED);
+
+#ifndef SIM_SIDE
+	// Watcher threads are stopped with pthread_cancel()
+	pthread_testcancel();
+#endif
+
+	return ret;
+}
+
+static void mq_ring_notify(uint32_t *waiting, uint32_t *seq)
+{
+	if (__atomic_load_n(waiting, __ATOMIC_SEQ_CST)) {
+		__atomic_fetch_add(seq, 1, __ATOMIC_SEQ_CST);
+		ase_futex_wake(seq);
+	}
+}
+
+static void mq_ring_copy_in(struct ase_mq_ring_t *r, uint64_t pos,
+			    const void *src, size_t len)
+{
+	size_t off = pos & ASE_MQ_RING_MASK;
+	size_t first = ASE_MQ_RING_DATA_SIZE - off;
+
+	if (first > len)
+		first = len;
+	memcpy(&r->data[off], src, first);
+	memcpy(&r->data[0], (const char *)src + first, len - first);
+}
+
+static void mq_ring_copy_out(struct ase_mq_ring_t *r, uint64_t pos,
+			     void *dst, size_t len)
+{
+	size_t off = pos & ASE_MQ_RING_MASK;
+	size_t first = ASE_MQ_RING_DATA_SIZE - off;
+
+	if (first > len)
+		first = len;
+	memcpy(dst, &r->data[off], first);
+	memcpy((char *)dst + first, &r->data[0], len - first);
+}
+
+static struct ase_mq_ring_desc_t *mq_ring_desc_get(int mq)
+{
+	int idx = mq - ASE_MQ_RING_HANDLE_BASE;
+
+	if ((idx < 0) || (idx >= ASE_MQ_INSTANCES) ||
+	    (mq_ring_desc[idx].ring == NULL)) {
+		ASE_ERR("Illegal IPC ring handle 0x%x\n", mq);
+		return NULL;
+	}
+
+	return &mq_ring_desc[idx];
+}
+
+
+bool ase_mq_ring_active(void)
+{
+	return (mq_ring_seg != NULL);
+}
+
+
+uint32_t ase_mq_ring_doorbell(void)
+{
+	return __atomic_load_n(&mq_ring_seg->doorbell, __ATOMIC_SEQ_CST);
+}
+
+
+/*
+ * ase_mq_ring_create : Simulator side. Create the segment holding one
+ * ring per mq_array channel.
+ */
+#ifdef SIM_SIDE
+int ase_mq_ring_create(void)
+{
+	FUNC_CALL_ENTRY;
+
+	int fd;
+	void *seg;
+
+	mq_ring_path_gen(mq_ring_path);
+	unlink(mq_ring_path);
+
+	fd = open(mq_ring_path, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd == -1) {
+		ASE_ERR("Error creating IPC ring segment %s\n", mq_ring_path);
+		return -1;
+	}
+
+	if (ftruncate(fd, sizeof(struct ase_mq_ring_seg_t)) != 0) {
+		ase_error_report("ftruncate", errno, ASE_OS_SHM_ERR);
+		close(fd);
+		unlink(mq_ring_path);
+		return -1;
+	}
+
+	seg = mmap(NULL, sizeof(struct ase_mq_ring_seg_t),
+		   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (seg == MAP_FAILED) {
+		ase_error_report("mmap", errno, ASE_OS_MEMMAP_ERR);
+		unlink(mq_ring_path);
+		return -1;
+	}
+
+	// Add IPC to list
+	add_to_ipc_list("MQ", mq_ring_path);
+	fflush(local_ipc_fp);
+
+	mq_ring_seg = seg;
+	mq_ring_seg->version = ASE_MQ_RING_VERSION;
+	mq_ring_seg->num_rings = ASE_MQ_INSTANCES;
+	mq_ring_seg->data_size = ASE_MQ_RING_DATA_SIZE;
+	mq_ring_seg->sim_pid = getpid();
+
+	// Magic is written last. The application ignores the segment until
+	// it is set.
+	__atomic_store_n(&mq_ring_seg->magic, ASE_MQ_RING_MAGIC,
+			 __ATOMIC_RELEASE);
+
+	FUNC_CALL_EXIT;
+	return 0;
+}
+#endif
+
+
+/*
+ * ase_mq_ring_attach : Application side. Map the segment if the simulator
+ * created one. A missing segment just means the simulator is using named
+ * FIFOs.
+ */
+#ifndef SIM_SIDE
+int ase_mq_ring_attach(void)
+{
+	FUNC_CALL_ENTRY;
+
+	char path[ASE_FILEPATH_LEN];
+	struct stat st;
+	struct ase_mq_ring_seg_t *seg;
+	int fd;
+	int ipc_iter;
+
+	mq_ring_path_gen(path);
+	fd = open(path, O_RDWR);
+	if (fd == -1)
+		return -1;
+
+	if ((fstat(fd, &st) != 0) ||
+	    (st.st_size < (off_t)sizeof(struct ase_mq_ring_seg_t))) {
+		close(fd);
+		return -1;
+	}
+
+	seg = mmap(NULL, sizeof(struct ase_mq_ring_seg_t),
+		   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (seg == MAP_FAILED)
+		return -1;
+
+	if ((__atomic_load_n(&seg->magic, __ATOMIC_ACQUIRE) != ASE_MQ_RING_MAGIC) ||
+	    (seg->version != ASE_MQ_RING_VERSION) ||
+	    (seg->num_rings != ASE_MQ_INSTANCES) ||
+	    (seg->data_size != ASE_MQ_RING_DATA_SIZE)) {
+		ASE_ERR("IPC ring segment %s does not match this release, ignoring it\n",
+			path);
+		munmap(seg, sizeof(struct ase_mq_ring_seg_t));
+		return -1;
+	}
+
+	// Stale segment left behind by a simulator that died
+	if ((kill(seg->sim_pid, 0) == -1) && (errno == ESRCH)) {
+		munmap(seg, sizeof(struct ase_mq_ring_seg_t));
+		return -1;
+	}
+
+	// Drop anything a previous application left unread in the
+	// sim2app rings. This side is their only consumer. A previous
+	// application that died mid-send may also have left a reservation
+	// in an app2sim ring that will never be published.
+	for (ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++) {
+		struct ase_mq_ring_t *r = &seg->ring[ipc_iter];
+
+		if ((mq_array[ipc_iter].perm_flag & O_ACCMODE) == O_RDONLY) {
+			__atomic_store_n(&r->head,
+					 __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE),
+					 __ATOMIC_SEQ_CST);
+		} else {
+			__atomic_store_n(&r->reserve,
+					 __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE),
+					 __ATOMIC_SEQ_CST);
+		}
+	}
+
+	__atomic_store_n(&seg->app_pid, getpid(), __ATOMIC_RELEASE);
+	mq_ring_seg = seg;
+
+	FUNC_CALL_EXIT;
+	return 0;
+}
+#endif
+
+
+/*
+ * ase_mq_ring_wakeup : Kick every thread in this process that is sleeping
+ * on a ring, e.g. so a cancelled watcher reaches a cancellation point.
+ */
+void ase_mq_ring_wakeup(void)
+{
+	int ipc_iter;
+
+	if (mq_ring_seg == NULL)
+		return;
+
+	for (ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++) {
+		struct ase_mq_ring_t *r = &mq_ring_seg->ring[ipc_iter];
+
+		__atomic_fetch_add(&r->rx_seq, 1, __ATOMIC_SEQ_CST);
+		ase_futex_wake(&r->rx_seq);
+		__atomic_fetch_add(&r->tx_seq, 1, __ATOMIC_SEQ_CST);
+		ase_futex_wake(&r->tx_seq);
+	}
+}
+
+
+void ase_mq_ring_detach(void)
+{
+	FUNC_CALL_ENTRY;
+
+	if (mq_ring_seg == NULL)
+		return;
+
+#ifdef SIM_SIDE
+	// Blocked application readers see the closed flag once woken
+	__atomic_store_n(&mq_ring_seg->closed, 1, __ATOMIC_SEQ_CST);
+	ase_mq_ring_wakeup();
+	unlink(mq_ring_path);
+#else
+	int32_t pid = getpid();
+	__atomic_compare_exchange_n(&mq_ring_seg->app_pid, &pid, 0, false,
+				    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+
+	munmap(mq_ring_seg, sizeof(struct ase_mq_ring_seg_t));
+	mq_ring_seg = NULL;
+	ase_memset(mq_ring_desc, 0, sizeof(mq_ring_desc));
+
+	FUNC_CALL_EXIT;
+}
+
+
+int ase_mq_ring_open(const char *mq_name, int perm_flag)
+{
+	FUNC_CALL_ENTRY;
+
+	int ipc_iter;
+
+	for (ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++) {
+		if (ase_strncmp(mq_array[ipc_iter].name, mq_name,
+				ASE_MQ_NAME_LEN) == 0)
+			break;
+	}
+
+	if (ipc_iter == ASE_MQ_INSTANCES) {
+		ASE_ERR("Error opening IPC ring %s\n", mq_name);
+#ifdef SIM_SIDE
+		start_simkill_countdown();
+#endif
+		exit(1);
+	}
+
+	mq_ring_desc[ipc_iter].ring = &mq_ring_seg->ring[ipc_iter];
+	mq_ring_desc[ipc_iter].is_tx = ((perm_flag & O_ACCMODE) == O_WRONLY);
+	mq_ring_desc[ipc_iter].nonblock = ((perm_flag & O_NONBLOCK) != 0);
+
+	FUNC_CALL_EXIT;
+	return ASE_MQ_RING_HANDLE_BASE + ipc_iter;
+}
+
+
+void ase_mq_ring_send(int mq, const char *str, int size)
+{
+	FUNC_CALL_ENTRY;
+
+	struct ase_mq_ring_desc_t *desc = mq_ring_desc_get(mq);
+	struct ase_mq_ring_t *r;
+	uint64_t rec_len = ASE_MQ_RING_REC_HDR + ASE_MQ_RING_ALIGN(size);
+	uint64_t tail;
+	uint64_t head;
+	uint32_t hdr[2];
+	int spin;
+
+	if ((desc == NULL) || !desc->is_tx)
+		goto wr_error;
+
+	if ((size < 0) || (rec_len > ASE_MQ_RING_DATA_SIZE)) {
+		ASE_ERR("Message size %d too large for IPC ring!\n", size);
+		goto wr_error;
+	}
+
+	r = desc->ring;
+
+	// Claim space for the record, waiting for the consumer to free it
+	tail = __atomic_load_n(&r->reserve, __ATOMIC_ACQUIRE);
+	for (;;) {
+		head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+		if ((tail + rec_len - head) > ASE_MQ_RING_DATA_SIZE) {
+			if ((mq_ring_wait_pos(&r->head, head, &r->tx_waiting, &r->tx_seq) == ETIMEDOUT) &&
+			    !mq_ring_peer_alive()) {
+				ASE_ERR("IPC ring is full and its peer is gone\n");
+				goto wr_error;
+			}
+			tail = __atomic_load_n(&r->reserve, __ATOMIC_ACQUIRE);
+			continue;
+		}
+
+		if (__atomic_compare_exchange_n(&r->reserve, &tail, tail + rec_len,
+						false, __ATOMIC_ACQ_REL,
+						__ATOMIC_ACQUIRE))
+			break;
+	}
+
+	hdr[0] = size;
+	hdr[1] = 0;
+	mq_ring_copy_in(r, tail, hdr, sizeof(hdr));
+	mq_ring_copy_in(r, tail + ASE_MQ_RING_REC_HDR, str, size);
+
+	// Records are published in reservation order. The producers ahead
+	// of this one are only copying a record in.
+	for (spin = 0; __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) != tail; spin++) {
+		if (spin < ASE_SPIN_LIMIT)
+			ase_cpu_relax();
+		else
+			sched_yield();
+	}
+
+	// Publish the record
+	__atomic_store_n(&r->tail, tail + rec_len, __ATOMIC_SEQ_CST);
+#ifndef SIM_SIDE
+	__atomic_fetch_add(&mq_ring_seg->doorbell, 1, __ATOMIC_SEQ_CST);
+#endif
+	mq_ring_notify(&r->rx_waiting, &r->rx_seq);
+
+	FUNC_CALL_EXIT;
+	return;
+
+  wr_error:
+#ifdef SIM_SIDE
+	start_simkill_countdown();
+#endif
+	exit(1);
+}
+
+
+int ase_mq_ring_recv(int mq, char *str, int size)
+{
+	FUNC_CALL_ENTRY;
+
+	struct ase_mq_ring_desc_t *desc = mq_ring_desc_get(mq);
+	struct ase_mq_ring_t *r;
+	uint64_t head;
+	uint32_t hdr[2];
+	int msg_len;
+
+	if ((desc == NULL) || desc->is_tx) {
+		FUNC_CALL_EXIT;
+		return ASE_MSG_ERROR;
+	}
+
+	r = desc->ring;
+	head = r->head;
+
+	// Wait for a record
+	while (__atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) == head) {
+		if (desc->nonblock) {
+			FUNC_CALL_EXIT;
+			return ASE_MSG_ABSENT;
+		}
+
+		// Like EOF on a FIFO when the simulator has closed the rings
+		if (__atomic_load_n(&mq_ring_seg->closed, __ATOMIC_ACQUIRE) ||
+		    ((mq_ring_wait_pos(&r->tail, head, &r->rx_waiting, &r->rx_seq) == ETIMEDOUT) &&
+		     !mq_ring_peer_alive())) {
+			FUNC_CALL_EXIT;
+			return ASE_MSG_ERROR;
+		}
+	}
+
+	mq_ring_copy_out(r, head, hdr, sizeof(hdr));
+	msg_len = hdr[0];
+	if (msg_len > size) {
+		ASE_ERR("Message size %d too large for buffer (%d)!", msg_len, size);
+#ifdef SIM_SIDE
+		start_simkill_countdown();
+#endif
+		exit(1);
+	}
+
+	mq_ring_copy_out(r, head + ASE_MQ_RING_REC_HDR, str, msg_len);
+
+	// Release the record
+	__atomic_store_n(&r->head,
+			 head + ASE_MQ_RING_REC_HDR + ASE_MQ_RING_ALIGN(msg_len),
+			 __ATOMIC_SEQ_CST);
+	mq_ring_notify(&r->tx_waiting, &r->tx_seq);
+
+	FUNC_CALL_EXIT;
+	return ASE_MSG_PRESENT;
+}
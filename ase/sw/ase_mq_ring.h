@@ -0,0 +1,87 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Shared-memory ring transport for ASE message queues. Each mq_array
+// channel maps to a single-producer/single-consumer byte ring in a segment
+// under $ASE_WORKDIR. The rings are used behind the mqueue_* API in place of
+// named FIFOs when the simulator creates the segment (ENABLE_IPC_RINGS in
+// ase.cfg). Named FIFOs remain the fallback.
+//
+
+#ifndef _ASE_MQ_RING_H_
+#define _ASE_MQ_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Segment file, created by the simulator in $ASE_WORKDIR
+#define ASE_MQ_RING_FILENAME     ".ase_ipc_rings"
+
+// Ring handles returned by mqueue_open() are offset far above any legal
+// file descriptor so the two transports can't be confused.
+#define ASE_MQ_RING_HANDLE_BASE  0x40000000
+
+// Data bytes in each ring. Must be a power of 2 and large enough to hold
+// the largest message (HOST_MEM_MAX_DATA_SIZE payloads) plus framing.
+#define ASE_MQ_RING_DATA_SIZE    (256 * 1024)
+
+// Create (simulator) or attach to (application) the ring segment.
+// Return 0 on success. On failure the caller continues with named FIFOs.
+int ase_mq_ring_create(void);
+int ase_mq_ring_attach(void);
+
+// Release the segment. The simulator also marks the rings closed, which
+// wakes blocked application readers, and unlinks the segment file.
+void ase_mq_ring_detach(void);
+
+// True when the ring transport is active in this process.
+bool ase_mq_ring_active(void);
+
+// Counter bumped by the application after every message it sends.
+// The simulator compares it with a previous value to learn whether any
+// app2sim ring may hold new data.
+uint32_t ase_mq_ring_doorbell(void);
+
+// Wake all threads of this process sleeping on a ring.
+void ase_mq_ring_wakeup(void);
+
+static inline bool ase_mq_ring_is_handle(int mq)
+{
+	return (mq >= ASE_MQ_RING_HANDLE_BASE);
+}
+
+// Open the ring for a channel name from mq_array. perm_flag follows the
+// FIFO convention: O_WRONLY is the producer end, O_RDONLY the consumer end
+// and O_NONBLOCK selects non-blocking receive.
+int ase_mq_ring_open(const char *mq_name, int perm_flag);
+
+// Same contract as mqueue_send()/mqueue_recv().
+void ase_mq_ring_send(int mq, const char *str, int size);
+int ase_mq_ring_recv(int mq, char *str, int size);
+
+#endif // _ASE_MQ_RING_H_
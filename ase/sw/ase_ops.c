@@ -25,6 +25,9 @@
 // POSSIBILITY OF SUCH DAMAGE.
 // **************************************************************************
 
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
 #include "ase_common.h"
 
 
@@ -806,3 +809,36 @@ int ase_strncmp(const char *s1, const char *s2, size_t n)
 		return indicator;
 	}
 }
+
+
+/*
+ * ase_futex_wait : Sleep while *word == val, until woken by
+ * ase_futex_wake() or timeout_ns expires (0 waits forever).
+ * Returns 0 or the errno of the wait (EAGAIN, ETIMEDOUT, EINTR).
+ * The futex is not process private, so words in shared memory work too.
+ */
+int ase_futex_wait(volatile uint32_t *word, uint32_t val, long timeout_ns)
+{
+	struct timespec ts;
+	struct timespec *tsp = NULL;
+
+	if (timeout_ns > 0) {
+		ts.tv_sec = timeout_ns / 1000000000L;
+		ts.tv_nsec = timeout_ns % 1000000000L;
+		tsp = &ts;
+	}
+
+	if (syscall(SYS_futex, word, FUTEX_WAIT, val, tsp, NULL, 0) == -1)
+		return errno;
+
+	return 0;
+}
+
+
+/*
+ * ase_futex_wake : Wake all threads sleeping on word
+ */
+void ase_futex_wake(volatile uint32_t *word)
+{
+	syscall(SYS_futex, word, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
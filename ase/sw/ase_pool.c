@@ -0,0 +1,133 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Fixed-size object pools.
+//
+// Objects are carved from slabs. Free objects are linked through their
+// first word. Slabs are linked through a header at the start of each
+// slab so that they can be released when the pool is destroyed.
+//
+
+#include "ase_common.h"
+#include "ase_pool.h"
+
+// Minimum objects added when an empty pool grows
+#define ASE_POOL_MIN_SLAB_OBJS 64
+
+struct ase_pool_slab {
+	ase_pool_slab_t *next;
+	uint64_t pad;  // Keep objects 16 byte aligned
+};
+
+
+//
+// Add a slab of n objects to the free list.
+//
+static void pool_grow(ase_pool_t *pool, uint32_t n)
+{
+	ase_pool_slab_t *slab = ase_malloc(sizeof(ase_pool_slab_t) + n * pool->obj_size);
+	if (slab == NULL) {
+		ASE_ERR("Out of memory growing object pool\n");
+		start_simkill_countdown();
+		return;
+	}
+
+	slab->next = pool->slabs;
+	pool->slabs = slab;
+
+	char *obj = (char *)(slab + 1);
+	for (uint32_t i = 0; i < n; i += 1) {
+		*(void **)obj = pool->free_list;
+		pool->free_list = obj;
+		obj += pool->obj_size;
+	}
+}
+
+
+void ase_pool_init(ase_pool_t *pool, size_t obj_size, uint32_t prealloc)
+{
+	// Room for the free list link and 16 byte alignment
+	if (obj_size < sizeof(void *))
+		obj_size = sizeof(void *);
+	obj_size = (obj_size + 15) & ~(size_t)15;
+
+	if (pool->obj_size != obj_size) {
+		ase_pool_destroy(pool);
+		pool->obj_size = obj_size;
+	}
+
+	// Grow by at least the preallocation when empty
+	if (prealloc > pool->slab_objs)
+		pool->slab_objs = prealloc;
+	if (pool->slab_objs < ASE_POOL_MIN_SLAB_OBJS)
+		pool->slab_objs = ASE_POOL_MIN_SLAB_OBJS;
+
+	uint32_t n_free = 0;
+	for (void *obj = pool->free_list; obj && (n_free < prealloc); obj = *(void **)obj)
+		n_free += 1;
+	if (n_free < prealloc)
+		pool_grow(pool, prealloc - n_free);
+}
+
+
+void ase_pool_destroy(ase_pool_t *pool)
+{
+	while (pool->slabs) {
+		ase_pool_slab_t *next = pool->slabs->next;
+		free(pool->slabs);
+		pool->slabs = next;
+	}
+
+	pool->free_list = NULL;
+	pool->obj_size = 0;
+	pool->slab_objs = 0;
+}
+
+
+void *ase_pool_alloc(ase_pool_t *pool)
+{
+	if (pool->free_list == NULL) {
+		pool_grow(pool, pool->slab_objs);
+		if (pool->free_list == NULL)
+			return NULL;
+	}
+
+	void *obj = pool->free_list;
+	pool->free_list = *(void **)obj;
+	return obj;
+}
+
+
+void ase_pool_free(ase_pool_t *pool, void *obj)
+{
+	if (obj == NULL)
+		return;
+
+	*(void **)obj = pool->free_list;
+	pool->free_list = obj;
+}
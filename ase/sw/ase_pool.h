@@ -0,0 +1,71 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Fixed-size object pools. The PCIe TLP emulators allocate payload
+// buffers, completion records and MMIO request nodes for every
+// transaction. Pools recycle them through a free list, so steady-state
+// traffic does no heap allocation. Pools grow in slabs when empty and
+// release memory only when destroyed.
+//
+// Pools are not thread safe. The TLP emulators use them only from the
+// simulator thread.
+//
+
+#ifndef _ASE_POOL_H_
+#define _ASE_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct ase_pool_slab ase_pool_slab_t;
+
+typedef struct {
+	size_t obj_size;
+	uint32_t slab_objs;   // Objects added to the pool when it is empty
+	void *free_list;
+	ase_pool_slab_t *slabs;
+} ase_pool_t;
+
+// Initialize an empty (zeroed) pool of objects of obj_size bytes,
+// preallocating "prealloc" objects. A pool that is already initialized
+// with the same object size keeps its objects and grows to at least
+// "prealloc". One with a different size is destroyed first, so all
+// objects from it must be dead.
+void ase_pool_init(ase_pool_t *pool, size_t obj_size, uint32_t prealloc);
+
+// Release all memory held by the pool, including objects still in use.
+void ase_pool_destroy(ase_pool_t *pool);
+
+// Get an object. Returns NULL only when out of memory, after starting
+// the simulator shutdown.
+void *ase_pool_alloc(ase_pool_t *pool);
+
+// Return an object to the pool. NULL is ignored.
+void ase_pool_free(ase_pool_t *pool, void *obj);
+
+#endif // _ASE_POOL_H_
@@ -0,0 +1,131 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Binary transaction trace writer. Records are built in place in the
+// shared log ring (ase_log.h) and written out by the log writer thread.
+//
+
+#include "ase_common.h"
+#include "ase_log.h"
+#include "ase_trace.h"
+
+struct ase_trace {
+	int log_id;
+};
+
+
+bool ase_trace_enabled(void)
+{
+	static int enabled = -1;
+
+	if (enabled < 0) {
+		char *str_env = getenv(ASE_TRACE_ENV);
+		enabled = (str_env && (strcmp(str_env, "binary") == 0));
+	}
+
+	return enabled;
+}
+
+
+ase_trace_t *ase_trace_open(const char *logname, uint32_t format)
+{
+	char path[ASE_FILEPATH_LEN];
+	struct ase_trace *t;
+	ase_trace_file_hdr *fh;
+	const char *ext;
+
+	// Replace the log's extension
+	ext = strrchr(logname, '.');
+	if (!ext || strchr(ext, '/'))
+		ext = logname + strlen(logname);
+	snprintf(path, ASE_FILEPATH_LEN, "%.*s%s",
+		 (int)(ext - logname), logname, ASE_TRACE_EXT);
+
+	t = (struct ase_trace *) ase_malloc(sizeof(struct ase_trace));
+	t->log_id = ase_log_open(path);
+	if (t->log_id < 0) {
+		free(t);
+		return NULL;
+	}
+
+	fh = (ase_trace_file_hdr *) ase_log_reserve(t->log_id, sizeof(ase_trace_file_hdr));
+	memcpy(fh->magic, ASE_TRACE_MAGIC, sizeof(fh->magic));
+	fh->version = ASE_TRACE_VERSION;
+	fh->format = format;
+	ase_log_commit(t->log_id, fh);
+
+	ASE_MSG("Writing binary transaction trace to %s\n", path);
+	return t;
+}
+
+
+void *ase_trace_record(ase_trace_t *t, uint32_t len, uint8_t type,
+		       uint8_t flags, int64_t cycle)
+{
+	ase_trace_rec_hdr *rh;
+
+	len = (len + 7) & ~7;
+	rh = (ase_trace_rec_hdr *) ase_log_reserve(t->log_id, len);
+	if (!rh)
+		return NULL;
+
+	rh->len = len;
+	rh->type = type;
+	rh->flags = flags;
+	rh->cycle = cycle;
+
+	return rh;
+}
+
+
+void ase_trace_commit(ase_trace_t *t, void *rec)
+{
+	ase_log_commit(t->log_id, rec);
+}
+
+
+void ase_trace_text(ase_trace_t *t, const char *msg)
+{
+	uint32_t n = strlen(msg);
+	char *rec;
+
+	// At least one NUL terminates the string
+	rec = (char *) ase_trace_record(t, sizeof(ase_trace_rec_hdr) + n + 1,
+					ASE_TRACE_REC_TEXT, 0, 0);
+	if (rec) {
+		memcpy(rec + sizeof(ase_trace_rec_hdr), msg, n);
+		ase_trace_commit(t, rec);
+	}
+}
+
+
+void ase_trace_close(ase_trace_t *t)
+{
+	ase_log_close(t->log_id);
+	free(t);
+}
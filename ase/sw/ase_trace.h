@@ -0,0 +1,172 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Binary transaction trace. The PCIe SS and EA TLP loggers can write
+// fixed-layout records instead of formatted text to log_ase_events.tsv.
+// Records are built in place in large buffers that a background thread
+// writes out, so the simulator does no formatting and no per-line flush.
+// scripts/ase_trace_decode turns a trace back into the text log.
+//
+// Enabled by setting ASE_TRACE_FORMAT=binary in the simulator's
+// environment. The trace is written next to the text log, with the
+// extension replaced by ".bin".
+//
+// File layout: one ase_trace_file_hdr followed by records. Each record
+// starts with an ase_trace_rec_hdr and is padded to 8 bytes. All values
+// are little-endian. The layouts below are mirrored by the decoder, so
+// any change must bump ASE_TRACE_VERSION.
+//
+
+#ifndef _ASE_TRACE_H_
+#define _ASE_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ASE_TRACE_ENV            "ASE_TRACE_FORMAT"
+#define ASE_TRACE_MAGIC          "ASETRACE"
+#define ASE_TRACE_VERSION        1
+#define ASE_TRACE_EXT            ".bin"
+
+// Trace formats (ase_trace_file_hdr.format)
+#define ASE_TRACE_FMT_PCIE_SS    1
+#define ASE_TRACE_FMT_PCIE_EA    2
+
+// Record types (ase_trace_rec_hdr.type)
+#define ASE_TRACE_REC_TEXT       0    // NUL padded log string
+#define ASE_TRACE_REC_PCIE_SS    1    // [ase_trace_pcie_ss_hdr] tdata tkeep,
+                                      // aux holds the tdata width in DWORDs
+#define ASE_TRACE_REC_PCIE_EA    2    // [ase_trace_pcie_ea_hdr] [payload]
+
+// Record flags (ase_trace_rec_hdr.flags)
+#define ASE_TRACE_F_AFU_TO_HOST  0x01
+#define ASE_TRACE_F_SOP          0x02 // Header follows the record header
+#define ASE_TRACE_F_EOP          0x04
+#define ASE_TRACE_F_IRQ          0x08 // EA interrupt, irq_id in aux
+#define ASE_TRACE_F_PAYLOAD      0x10 // EA payload follows
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t format;
+	uint32_t rsvd[4];
+} ase_trace_file_hdr;
+
+typedef struct {
+	uint32_t len;                    // Bytes, including this header
+	uint8_t type;
+	uint8_t flags;
+	uint8_t ch;
+	uint8_t aux;
+	int64_t cycle;
+} ase_trace_rec_hdr;
+
+// PCIe SS header flags (ase_trace_pcie_ss_hdr.flags)
+#define ASE_TRACE_SS_DM_MODE       0x01
+#define ASE_TRACE_SS_VF_ACTIVE     0x02
+#define ASE_TRACE_SS_PREF_PRESENT  0x04
+#define ASE_TRACE_SS_FC            0x08
+
+// Unpacked PCIe SS header. Only the fields of the header's class (memory
+// request, completion, message or interrupt) are set, the rest are 0.
+typedef struct {
+	uint64_t addr;
+	uint32_t len_bytes;
+	uint32_t pref;
+	uint32_t low_addr;
+	uint32_t msg1;
+	uint32_t msg2;
+	uint16_t vf_num;
+	uint16_t req_id;
+	uint16_t tag;
+	uint16_t comp_id;
+	uint16_t byte_count;
+	uint16_t vector_num;
+	uint8_t fmt_type;
+	uint8_t flags;
+	uint8_t pf_num;
+	uint8_t pref_type;
+	uint8_t last_dw_be;
+	uint8_t first_dw_be;
+	uint8_t at;
+	uint8_t cpl_status;
+	uint8_t bcm;
+	uint8_t msg0;
+	uint8_t msg_code;
+	uint8_t rsvd[5];
+} ase_trace_pcie_ss_hdr;
+
+// Unpacked PCIe EA (AXI-S TLP) header
+typedef struct {
+	uint64_t addr;
+	uint16_t length;
+	uint16_t requester_id;
+	uint16_t completer_id;
+	uint16_t byte_count;
+	uint8_t fmttype;
+	uint8_t tc;
+	uint8_t th;
+	uint8_t td;
+	uint8_t ep;
+	uint8_t attr;
+	uint8_t tag;
+	uint8_t last_be;
+	uint8_t first_be;
+	uint8_t status;
+	uint8_t bcm;
+	uint8_t lower_addr;
+	uint8_t rsvd[4];
+} ase_trace_pcie_ea_hdr;
+
+_Static_assert(sizeof(ase_trace_file_hdr) == 32, "ase_trace_file_hdr layout");
+_Static_assert(sizeof(ase_trace_rec_hdr) == 16, "ase_trace_rec_hdr layout");
+_Static_assert(sizeof(ase_trace_pcie_ss_hdr) == 56, "ase_trace_pcie_ss_hdr layout");
+_Static_assert(sizeof(ase_trace_pcie_ea_hdr) == 32, "ase_trace_pcie_ea_hdr layout");
+
+typedef struct ase_trace ase_trace_t;
+
+// True when ASE_TRACE_FORMAT selects the binary trace
+bool ase_trace_enabled(void);
+
+// Open a trace named after the text log "logname". Returns NULL on error.
+ase_trace_t *ase_trace_open(const char *logname, uint32_t format);
+
+// Reserve a zeroed record of "len" bytes (rounded up to 8) with its
+// header filled in. The caller fills the body in place and then commits
+// it with ase_trace_commit().
+void *ase_trace_record(ase_trace_t *trace, uint32_t len, uint8_t type,
+		       uint8_t flags, int64_t cycle);
+void ase_trace_commit(ase_trace_t *trace, void *rec);
+
+// Write a text record
+void ase_trace_text(ase_trace_t *trace, const char *msg);
+
+// Write out everything buffered and close the trace
+void ase_trace_close(ase_trace_t *trace);
+
+#endif // _ASE_TRACE_H_
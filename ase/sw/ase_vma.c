@@ -0,0 +1,389 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Virtual memory area index.
+//
+// The index is a table of non-overlapping [start, end) ranges, sorted by
+// start address, with the page size of each range. Lookups run in parallel
+// under a read lock. Updates from the preload hooks and reloads from smaps
+// take the write lock.
+//
+// Ranges recorded by the hooks are removed by the hooks. Ranges found in
+// smaps may belong to the C library, which unmaps them without passing
+// through the hooks, e.g. when free() releases a large malloc() buffer.
+// Hits on those are confirmed with mincore(), which fails with ENOMEM on
+// unmapped addresses, before they are trusted.
+//
+
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#include <linux/magic.h>
+
+#include "ase_common.h"
+#include "ase_host_memory.h"
+#include "ase_vma.h"
+
+struct ase_vma_t {
+	uint64_t start;
+	uint64_t end;
+	uint64_t page_len;
+	bool hooked;		// Recorded by a preload hook
+};
+
+static struct ase_vma_t *vma_tab;
+static uint32_t vma_num;
+static uint32_t vma_max;
+static pthread_rwlock_t vma_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+// Set once the preload library reports updates
+static volatile bool vma_hooks_active;
+// Set when the table reflects smaps plus all updates since
+static bool vma_valid;
+
+
+//
+// Index of the last range starting at or below va, or -1.
+// Called with vma_lock held.
+//
+static int vma_find(uint64_t va)
+{
+	int lo = 0;
+	int hi = (int)vma_num - 1;
+	int found = -1;
+
+	while (lo <= hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (vma_tab[mid].start <= va) {
+			found = mid;
+			lo = mid + 1;
+		} else {
+			hi = mid - 1;
+		}
+	}
+
+	return found;
+}
+
+
+//
+// Make room for a new range at index i. Called with the write lock held.
+// Returns 0 on success.
+//
+static int vma_open_slot(int i)
+{
+	if (vma_num == vma_max) {
+		uint32_t new_max = vma_max ? 2 * vma_max : 256;
+		struct ase_vma_t *new_tab = realloc(vma_tab, new_max * sizeof(struct ase_vma_t));
+		if (new_tab == NULL)
+			return -1;
+
+		vma_tab = new_tab;
+		vma_max = new_max;
+	}
+
+	memmove(&vma_tab[i + 1], &vma_tab[i], (vma_num - i) * sizeof(struct ase_vma_t));
+	vma_num += 1;
+	return 0;
+}
+
+
+//
+// Drop [start, end) from the table, trimming or splitting ranges that
+// overlap it. Called with the write lock held.
+//
+static void vma_remove(uint64_t start, uint64_t end)
+{
+	int i = vma_find(end - 1);
+
+	while ((i >= 0) && (vma_tab[i].end > start)) {
+		struct ase_vma_t *v = &vma_tab[i];
+
+		if ((v->start < start) && (v->end > end)) {
+			// Hole in the middle of the range
+			if (vma_open_slot(i + 1)) {
+				// No memory for the split. Drop the whole range,
+				// which is safe since lookups that miss reload.
+				v->end = start;
+				vma_valid = false;
+			} else {
+				v = &vma_tab[i];
+				vma_tab[i + 1].start = end;
+				vma_tab[i + 1].end = v->end;
+				vma_tab[i + 1].page_len = v->page_len;
+				vma_tab[i + 1].hooked = v->hooked;
+				v->end = start;
+			}
+		} else if (v->start < start) {
+			v->end = start;
+		} else if (v->end > end) {
+			v->start = end;
+		} else {
+			vma_num -= 1;
+			memmove(&vma_tab[i], &vma_tab[i + 1], (vma_num - i) * sizeof(struct ase_vma_t));
+		}
+
+		i -= 1;
+	}
+}
+
+
+//
+// Record [start, end) with pages of page_len bytes, replacing anything
+// already in the range. Only the hooks add ranges this way. Called with
+// the write lock held.
+//
+static void vma_insert(uint64_t start, uint64_t end, uint64_t page_len)
+{
+	vma_remove(start, end);
+
+	int i = vma_find(start) + 1;
+	if (vma_open_slot(i)) {
+		// The range will be found by a reload
+		vma_valid = false;
+		return;
+	}
+
+	vma_tab[i].start = start;
+	vma_tab[i].end = end;
+	vma_tab[i].page_len = page_len;
+	vma_tab[i].hooked = true;
+}
+
+
+//
+// Rebuild the table from /proc/self/smaps. Called with the write lock held.
+// Returns 0 on success.
+//
+static int vma_reload(void)
+{
+	char line[4096];
+	uint64_t start = 0, end = 0;
+	bool in_range = false;
+
+	FILE *f = fopen("/proc/self/smaps", "r");
+	if (f == NULL)
+		return -1;
+
+	vma_num = 0;
+	vma_valid = true;
+
+	while (fgets(line, sizeof(line), f)) {
+		unsigned long long s, e;
+		char *tmp0;
+		char *tmp1;
+
+		// Range entries begin with <start va>-<end va>
+		s = strtoull(line, &tmp0, 16);
+		// Was a number found and is the next character a dash?
+		if ((tmp0 != line) && (*tmp0 == '-')) {
+			e = strtoull(++tmp0, &tmp1, 16);
+			if ((tmp0 != tmp1) && (*tmp1 == ' ')) {
+				start = s;
+				end = e;
+				in_range = true;
+				continue;
+			}
+		}
+
+		// Look for KernelPageSize within the current range
+		unsigned page_kb;
+		if (in_range && (sscanf(line, "KernelPageSize: %u kB", &page_kb) == 1)) {
+			in_range = false;
+			if (page_kb == 0)
+				continue;
+
+			// smaps is sorted, so ranges are appended
+			if (vma_open_slot(vma_num)) {
+				vma_valid = false;
+				break;
+			}
+			vma_tab[vma_num - 1].start = start;
+			vma_tab[vma_num - 1].end = end;
+			vma_tab[vma_num - 1].page_len = (uint64_t)page_kb * 1024;
+			vma_tab[vma_num - 1].hooked = false;
+		}
+	}
+
+	fclose(f);
+	return 0;
+}
+
+
+int64_t ase_vma_page_len(uint64_t va)
+{
+	int64_t page_len = 0;
+	bool hooked = false;
+	int i;
+
+	// Fast path: the table is current and va is in it
+	pthread_rwlock_rdlock(&vma_lock);
+	if (vma_hooks_active && vma_valid) {
+		i = vma_find(va);
+		if ((i >= 0) && (va < vma_tab[i].end)) {
+			page_len = vma_tab[i].page_len;
+			hooked = vma_tab[i].hooked;
+		}
+	}
+	pthread_rwlock_unlock(&vma_lock);
+
+	// A range from smaps may have been unmapped behind the hooks' back
+	if (page_len && !hooked) {
+		unsigned char vec;
+
+		if ((mincore((void *)(va & ~UINT64_C(4095)), 1, &vec) == -1) &&
+		    (errno == ENOMEM))
+			page_len = 0;
+	}
+
+	if (page_len)
+		return page_len;
+
+	// Miss or stale hit. The mapping may have been added or removed
+	// without passing through the preload hooks.
+	pthread_rwlock_wrlock(&vma_lock);
+	if (vma_reload() == 0) {
+		i = vma_find(va);
+		if ((i >= 0) && (va < vma_tab[i].end))
+			page_len = vma_tab[i].page_len;
+	} else {
+		page_len = -1;
+	}
+	pthread_rwlock_unlock(&vma_lock);
+
+	return page_len;
+}
+
+
+bool ase_vma_tracking(void)
+{
+	return vma_hooks_active;
+}
+
+
+//
+// Page size of a new mapping, derived from mmap() arguments. Returns 0
+// when the size isn't known without asking the kernel.
+//
+static uint64_t vma_mmap_page_len(int flags, int fd)
+{
+	if (flags & MAP_HUGETLB) {
+		// Size encoded in the flags, otherwise the system default
+		int shift = (flags >> MAP_HUGE_SHIFT) & MAP_HUGE_MASK;
+		return shift ? (UINT64_C(1) << shift) : 0;
+	}
+
+	// hugetlbfs files are mapped with the file system's page size
+	if (!(flags & MAP_ANONYMOUS) && (fd >= 0)) {
+		struct statfs fs;
+		if (fstatfs(fd, &fs) == 0 && fs.f_type == HUGETLBFS_MAGIC)
+			return fs.f_bsize;
+	}
+
+	return 4096;
+}
+
+
+void __attribute__((visibility("default"))) ase_mem_hooks_attach(void)
+{
+	pthread_rwlock_wrlock(&vma_lock);
+	// Updates before this point were missed. Force a reload.
+	vma_valid = false;
+	vma_hooks_active = true;
+	pthread_rwlock_unlock(&vma_lock);
+}
+
+
+void __attribute__((visibility("default"))) ase_mem_map_hook(void *va, size_t length, int flags, int fd)
+{
+	if (!vma_hooks_active || (length == 0))
+		return;
+
+	uint64_t page_len = vma_mmap_page_len(flags, fd);
+	uint64_t start = (uint64_t)va;
+	uint64_t end;
+
+	pthread_rwlock_wrlock(&vma_lock);
+	if (page_len) {
+		end = (start + length + page_len - 1) & ~(page_len - 1);
+		vma_insert(start, end, page_len);
+	} else {
+		// Unknown page size. Lookups will miss and reload.
+		vma_remove(start, start + length);
+	}
+	pthread_rwlock_unlock(&vma_lock);
+
+	// Pinned pages in the range are valid again. Called without
+	// vma_lock since page table updates may query the index.
+	ase_host_memory_va_mapped(start, length, true);
+}
+
+
+void __attribute__((visibility("default"))) ase_mem_unmapped_hook(void *va, size_t length)
+{
+	if (!vma_hooks_active || (length == 0))
+		return;
+
+	uint64_t start = (uint64_t)va & ~UINT64_C(4095);
+	uint64_t end = ((uint64_t)va + length + 4095) & ~UINT64_C(4095);
+
+	pthread_rwlock_wrlock(&vma_lock);
+	vma_remove(start, end);
+	pthread_rwlock_unlock(&vma_lock);
+
+	ase_host_memory_va_mapped(start, end - start, false);
+}
+
+
+void __attribute__((visibility("default"))) ase_mem_remap_hook(void *old_va, size_t old_length,
+								  void *new_va, size_t new_length)
+{
+	if (!vma_hooks_active)
+		return;
+
+	uint64_t old_start = (uint64_t)old_va;
+	uint64_t new_start = (uint64_t)new_va;
+
+	pthread_rwlock_wrlock(&vma_lock);
+
+	// The new range inherits the page size of the old one
+	uint64_t page_len = 0;
+	int i = vma_find(old_start);
+	if ((i >= 0) && (old_start < vma_tab[i].end))
+		page_len = vma_tab[i].page_len;
+
+	vma_remove(old_start, old_start + old_length);
+	if (page_len)
+		vma_insert(new_start, new_start + new_length, page_len);
+	else
+		vma_remove(new_start, new_start + new_length);
+
+	pthread_rwlock_unlock(&vma_lock);
+
+	ase_host_memory_va_mapped(old_start, old_length, false);
+	ase_host_memory_va_mapped(new_start, new_length, true);
+}
@@ -0,0 +1,74 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Index of the application's virtual memory areas and their page sizes.
+//
+// ASE needs to know whether an address is mapped and the size of the page
+// holding it in order to validate buffers and to emulate PCIe ATS. The
+// kernel exports this in /proc/self/smaps, but parsing it is far too slow
+// to do on every query. The index is seeded from smaps and then kept
+// current by the mmap(), munmap() and mremap() wrappers in libase-preload.
+//
+// Not every mapping passes through the wrappers. The C library maps memory
+// internally for malloc() and thread stacks and the dynamic loader maps
+// libraries. Lookups that miss therefore reload the index from smaps, and
+// hits on ranges that the wrappers didn't record are checked with mincore()
+// since the C library may also have unmapped them.
+// Without the preload library the index can't be trusted, so every lookup
+// reloads it.
+//
+
+#ifndef _ASE_VMA_H_
+#define _ASE_VMA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Return the size of the page at "va", 0 if nothing is mapped there or
+// -1 on fatal error.
+int64_t ase_vma_page_len(uint64_t va);
+
+// True once libase-preload reports address space updates
+bool ase_vma_tracking(void);
+
+//
+// Hooks called by libase-preload. They are located with dlsym() in order
+// to avoid a link-time dependence of the preload library on libase.
+//
+
+// The preload library has found libase and will report updates
+void ase_mem_hooks_attach(void);
+// After a successful mmap()
+void ase_mem_map_hook(void *va, size_t length, int flags, int fd);
+// After a successful munmap()
+void ase_mem_unmapped_hook(void *va, size_t length);
+// After a successful mremap()
+void ase_mem_remap_hook(void *old_va, size_t old_length, void *new_va, size_t new_length);
+
+#endif // _ASE_VMA_H_
@@ -0,0 +1,204 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Write combining for AFU->host DMA writes. See ase_wc.h.
+//
+
+#include "ase_common.h"
+#include "ase_wc.h"
+
+#define WC_PAGE_MASK ((uint64_t)HOST_MEM_MAX_DATA_SIZE - 1)
+
+static uint32_t wc_window;
+
+// The held write
+static struct {
+	ase_host_memory_write_req req;
+	uint64_t start_cycle;
+	bool valid;
+	char data[HOST_MEM_MAX_DATA_SIZE];
+} wc;
+
+// Sequence numbers of the last write sent and the last acknowledged
+static uint32_t wc_sent_seq;
+static uint32_t wc_acked_seq;
+
+// Address ranges of the most recent writes sent, indexed by sequence
+// number. Must be a power of 2.
+#define WC_TRACK_SIZE 1024
+
+static struct {
+	uint64_t addr;
+	uint32_t bytes;
+} wc_track[WC_TRACK_SIZE];
+
+
+static void wc_send(const ase_host_memory_write_req *wr_req, const void *payload)
+{
+	ase_host_memory_write_req req = *wr_req;
+
+	// The application responds only to failed writes
+	req.flags = HOST_MEM_WR_FLAG_NAK_ONLY;
+	req.seq = ++wc_sent_seq;
+
+	wc_track[req.seq & (WC_TRACK_SIZE - 1)].addr = req.addr;
+	wc_track[req.seq & (WC_TRACK_SIZE - 1)].bytes = req.data_bytes;
+
+	mqueue_send(sim2app_membus_wr_req_tx, (char *) &req, sizeof(req));
+	mqueue_send(sim2app_membus_wr_req_tx, (char *) payload, req.data_bytes);
+}
+
+
+/*
+ * Can wr_req be appended to the held write? Writes with byte enables
+ * aren't combined, since the merged request could express only the
+ * first and last DWORD masks.
+ */
+static bool wc_can_merge(const ase_host_memory_write_req *wr_req)
+{
+	const ase_host_memory_write_req *held = &wc.req;
+
+	return !held->byte_en && !wr_req->byte_en &&
+	       (wr_req->req == held->req) &&
+	       (wr_req->addr_type == held->addr_type) &&
+	       (wr_req->pasid == held->pasid) &&
+	       (wr_req->afu_idx == held->afu_idx) &&
+	       (wr_req->addr == held->addr + held->data_bytes) &&
+	       ((held->data_bytes + wr_req->data_bytes) <= HOST_MEM_MAX_DATA_SIZE) &&
+	       ((held->addr & ~WC_PAGE_MASK) ==
+		((wr_req->addr + wr_req->data_bytes - 1) & ~WC_PAGE_MASK));
+}
+
+
+void ase_wc_init(uint32_t window_cycles)
+{
+	wc_window = window_cycles;
+	wc.valid = false;
+	wc_sent_seq = 0;
+	wc_acked_seq = 0;
+}
+
+
+uint32_t ase_wc_write(const ase_host_memory_write_req *wr_req,
+		      const void *payload, uint64_t cycle)
+{
+	uint32_t n_sent = 0;
+
+	if (wc.valid) {
+		if (wc_can_merge(wr_req)) {
+			memcpy(wc.data + wc.req.data_bytes, payload, wr_req->data_bytes);
+			wc.req.data_bytes += wr_req->data_bytes;
+
+			// Nothing more can be merged once the page is complete
+			if (((wc.req.addr + wc.req.data_bytes) & WC_PAGE_MASK) == 0)
+				return ase_wc_flush();
+			return 0;
+		}
+
+		n_sent = ase_wc_flush();
+	}
+
+	if ((wc_window == 0) || wr_req->byte_en ||
+	    (wr_req->data_bytes > HOST_MEM_MAX_DATA_SIZE) ||
+	    (((wr_req->addr + wr_req->data_bytes) & WC_PAGE_MASK) == 0)) {
+		wc_send(wr_req, payload);
+		return n_sent + 1;
+	}
+
+	wc.req = *wr_req;
+	memcpy(wc.data, payload, wr_req->data_bytes);
+	wc.start_cycle = cycle;
+	wc.valid = true;
+
+	return n_sent;
+}
+
+
+uint32_t ase_wc_flush(void)
+{
+	if (!wc.valid)
+		return 0;
+
+	wc.valid = false;
+	wc_send(&wc.req, wc.data);
+	return 1;
+}
+
+
+uint32_t ase_wc_tick(uint64_t cycle)
+{
+	if (wc.valid && ((cycle - wc.start_cycle) >= wc_window))
+		return ase_wc_flush();
+
+	return 0;
+}
+
+
+bool ase_wc_held(void)
+{
+	return wc.valid;
+}
+
+
+uint32_t ase_wc_acked(const ase_host_memory_write_rsp *wr_rsp)
+{
+	uint32_t n_acked = wr_rsp->seq - wc_acked_seq;
+
+	if (n_acked > (wc_sent_seq - wc_acked_seq)) {
+		ASE_ERR("Unexpected write response, sequence %u\n", wr_rsp->seq);
+		return 0;
+	}
+
+	wc_acked_seq = wr_rsp->seq;
+	return n_acked;
+}
+
+
+static inline bool wc_range_overlaps(uint64_t a, uint32_t a_bytes,
+				     uint64_t b, uint32_t b_bytes)
+{
+	return (a < b + b_bytes) && (b < a + a_bytes);
+}
+
+
+bool ase_wc_overlaps(uint64_t addr, uint32_t bytes, uint32_t n_unacked)
+{
+	if (wc.valid && wc_range_overlaps(addr, bytes, wc.req.addr, wc.req.data_bytes))
+		return true;
+
+	if (n_unacked > WC_TRACK_SIZE)
+		return true;
+
+	for (uint32_t i = 1; i <= n_unacked; i += 1) {
+		uint32_t idx = (wc_sent_seq - i + 1) & (WC_TRACK_SIZE - 1);
+		if (wc_range_overlaps(addr, bytes, wc_track[idx].addr, wc_track[idx].bytes))
+			return true;
+	}
+
+	return false;
+}
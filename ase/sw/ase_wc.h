@@ -0,0 +1,86 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Write combining for AFU->host DMA writes. Each write forwarded to the
+// application costs a pair of IPC messages and a response. AFUs usually
+// write buffers sequentially, one line or one short TLP at a time, so
+// the simulator holds the most recent write for a few cycles and merges
+// writes that extend it into a single request.
+//
+// Only one write is held. It is sent when a write that can't be merged
+// arrives, when the merged write reaches a page boundary, when the
+// combining window expires or when the caller flushes it. Callers must
+// flush before anything that has to be ordered after earlier writes:
+// fences, interrupts, MMIO read completions and DMA reads of lines that
+// ase_wc_overlaps() reports are still being written.
+//
+// All writes sent to the application pass through here and are numbered.
+// The application responds only to failed writes, and acknowledges the
+// others with periodic sequence number watermarks. ase_wc_acked() turns
+// a response into the number of writes it completes.
+//
+// The combiner is used only from the simulator thread.
+//
+
+#ifndef _ASE_WC_H_
+#define _ASE_WC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ase_host_memory.h"
+
+// Set the combining window in cycles. A window of 0 disables combining.
+void ase_wc_init(uint32_t window_cycles);
+
+// Send a write to the application, possibly holding it to be combined
+// with later writes. Returns the number of write requests sent, each of
+// which will get a response.
+uint32_t ase_wc_write(const ase_host_memory_write_req *wr_req,
+		      const void *payload, uint64_t cycle);
+
+// Send the held write, if any. Returns the number of requests sent.
+uint32_t ase_wc_flush(void);
+
+// Send the held write if its window has expired. Called every cycle.
+// Returns the number of requests sent.
+uint32_t ase_wc_tick(uint64_t cycle);
+
+// Is a write held?
+bool ase_wc_held(void);
+
+// Consume a write response from the application. Returns the number of
+// writes it acknowledges, which may be 0.
+uint32_t ase_wc_acked(const ase_host_memory_write_rsp *wr_rsp);
+
+// Does the held write or one of the last n_unacked writes sent overlap
+// [addr, addr + bytes)? Conservatively true when n_unacked is too large
+// to track.
+bool ase_wc_overlaps(uint64_t addr, uint32_t bytes, uint32_t n_unacked);
+
+#endif // _ASE_WC_H_
@@ -0,0 +1,507 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Zero-copy DMA buffers.
+//
+// The application backs buffers with a memfd and passes it to the simulator
+// over the event socket when the buffer is pinned. The simulator keeps a
+// table of mapped regions, sorted by (afu_idx, IOVA). The table is updated
+// by the event socket thread and read by the simulator thread on every DMA,
+// so it is protected by a reader/writer lock.
+//
+
+#include "ase_common.h"
+#include "ase_vma.h"
+#include "ase_zcopy.h"
+
+#ifdef SIM_SIDE
+
+struct ase_zcopy_region_t {
+	int32_t afu_idx;
+	uint64_t iova;
+	uint64_t length;
+	char *base;
+};
+
+static struct ase_zcopy_region_t *zc_regions;
+static uint32_t zc_num_regions;
+static uint32_t zc_max_regions;
+static pthread_rwlock_t zc_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+// Copy of zc_num_regions, checked without the lock so that simulations
+// without zero-copy buffers pay nothing.
+static volatile uint32_t zc_active;
+
+// Statistics, reported when the table is cleared
+static uint64_t zc_num_reads;
+static uint64_t zc_num_writes;
+
+
+//
+// Index of the last region at or below (afu_idx, iova) or -1.
+// Called with zc_lock held.
+//
+static int zc_find(int32_t afu_idx, uint64_t iova)
+{
+	int lo = 0;
+	int hi = (int)zc_num_regions - 1;
+	int found = -1;
+
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		const struct ase_zcopy_region_t *r = &zc_regions[mid];
+
+		if ((r->afu_idx < afu_idx) ||
+		    ((r->afu_idx == afu_idx) && (r->iova <= iova))) {
+			found = mid;
+			lo = mid + 1;
+		} else {
+			hi = mid - 1;
+		}
+	}
+
+	return found;
+}
+
+
+//
+// Pointer to [iova, iova + len) when the range is entirely inside one
+// region, otherwise NULL. Called with zc_lock held.
+//
+static char *zc_lookup(int32_t afu_idx, uint64_t iova, uint32_t len)
+{
+	int i = zc_find(afu_idx, iova);
+	if (i < 0)
+		return NULL;
+
+	const struct ase_zcopy_region_t *r = &zc_regions[i];
+	if (r->afu_idx != afu_idx)
+		return NULL;
+
+	uint64_t offset = iova - r->iova;
+	if ((offset >= r->length) || (len > r->length - offset))
+		return NULL;
+
+	return r->base + offset;
+}
+
+
+//
+// Unmap and remove region i. Called with the zc_lock write lock held.
+//
+static void zc_remove(int i)
+{
+	munmap(zc_regions[i].base, zc_regions[i].length);
+
+	zc_num_regions -= 1;
+	memmove(&zc_regions[i], &zc_regions[i + 1],
+		(zc_num_regions - i) * sizeof(struct ase_zcopy_region_t));
+	zc_active = zc_num_regions;
+}
+
+
+int ase_zcopy_map(int fd, int32_t afu_idx, uint64_t iova, uint64_t length)
+{
+	if (length == 0)
+		return -1;
+
+	char *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		ase_error_report("mmap", errno, ASE_OS_MEMMAP_ERR);
+		return -1;
+	}
+
+	pthread_rwlock_wrlock(&zc_lock);
+
+	// Drop stale regions that overlap the new one. Since regions never
+	// overlap each other, walk back from the last one starting inside
+	// the new range.
+	int i = zc_find(afu_idx, iova + length - 1);
+	while ((i >= 0) && (zc_regions[i].afu_idx == afu_idx) &&
+	       (zc_regions[i].iova + zc_regions[i].length > iova)) {
+		zc_remove(i);
+		i -= 1;
+	}
+
+	if (zc_num_regions == zc_max_regions) {
+		uint32_t new_max = zc_max_regions ? 2 * zc_max_regions : 64;
+		struct ase_zcopy_region_t *new_regions =
+			realloc(zc_regions, new_max * sizeof(struct ase_zcopy_region_t));
+		if (new_regions == NULL) {
+			pthread_rwlock_unlock(&zc_lock);
+			munmap(base, length);
+			ase_error_report("realloc", errno, ASE_OS_MALLOC_ERR);
+			return -1;
+		}
+
+		zc_regions = new_regions;
+		zc_max_regions = new_max;
+	}
+
+	// Insert after region i
+	i += 1;
+	memmove(&zc_regions[i + 1], &zc_regions[i],
+		(zc_num_regions - i) * sizeof(struct ase_zcopy_region_t));
+	zc_regions[i].afu_idx = afu_idx;
+	zc_regions[i].iova = iova;
+	zc_regions[i].length = length;
+	zc_regions[i].base = base;
+	zc_num_regions += 1;
+	zc_active = zc_num_regions;
+
+	pthread_rwlock_unlock(&zc_lock);
+
+	ASE_INFO_2("Zero-copy DMA buffer mapped, IOVA 0x%" PRIx64 ", %" PRIu64 " bytes\n",
+		   iova, length);
+	return 0;
+}
+
+
+int ase_zcopy_unmap(int32_t afu_idx, uint64_t iova)
+{
+	int status = -1;
+
+	pthread_rwlock_wrlock(&zc_lock);
+
+	int i = zc_find(afu_idx, iova);
+	if ((i >= 0) && (zc_regions[i].afu_idx == afu_idx) && (zc_regions[i].iova == iova)) {
+		zc_remove(i);
+		status = 0;
+	}
+
+	pthread_rwlock_unlock(&zc_lock);
+
+	return status;
+}
+
+
+void ase_zcopy_unmap_all(void)
+{
+	pthread_rwlock_wrlock(&zc_lock);
+
+	while (zc_num_regions)
+		zc_remove(zc_num_regions - 1);
+
+	if (zc_num_reads || zc_num_writes) {
+		ASE_INFO_2("Zero-copy DMA: %" PRIu64 " reads, %" PRIu64 " writes\n",
+			   zc_num_reads, zc_num_writes);
+	}
+	zc_num_reads = 0;
+	zc_num_writes = 0;
+
+	pthread_rwlock_unlock(&zc_lock);
+}
+
+
+bool ase_zcopy_active(void)
+{
+	return (zc_active != 0);
+}
+
+
+//
+// Only plain, legal accesses are handled locally. Anything the application
+// would reject (e.g. 4KB boundary crossing) or must translate is left to the
+// message path so errors are reported exactly as before.
+//
+static inline bool zc_req_ok(ase_host_memory_addr_type addr_type,
+			     uint64_t addr, uint32_t data_bytes)
+{
+	return (addr_type == HOST_MEM_AT_UNTRANS) &&
+	       (data_bytes != 0) &&
+	       (((addr & 4095) + data_bytes) <= 4096);
+}
+
+
+bool ase_zcopy_read(const ase_host_memory_read_req *rd_req, void *data)
+{
+	if (!zc_active)
+		return false;
+
+	if ((rd_req->req != HOST_MEM_REQ_READ) ||
+	    !zc_req_ok(rd_req->addr_type, rd_req->addr, rd_req->data_bytes))
+		return false;
+
+	pthread_rwlock_rdlock(&zc_lock);
+
+	const char *src = zc_lookup(rd_req->afu_idx, rd_req->addr, rd_req->data_bytes);
+	if (src) {
+		memcpy(data, src, rd_req->data_bytes);
+		zc_num_reads += 1;
+	}
+
+	pthread_rwlock_unlock(&zc_lock);
+
+	return (src != NULL);
+}
+
+
+// Copy a DWORD, keeping only bytes enabled in the 4 bit mask
+static inline void zc_be_copy_dw(char *dst, const char *src, uint8_t mask)
+{
+	for (int i = 0; i < 4; i += 1) {
+		if (mask & (1 << i))
+			dst[i] = src[i];
+	}
+}
+
+
+bool ase_zcopy_write(const ase_host_memory_write_req *wr_req, const void *data)
+{
+	if (!zc_active)
+		return false;
+
+	if ((wr_req->req != HOST_MEM_REQ_WRITE) ||
+	    !zc_req_ok(wr_req->addr_type, wr_req->addr, wr_req->data_bytes))
+		return false;
+
+	// Byte enable mode requires whole DWORDs
+	if (wr_req->byte_en && (wr_req->data_bytes & 3))
+		return false;
+
+	pthread_rwlock_rdlock(&zc_lock);
+
+	char *dst = zc_lookup(wr_req->afu_idx, wr_req->addr, wr_req->data_bytes);
+	if (dst) {
+		const char *src = data;
+		uint32_t len = wr_req->data_bytes;
+		bool masked_lb = false;
+
+		// Same masking as the application's membus_wr_watcher()
+		if (wr_req->byte_en) {
+			if (wr_req->first_be != 0xf) {
+				zc_be_copy_dw(dst, src, wr_req->first_be);
+				dst += 4;
+				src += 4;
+				len -= 4;
+			}
+
+			if ((wr_req->data_bytes > 4) && (wr_req->last_be != 0xf)) {
+				len -= 4;
+				masked_lb = true;
+			}
+		}
+
+		if (len)
+			memcpy(dst, src, len);
+
+		if (masked_lb)
+			zc_be_copy_dw(dst + len, src + len, wr_req->last_be);
+
+		zc_num_writes += 1;
+	}
+
+	pthread_rwlock_unlock(&zc_lock);
+
+	return (dst != NULL);
+}
+
+#else // !SIM_SIDE
+
+//
+// Buffers shared with the simulator. The simulator's mapping doesn't
+// follow changes to the application's address space, so a buffer is
+// dropped when its pages are unpinned, unmapped or remapped.
+//
+struct ase_zcopy_buf_t {
+	int32_t afu_idx;
+	uint64_t iova;
+	uint64_t va;
+	uint64_t length;
+};
+
+static struct ase_zcopy_buf_t *zc_bufs;
+static uint32_t zc_num_bufs;
+static uint32_t zc_max_bufs;
+static pthread_mutex_t zc_buf_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Copy of zc_num_bufs, checked without the lock by the mmap() hooks
+static volatile uint32_t zc_bufs_active;
+
+
+//
+// Remove the first buffer matching the IOVA range (afu_idx >= 0) or the
+// VA range (afu_idx < 0). Its IOVA is returned in *iova and its AFU in
+// *buf_afu_idx. Returns false when none match.
+//
+static bool zc_buf_take(int32_t afu_idx, uint64_t start, uint64_t length,
+			int32_t *buf_afu_idx, uint64_t *iova)
+{
+	bool found = false;
+
+	pthread_mutex_lock(&zc_buf_lock);
+
+	for (uint32_t i = 0; i < zc_num_bufs; i += 1) {
+		struct ase_zcopy_buf_t *b = &zc_bufs[i];
+		uint64_t b_start = (afu_idx >= 0) ? b->iova : b->va;
+
+		if (((afu_idx >= 0) && (b->afu_idx != afu_idx)) ||
+		    (b_start >= start + length) || (start >= b_start + b->length))
+			continue;
+
+		*buf_afu_idx = b->afu_idx;
+		*iova = b->iova;
+		zc_bufs[i] = zc_bufs[--zc_num_bufs];
+		zc_bufs_active = zc_num_bufs;
+		found = true;
+		break;
+	}
+
+	pthread_mutex_unlock(&zc_buf_lock);
+
+	return found;
+}
+
+
+int ase_zcopy_register(int fd, void *va, int32_t afu_idx, uint64_t iova, uint64_t length)
+{
+	if (!ase_vma_tracking())
+		return -1;
+
+	// Recorded first, so an unmap racing with the registration drops it
+	pthread_mutex_lock(&zc_buf_lock);
+
+	if (zc_num_bufs == zc_max_bufs) {
+		uint32_t new_max = zc_max_bufs ? 2 * zc_max_bufs : 64;
+		struct ase_zcopy_buf_t *new_bufs =
+			realloc(zc_bufs, new_max * sizeof(struct ase_zcopy_buf_t));
+		if (new_bufs == NULL) {
+			pthread_mutex_unlock(&zc_buf_lock);
+			return -1;
+		}
+
+		zc_bufs = new_bufs;
+		zc_max_bufs = new_max;
+	}
+
+	zc_bufs[zc_num_bufs].afu_idx = afu_idx;
+	zc_bufs[zc_num_bufs].iova = iova;
+	zc_bufs[zc_num_bufs].va = (uint64_t)va;
+	zc_bufs[zc_num_bufs].length = length;
+	zc_num_bufs += 1;
+	zc_bufs_active = zc_num_bufs;
+
+	pthread_mutex_unlock(&zc_buf_lock);
+
+	if (register_dma_buffer(fd, afu_idx, iova, length) != 0) {
+		// Not mapped by the simulator, so there is nothing to unregister
+		int32_t buf_afu_idx;
+		uint64_t buf_iova;
+		zc_buf_take(afu_idx, iova, length, &buf_afu_idx, &buf_iova);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+void ase_zcopy_drop(int32_t afu_idx, uint64_t iova, uint64_t length)
+{
+	int32_t buf_afu_idx;
+	uint64_t buf_iova;
+
+	if (!zc_bufs_active)
+		return;
+
+	while (zc_buf_take(afu_idx, iova, length, &buf_afu_idx, &buf_iova))
+		unregister_dma_buffer(buf_afu_idx, buf_iova);
+}
+
+
+void ase_zcopy_va_changed(uint64_t va, uint64_t length)
+{
+	int32_t buf_afu_idx;
+	uint64_t buf_iova;
+
+	if (!zc_bufs_active)
+		return;
+
+	while (zc_buf_take(-1, va, length, &buf_afu_idx, &buf_iova))
+		unregister_dma_buffer(buf_afu_idx, buf_iova);
+}
+
+
+bool ase_zcopy_enabled(void)
+{
+	static int enabled = -1;
+
+	if (enabled < 0) {
+		char *str_env = getenv(ASE_ZCOPY_ENV);
+		enabled = (str_env && (strtol(str_env, NULL, 10) != 0));
+	}
+
+	return enabled;
+}
+
+
+void *ase_zcopy_alloc(uint64_t length, uint64_t align, int *fd)
+{
+	char *rsv;
+	char *base;
+	int err;
+
+	*fd = memfd_create("ase_dma_buffer", MFD_CLOEXEC);
+	if (*fd < 0)
+		return MAP_FAILED;
+
+	if (ftruncate(*fd, length) != 0)
+		goto err_close;
+
+	// Reserve extra address space so the shared mapping can be aligned,
+	// matching the alignment of huge page buffers.
+	rsv = mmap(NULL, length + align, PROT_NONE,
+		   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (rsv == MAP_FAILED)
+		goto err_close;
+
+	base = (char *)(((uintptr_t)rsv + align - 1) & ~((uintptr_t)align - 1));
+	if (mmap(base, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+		 *fd, 0) == MAP_FAILED) {
+		err = errno;
+		munmap(rsv, length + align);
+		errno = err;
+		goto err_close;
+	}
+
+	// Drop the unused parts of the reservation
+	if (base > rsv)
+		munmap(rsv, base - rsv);
+	if (rsv + align > base)
+		munmap(base + length, (rsv + align) - base);
+
+	return base;
+
+err_close:
+	err = errno;
+	close(*fd);
+	*fd = -1;
+	errno = err;
+	return MAP_FAILED;
+}
+
+#endif // SIM_SIDE
@@ -0,0 +1,100 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// Zero-copy DMA. Buffers allocated by fpgaPrepareBuffer() may be backed
+// by a memfd that is passed to the simulator when the buffer is pinned.
+// The simulator maps the same pages and satisfies simple DMA reads and
+// writes to the buffer's IOVA range directly, without sending the payload
+// through the membus message queues. Everything else -- translated
+// addresses, ATS, atomics, fences, preallocated buffers and any request
+// that would be an error -- stays on the message path, where the
+// application remains responsible for translation and validity checks.
+// A buffer is dropped by the simulator as soon as its pages are unpinned,
+// unmapped or remapped, so that DMA to it reports the same errors as
+// before. Unmaps are seen only through libase-preload, and without it
+// buffers are not shared.
+//
+// The mode is enabled in the application by setting ASE_ZERO_COPY_DMA=1.
+//
+
+#ifndef _ASE_ZCOPY_H_
+#define _ASE_ZCOPY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ase_host_memory.h"
+
+#define ASE_ZCOPY_ENV            "ASE_ZERO_COPY_DMA"
+
+#ifdef SIM_SIDE
+
+// Map "length" bytes of the memfd at IOVA "iova" for an AFU. Regions
+// already mapped in the range are dropped. Return 0 on success.
+int ase_zcopy_map(int fd, int32_t afu_idx, uint64_t iova, uint64_t length);
+// Drop the region starting at "iova". Return 0 on success.
+int ase_zcopy_unmap(int32_t afu_idx, uint64_t iova);
+// Drop all regions (end of session).
+void ase_zcopy_unmap_all(void);
+
+// True when at least one region is mapped
+bool ase_zcopy_active(void);
+
+// Try to satisfy a request directly from a mapped region. Return true
+// if the request was handled. On false, nothing was read or written and
+// the request must be sent to the application.
+bool ase_zcopy_read(const ase_host_memory_read_req *rd_req, void *data);
+bool ase_zcopy_write(const ase_host_memory_write_req *wr_req, const void *data);
+
+#else
+
+// True when ASE_ZERO_COPY_DMA requests zero-copy buffers
+bool ase_zcopy_enabled(void);
+
+// Allocate "length" bytes aligned to "align" (a power of 2), backed by a
+// new memfd. The memfd is returned in *fd and must be closed by the caller
+// once it has been shared. Free the buffer with munmap(). Returns
+// MAP_FAILED on error.
+void *ase_zcopy_alloc(uint64_t length, uint64_t align, int *fd);
+
+// Share the buffer at "va", backed by memfd "fd", with the simulator.
+// Buffers are shared only while libase-preload reports unmaps, since
+// the simulator can't tell when the application's copy goes away.
+// Return 0 when the simulator mapped the buffer.
+int ase_zcopy_register(int fd, void *va, int32_t afu_idx, uint64_t iova, uint64_t length);
+// Drop shared buffers overlapping [iova, iova + length). Returns once
+// the simulator has dropped them.
+void ase_zcopy_drop(int32_t afu_idx, uint64_t iova, uint64_t length);
+// Drop shared buffers overlapping [va, va + length), which is about to
+// be unmapped or remapped. Their DMA returns to the message path, where
+// the application's status checks apply.
+void ase_zcopy_va_changed(uint64_t va, uint64_t length);
+
+#endif
+
+#endif // _ASE_ZCOPY_H_
@@ -162,3 +162,91 @@ void fprintf_tlp_host_to_afu(
     fprintf(stream, "\n");
     fflush(stream);
 }
+
+
+static void trace_tlp_hdr(ase_trace_pcie_ea_hdr *t, const t_tlp_hdr_upk *hdr)
+{
+    t->fmttype = hdr->dw0.fmttype;
+    t->length = hdr->dw0.length;
+    t->tc = hdr->dw0.tc;
+    t->th = hdr->dw0.th;
+    t->td = hdr->dw0.td;
+    t->ep = hdr->dw0.ep;
+    t->attr = hdr->dw0.attr;
+
+    // Same classification as fprintf_tlp_hdr()
+    if (tlp_func_is_mem_req(hdr->dw0.fmttype))
+    {
+        t->requester_id = hdr->u.mem.requester_id;
+        t->tag = hdr->u.mem.tag;
+        t->last_be = hdr->u.mem.last_be;
+        t->first_be = hdr->u.mem.first_be;
+        t->addr = hdr->u.mem.addr;
+    }
+    else if (tlp_func_is_completion(hdr->dw0.fmttype))
+    {
+        t->completer_id = hdr->u.cpl.completer_id;
+        t->status = hdr->u.cpl.status;
+        t->bcm = hdr->u.cpl.bcm;
+        t->byte_count = hdr->u.cpl.byte_count;
+        t->requester_id = hdr->u.cpl.requester_id;
+        t->tag = hdr->u.cpl.tag;
+        t->lower_addr = hdr->u.cpl.lower_addr;
+    }
+}
+
+void trace_tlp_beat(
+    ase_trace_t *trace,
+    bool afu_to_host,
+    long long cycle,
+    int ch,
+    const t_tlp_hdr_upk *hdr,
+    const t_ase_axis_pcie_tdata *tdata,
+    bool afu_irq
+)
+{
+    // Header and payload are recorded when the text log would print them
+    bool has_hdr = !afu_irq && tdata->sop;
+    bool has_payload = !afu_irq && (!tdata->sop || tlp_func_has_data(hdr->dw0.fmttype));
+    uint32_t len = sizeof(ase_trace_rec_hdr) +
+                   (has_hdr ? sizeof(ase_trace_pcie_ea_hdr) : 0) +
+                   (has_payload ? sizeof(tdata->payload) : 0);
+    uint8_t flags = (afu_to_host ? ASE_TRACE_F_AFU_TO_HOST : 0) |
+                    (tdata->sop ? ASE_TRACE_F_SOP : 0) |
+                    (tdata->eop ? ASE_TRACE_F_EOP : 0) |
+                    (afu_irq ? ASE_TRACE_F_IRQ : 0) |
+                    (has_payload ? ASE_TRACE_F_PAYLOAD : 0);
+
+    ase_trace_rec_hdr *rh = ase_trace_record(trace, len, ASE_TRACE_REC_PCIE_EA, flags, cycle);
+    if (!rh) return;
+    rh->ch = ch;
+    rh->aux = tdata->irq_id;
+    char *rec = (char *)(rh + 1);
+
+    if (has_hdr)
+    {
+        trace_tlp_hdr((ase_trace_pcie_ea_hdr *)rec, hdr);
+        rec += sizeof(ase_trace_pcie_ea_hdr);
+    }
+
+    if (has_payload)
+    {
+        memcpy(rec, tdata->payload, sizeof(tdata->payload));
+    }
+
+    ase_trace_commit(trace, rh);
+}
+
+void trace_tlp_irq_rsp(
+    ase_trace_t *trace,
+    long long cycle,
+    int irq_id
+)
+{
+    ase_trace_rec_hdr *rec = ase_trace_record(trace, sizeof(ase_trace_rec_hdr),
+                                              ASE_TRACE_REC_PCIE_EA, ASE_TRACE_F_IRQ,
+                                              cycle);
+    if (!rec) return;
+    rec->aux = irq_id;
+    ase_trace_commit(trace, rec);
+}
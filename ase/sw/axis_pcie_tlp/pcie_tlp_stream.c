@@ -31,10 +31,16 @@
 #include <assert.h>
 
 #include "ase_common.h"
+#include "ase_dpi_vec.h"
 #include "ase_host_memory.h"
+#include "ase_log.h"
+#include "ase_pool.h"
+#include "ase_wc.h"
+#include "ase_zcopy.h"
 #include "pcie_tlp_stream.h"
 
 static FILE *logfile;
+static ase_trace_t *trace;        // Binary trace in place of logfile
 
 static t_ase_axis_param_cfg param_cfg;
 static bool in_reset;
@@ -86,7 +92,7 @@ static void tlp_hdr_reset(t_tlp_hdr_upk *hdr)
 // Pack the C TLP message into the expected packed vector
 static void tlp_hdr_pack(svBitVecVal *hdr, const t_tlp_hdr_upk *tlp_upk)
 {
-    svPutPartselBit(hdr, tlp_hdr_dw0_pack(&tlp_upk->dw0), 32*3, 32);
+    ase_dpi_put_bits(hdr, tlp_hdr_dw0_pack(&tlp_upk->dw0), 32*3, 32);
 
     if (tlp_func_is_mem_req(tlp_upk->dw0.fmttype))
     {
@@ -95,18 +101,18 @@ static void tlp_hdr_pack(svBitVecVal *hdr, const t_tlp_hdr_upk *tlp_upk)
         v |= (uint32_t)(tlp_upk->u.mem.tag) << 8;
         v |= (uint32_t)(tlp_upk->u.mem.last_be) << 4;
         v |= tlp_upk->u.mem.first_be;
-        svPutPartselBit(hdr, v, 32*2, 32);
+        ase_dpi_put_bits(hdr, v, 32*2, 32);
 
         // Unpacked address is always a 64 bit value
         if (tlp_func_is_addr64(tlp_upk->dw0.fmttype))
         {
-            svPutPartselBit(hdr, tlp_upk->u.mem.addr >> 32, 32, 32);
-            svPutPartselBit(hdr, tlp_upk->u.mem.addr, 0, 32);
+            ase_dpi_put_bits(hdr, tlp_upk->u.mem.addr >> 32, 32, 32);
+            ase_dpi_put_bits(hdr, tlp_upk->u.mem.addr, 0, 32);
         }
         else
         {
-            svPutPartselBit(hdr, tlp_upk->u.mem.addr, 32, 32);
-            svPutPartselBit(hdr, 0, 0, 32);
+            ase_dpi_put_bits(hdr, tlp_upk->u.mem.addr, 32, 32);
+            ase_dpi_put_bits(hdr, 0, 0, 32);
         }
     }
     else if (tlp_func_is_completion(tlp_upk->dw0.fmttype))
@@ -118,15 +124,15 @@ static void tlp_hdr_pack(svBitVecVal *hdr, const t_tlp_hdr_upk *tlp_upk)
         v |= (uint32_t)(tlp_upk->u.cpl.status) << 13;
         v |= (uint32_t)(tlp_upk->u.cpl.bcm) << 12;
         v |= tlp_upk->u.cpl.byte_count;
-        svPutPartselBit(hdr, v, 32*2, 32);
+        ase_dpi_put_bits(hdr, v, 32*2, 32);
 
         v = 0;
         v |= (uint32_t)(tlp_upk->u.cpl.requester_id) << 16;
         v |= (uint32_t)(tlp_upk->u.cpl.tag) << 8;
         v |= tlp_upk->u.cpl.lower_addr;
-        svPutPartselBit(hdr, v, 32, 32);
+        ase_dpi_put_bits(hdr, v, 32, 32);
 
-        svPutPartselBit(hdr, 0, 0, 32);
+        ase_dpi_put_bits(hdr, 0, 0, 32);
     }
 }
 
@@ -146,25 +152,24 @@ static void tlp_hdr_unpack(
         return;
     }
 
-    svGetPartselBit(&dw0, hdr, 32*3, 32);
+    dw0 = ase_dpi_get_bits(hdr, 32*3, 32);
     tlp_hdr_dw0_unpack(&tlp_upk->dw0, dw0);
 
     if (tlp_func_is_mem_req(tlp_upk->dw0.fmttype))
     {
         uint32_t v;
 
-        svGetPartselBit(&v, hdr, 32*2, 32);
+        v = ase_dpi_get_bits(hdr, 32*2, 32);
         tlp_upk->u.mem.requester_id = v >> 16;
         tlp_upk->u.mem.tag = v >> 8;
         tlp_upk->u.mem.last_be = (v >> 4) & 0xf;
         tlp_upk->u.mem.first_be = v & 0xf;
 
         // Unpacked address is always a 64 bit value
-        uint32_t addr;
-        svGetPartselBit(&addr, hdr, 32, 32);
+        uint32_t addr = ase_dpi_get_bits(hdr, 32, 32);
         if (tlp_func_is_addr64(tlp_upk->dw0.fmttype))
         {
-            svGetPartselBit(&v, hdr, 0, 32);
+            v = ase_dpi_get_bits(hdr, 0, 32);
             tlp_upk->u.mem.addr = ((uint64_t)addr << 32) | v;
         }
         else
@@ -176,13 +181,13 @@ static void tlp_hdr_unpack(
     {
         uint32_t v;
 
-        svGetPartselBit(&v, hdr, 32*2, 32);
+        v = ase_dpi_get_bits(hdr, 32*2, 32);
         tlp_upk->u.cpl.completer_id = v >> 16;
         tlp_upk->u.cpl.status = (v >> 13) & 7;
         tlp_upk->u.cpl.bcm = (v >> 12) & 1;
         tlp_upk->u.cpl.byte_count = v & 0xfff;
 
-        svGetPartselBit(&v, hdr, 32, 32);
+        v = ase_dpi_get_bits(hdr, 32, 32);
         tlp_upk->u.cpl.requester_id = v >> 16;
         tlp_upk->u.cpl.tag = v >> 8;
         tlp_upk->u.cpl.lower_addr = v & 0x7f;
@@ -370,6 +375,7 @@ typedef struct dma_read_cpl
 } t_dma_read_cpl;
 static t_dma_read_cpl *dma_read_cpl_head;
 static t_dma_read_cpl *dma_read_cpl_tail;
+static ase_pool_t dma_read_cpl_pool;
 
 // Number of DWORDs remaining in current host to AFU read completion
 static uint32_t dma_read_cpl_dw_rem;
@@ -377,6 +383,8 @@ static uint32_t dma_read_cpl_dw_rem;
 static uint32_t num_dma_reads_pending;
 static uint32_t num_dma_writes_pending;
 
+static void pcie_push_dma_read_rsp(uint32_t tag);
+
 // Buffer space, indexed by tag, for holding read responses.
 static uint32_t **read_rsp_data;
 static uint32_t read_rsp_n_entries;
@@ -506,10 +514,7 @@ static void pcie_tlp_a2h_cpld(
     }
 
     // Copy payload data
-    for (int i = 0; i < payload_dws; i += 1)
-    {
-        svGetPartselBit(&payload[next_dw_idx + i], tdata->payload, i * 32, 32);
-    }
+    ase_dpi_get_dwords(&payload[next_dw_idx], tdata->payload, 0, payload_dws);
     next_dw_idx += payload_dws;
 
     // Packet complete?
@@ -622,10 +627,7 @@ static void pcie_tlp_a2h_mwr(
     }
 
     // Copy payload data
-    for (int i = 0; i < payload_dws; i += 1)
-    {
-        svGetPartselBit(&payload[next_dw_idx + i], tdata->payload, i * 32, 32);
-    }
+    ase_dpi_get_dwords(&payload[next_dw_idx], tdata->payload, 0, payload_dws);
     next_dw_idx += payload_dws;
 
     // Packet complete?
@@ -650,11 +652,16 @@ static void pcie_tlp_a2h_mwr(
             wr_req.last_be = 0;
         }
 
-        mqueue_send(sim2app_membus_wr_req_tx, (char *) &wr_req, sizeof(wr_req));
-        mqueue_send(sim2app_membus_wr_req_tx, (char *) payload, wr_req.data_bytes);
+        // Zero-copy writes must not pass earlier writes that are still
+        // in flight through the application or held for combining.
+        if ((num_dma_writes_pending == 0) && !ase_wc_held() &&
+            ase_zcopy_write(&wr_req, payload))
+        {
+            return;
+        }
 
         // Update count of pending write responses
-        num_dma_writes_pending += 1;
+        num_dma_writes_pending += ase_wc_write(&wr_req, payload, cycle);
     }
 }
 
@@ -746,6 +753,15 @@ static void pcie_tlp_a2h_mrd(
         rd_req.data_bytes = hdr->dw0.length * 4;
     }
     rd_req.tag = hdr->u.mem.tag;
+
+    // Zero-copy reads complete immediately. Like writes, they must not pass
+    // earlier writes that are still in flight through the application.
+    if ((num_dma_writes_pending == 0) && ase_zcopy_read(&rd_req, read_rsp_data[tag]))
+    {
+        pcie_push_dma_read_rsp(tag);
+        return;
+    }
+
     mqueue_send(sim2app_membus_rd_req_tx, (char *)&rd_req, sizeof(rd_req));
 
     // Update count of pending read responses
@@ -766,8 +782,9 @@ static void pcie_complete_dma_writes()
         int status;
 
         // The only task required here is to consume the response from the
-        // application. The response indicates whether the address was
-        // valid.  Raise an error for invalid addresses.
+        // application. Responses are sent only for invalid addresses and
+        // as watermarks that acknowledge a group of writes. Raise an error
+        // for invalid addresses.
 
         status = mqueue_recv(app2sim_membus_wr_rsp_rx, (char *) &wr_rsp, sizeof(wr_rsp));
 
@@ -779,7 +796,7 @@ static void pcie_complete_dma_writes()
                 break;
             }
 
-            num_dma_writes_pending -= 1;
+            num_dma_writes_pending -= ase_wc_acked(&wr_rsp);
         }
         else
         {
@@ -892,6 +909,75 @@ static void push_new_read_cpl(t_dma_read_cpl *read_cpl)
 }
 
 
+//
+// Queue the completion packets for a DMA read response. The data is
+// already in read_rsp_data[tag].
+//
+static void pcie_push_dma_read_rsp(uint32_t tag)
+{
+    // Push the read on the list of pending PCIe completions
+    t_dma_read_state *rd_state = &dma_read_state[tag];
+    const t_tlp_hdr_upk *req_hdr = &rd_state->req_hdr;
+
+    //
+    // If the read response is large then it might be broken apart into
+    // multiple response packets. Simulate that, randomizing the size
+    // decisions.
+    //
+
+    // Total DWORD length of the response
+    uint32_t length_rem = req_hdr->dw0.length;
+    // Total bytes of the response, accounting for masks
+    uint32_t byte_count_rem =
+        pcie_cpl_byte_count(length_rem,
+                            req_hdr->u.mem.first_be,
+                            req_hdr->u.mem.last_be);
+    // Offset of the read data for the current packet
+    uint32_t start_dw = 0;
+
+    // Loop until the entire payload has completion packets
+    do
+    {
+        t_dma_read_cpl *read_cpl = ase_pool_alloc(&dma_read_cpl_pool);
+        read_cpl->state = rd_state;
+
+        // Pick a random length, between the request completion
+        // boundary and the total payload size.
+        uint32_t this_length = random_cpl_length(length_rem);
+
+        bool is_first = (start_dw == 0);
+        bool is_last = (this_length == length_rem);
+
+        read_cpl->length = this_length;
+        read_cpl->start_dw = start_dw;
+        // PCIe expects the total remaining byte count for this and all
+        // future packets for the original request as "byte_count".
+        read_cpl->byte_count = byte_count_rem;
+        read_cpl->is_first = is_first;
+        read_cpl->is_last = is_last;
+
+        // Push this completion on the list of pending messages
+        push_new_read_cpl(read_cpl);
+
+        // Subtract the length of the current completion from the total
+        byte_count_rem = byte_count_rem -
+            pcie_cpl_byte_count(this_length,
+                                is_first ? req_hdr->u.mem.first_be : 0xf,
+                                is_last ? req_hdr->u.mem.last_be : 0xf);
+        length_rem -= this_length;
+        start_dw += this_length;
+
+        // Check the algorithm -- is_last implies no remaining data.
+        assert((length_rem == 0) == is_last);
+    }
+    while (length_rem > 0);
+
+    // The algorithm above is broken if this assertion fails. All
+    // bytes should have been handled.
+    assert(byte_count_rem == 0);
+}
+
+
 static void pcie_receive_dma_reads()
 {
     while (num_dma_reads_pending)
@@ -922,66 +1008,7 @@ static void pcie_receive_dma_reads()
 
             num_dma_reads_pending -= 1;
 
-            // Push the read on the list of pending PCIe completions
-            t_dma_read_state *rd_state = &dma_read_state[rd_rsp.tag];
-            const t_tlp_hdr_upk *req_hdr = &rd_state->req_hdr;
-
-            //
-            // If the read response is large then it might be broken apart into
-            // multiple response packets. Simulate that, randomizing the size
-            // decisions.
-            //
-
-            // Total DWORD length of the response
-            uint32_t length_rem = req_hdr->dw0.length;
-            // Total bytes of the response, accounting for masks
-            uint32_t byte_count_rem =
-                pcie_cpl_byte_count(length_rem,
-                                    req_hdr->u.mem.first_be,
-                                    req_hdr->u.mem.last_be);
-            // Offset of the read data for the current packet
-            uint32_t start_dw = 0;
-
-            // Loop until the entire payload has completion packets
-            do
-            {
-                t_dma_read_cpl *read_cpl = ase_malloc(sizeof(t_dma_read_cpl));
-                read_cpl->state = rd_state;
-
-                // Pick a random length, between the request completion
-                // boundary and the total payload size.
-                uint32_t this_length = random_cpl_length(length_rem);
-
-                bool is_first = (start_dw == 0);
-                bool is_last = (this_length == length_rem);
-
-                read_cpl->length = this_length;
-                read_cpl->start_dw = start_dw;
-                // PCIe expects the total remaining byte count for this and all
-                // future packets for the original request as "byte_count".
-                read_cpl->byte_count = byte_count_rem;
-                read_cpl->is_first = is_first;
-                read_cpl->is_last = is_last;
-
-                // Push this completion on the list of pending messages
-                push_new_read_cpl(read_cpl);
-
-                // Subtract the length of the current completion from the total
-                byte_count_rem = byte_count_rem -
-                    pcie_cpl_byte_count(this_length,
-                                        is_first ? req_hdr->u.mem.first_be : 0xf,
-                                        is_last ? req_hdr->u.mem.last_be : 0xf);
-                length_rem -= this_length;
-                start_dw += this_length;
-
-                // Check the algorithm -- is_last implies no remaining data.
-                assert((length_rem == 0) == is_last);
-            }
-            while (length_rem > 0);
-
-            // The algorithm above is broken if this assertion fails. All
-            // bytes should have been handled.
-            assert(byte_count_rem == 0);
+            pcie_push_dma_read_rsp(rd_rsp.tag);
         }
         else if (status != ASE_MSG_ABSENT)
         {
@@ -1052,6 +1079,7 @@ typedef struct mmio_list
 
 static t_mmio_list *mmio_req_head;
 static t_mmio_list *mmio_req_tail;
+static ase_pool_t mmio_req_pool;
 
 //
 // Push a new MMIO request on the processing list.
@@ -1075,7 +1103,7 @@ void pcie_mmio_new_req(const mmio_t *pkt)
     }
 
     // Allocate a request
-    t_mmio_list *m = ase_malloc(sizeof(t_mmio_list));
+    t_mmio_list *m = ase_pool_alloc(&mmio_req_pool);
     memcpy(&m->mmio_pkt, pkt, sizeof(mmio_t));
 
     // Push it on the tail of the list
@@ -1209,15 +1237,15 @@ static bool pcie_tlp_h2a_mem(
 
             // Copy the next data group to the channel
             const uint32_t *req_data = (const uint32_t *)mmio_pkt->qword;
-            for (int i = 0; i < req_dw; i += 1)
-            {
-                svPutPartselBit(tdata->payload, req_data[start_dw + i], i*32, 32);
-            }
+            ase_dpi_put_dwords(tdata->payload, 0, &req_data[start_dw], req_dw);
 
             mmio_req_dw_rem -= req_dw;
         }
 
-        fprintf_tlp_host_to_afu(logfile, cycle, ch, &hdr, tdata, tuser);
+        if (trace)
+            trace_tlp_beat(trace, false, cycle, ch, &hdr, tdata, false);
+        else
+            fprintf_tlp_host_to_afu(logfile, cycle, ch, &hdr, tdata, tuser);
     }
 
     // Pop request
@@ -1229,7 +1257,7 @@ static bool pcie_tlp_h2a_mem(
         {
             mmio_req_tail = NULL;
         }
-        free(m);
+        ase_pool_free(&mmio_req_pool, m);
     }
 
     return !tdata->valid || tdata->eop;
@@ -1319,14 +1347,14 @@ static bool pcie_tlp_h2a_cpld(
 
         // Copy the next data group to the channel
         const uint32_t *rsp_data = read_rsp_data[req_hdr->u.mem.tag];
-        for (int i = 0; i < rsp_dw; i += 1)
-        {
-            svPutPartselBit(tdata->payload, rsp_data[start_dw + i], i*32, 32);
-        }
+        ase_dpi_put_dwords(tdata->payload, 0, &rsp_data[start_dw], rsp_dw);
 
         dma_read_cpl_dw_rem -= rsp_dw;
 
-        fprintf_tlp_host_to_afu(logfile, cycle, ch, &hdr, tdata, tuser);
+        if (trace)
+            trace_tlp_beat(trace, false, cycle, ch, &hdr, tdata, false);
+        else
+            fprintf_tlp_host_to_afu(logfile, cycle, ch, &hdr, tdata, tuser);
     }
 
     // Pop request
@@ -1349,7 +1377,7 @@ static bool pcie_tlp_h2a_cpld(
             dma_read_cpl_head->prev = NULL;
         }
 
-        free(dma_cpl);
+        ase_pool_free(&dma_read_cpl_pool, dma_cpl);
     }
 
     return !tdata->valid || tdata->eop;
@@ -1387,10 +1415,18 @@ int pcie_param_init(const t_ase_axis_param_cfg *params)
     while (dma_read_cpl_head)
     {
         t_dma_read_cpl *read_cpl_next = dma_read_cpl_head->next;
-        free(dma_read_cpl_head);
+        ase_pool_free(&dma_read_cpl_pool, dma_read_cpl_head);
         dma_read_cpl_head = read_cpl_next;
     }
     dma_read_cpl_tail = NULL;
+
+    // Reads may be split into several completions. The pools grow if
+    // the estimates are low.
+    ase_pool_init(&dma_read_cpl_pool, sizeof(t_dma_read_cpl),
+                  4 * param_cfg.max_outstanding_dma_rd_reqs);
+    ase_pool_init(&mmio_req_pool, sizeof(t_mmio_list),
+                  2 * param_cfg.max_outstanding_mmio_rd_reqs);
+
     uint64_t dma_state_size = sizeof(t_dma_read_state) *
                               param_cfg.max_outstanding_dma_rd_reqs;
     dma_read_state = ase_malloc(dma_state_size);
@@ -1431,6 +1467,9 @@ int pcie_tlp_reset()
     if (!in_reset)
     {
         in_reset = true;
+
+        // Writes issued by the AFU before reset still reach memory
+        num_dma_writes_pending += ase_wc_flush();
     }
 
     afu_to_host_state = TLP_STATE_NONE;
@@ -1459,6 +1498,9 @@ int pcie_tlp_stream_host_to_afu_ch(
     // Receive pending memory responses from the remote memory model
     if (ch == 0)
     {
+        // Send a combined DMA write whose window has expired
+        num_dma_writes_pending += ase_wc_tick(cycle);
+
         pcie_complete_dma_writes();
         pcie_receive_dma_reads();
     }
@@ -1515,7 +1557,10 @@ int pcie_tlp_stream_afu_to_host_ch(
     t_tlp_hdr_upk hdr;
     tlp_hdr_unpack(&hdr, tdata->hdr, tuser);
 
-    fprintf_tlp_afu_to_host(logfile, cycle, ch, &hdr, tdata, tuser);
+    if (trace)
+        trace_tlp_beat(trace, true, cycle, ch, &hdr, tdata, tuser->afu_irq);
+    else
+        fprintf_tlp_afu_to_host(logfile, cycle, ch, &hdr, tdata, tuser);
 
     switch (afu_to_host_state)
     {
@@ -1526,7 +1571,15 @@ int pcie_tlp_stream_afu_to_host_ch(
             pcie_tlp_a2h_error_and_kill(cycle, ch, &hdr, tdata, tuser);
             return 0;
         }
-        
+
+        // Only DMA writes may pass a write held for combining. Interrupts,
+        // completions and reads are ordered after it.
+        if (tuser->afu_irq || !tlp_func_is_mem_req(hdr.dw0.fmttype) ||
+            !tlp_func_is_mwr_req(hdr.dw0.fmttype))
+        {
+            num_dma_writes_pending += ase_wc_flush();
+        }
+
         if (tuser->afu_irq)
         {
             pcie_tlp_a2h_interrupt(cycle, ch, &hdr, tdata, tuser);
@@ -1639,7 +1692,10 @@ int pcie_host_to_afu_irq_rsp(
     // Random delay
     if ((pcie_tlp_rand() & 0xff) > 0xc0) return 0;
 
-    fprintf(logfile, "host_to_afu: %lld irq_id %d\n", cycle, interrupt_rsp_head);
+    if (trace)
+        trace_tlp_irq_rsp(trace, cycle, interrupt_rsp_head);
+    else
+        fprintf(logfile, "host_to_afu: %lld irq_id %d\n", cycle, interrupt_rsp_head);
 
     // Ready to trigger the interrupt and response
     ase_interrupt_generator(interrupt_rsp_head);
@@ -1666,7 +1722,13 @@ int pcie_tlp_open_logfile(
     const char *logname
 )
 {
-    logfile = fopen(logname, "w");
+    if (ase_trace_enabled())
+    {
+        trace = ase_trace_open(logname, ASE_TRACE_FMT_PCIE_EA);
+        if (trace) return 0;
+    }
+
+    logfile = ase_log_fopen(logname);
     if (logfile == NULL)
     {
         fprintf(stderr, "Failed to open log file: %s\n", logname);
@@ -1682,6 +1744,12 @@ int pcie_tlp_write_logfile(
     const char *msg
 )
 {
+    if (trace)
+    {
+        ase_trace_text(trace, msg);
+        return 0;
+    }
+
     fprintf(logfile, "%s", msg);
     fflush(logfile);
     return 0;
@@ -32,6 +32,7 @@
 #define _PCIE_TLP_STREAM_H_
 
 #include "ase_common.h"
+#include "ase_trace.h"
 #include "pcie_tlp_func.h"
 
 
@@ -227,4 +228,23 @@ void fprintf_tlp_host_to_afu(
     const t_ase_axis_pcie_rx_tuser *tuser
 );
 
+// Binary trace equivalents of fprintf_tlp_{afu_to_host,host_to_afu}().
+// An AFU interrupt request is traced when afu_irq is set.
+void trace_tlp_beat(
+    ase_trace_t *trace,
+    bool afu_to_host,
+    long long cycle,
+    int ch,
+    const t_tlp_hdr_upk *hdr,
+    const t_ase_axis_pcie_tdata *tdata,
+    bool afu_irq
+);
+
+// Interrupt response to the AFU
+void trace_tlp_irq_rsp(
+    ase_trace_t *trace,
+    long long cycle,
+    int irq_id
+);
+
 #endif // _PCIE_TLP_STREAM_H_
@@ -26,6 +26,7 @@
 // **************************************************************************
 
 #include "ase_common.h"
+#include "ase_log.h"
 
 // -----------------------------------------------------------------------
 // ASE error report : Prints a verbose report on catastrophic errors
@@ -157,5 +158,10 @@ void backtrace_handler(int sig)
 		}
 	}
 
+#ifdef SIM_SIDE
+	// Write out log records still queued for the log writer
+	ase_log_drain();
+#endif
+
 	ase_exit();
 }
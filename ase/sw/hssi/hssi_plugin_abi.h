@@ -0,0 +1,114 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+
+//
+// HSSI channel plugin ABI.
+//
+// The HSSI emulator loads a plugin for each channel with dlopen(). The
+// library named by HSSI_PLUGIN (all channels) or HSSI_PLUGIN_CHAN<n>
+// (channel n) in ase.cfg is used, otherwise libhssi_plugin.so, built
+// from loopback_plugin.c or ASE_HSSI_PLUGIN_PATH.
+//
+// A plugin exports hssi_plugin_entry(), which returns its operations for
+// the ABI version the emulator speaks, or NULL if it can't support it.
+// Plugins exchange beats in batches: the emulator pulls up to max_beats
+// host->AFU beats at a time and hands AFU->host beats over a frame (or
+// a full batch) at a time. A plugin with nothing to send reports when
+// it next may, so idle channels cost no plugin calls.
+//
+// This header is self-contained so plugins can be built outside ASE.
+// Plugins written against the older hssi_plugin_api.h are still loaded,
+// one beat per call.
+//
+
+#ifndef _HSSI_PLUGIN_ABI_H_
+#define _HSSI_PLUGIN_ABI_H_
+
+#include <stdint.h>
+
+#define HSSI_PLUGIN_ABI_VERSION     1
+#define HSSI_PLUGIN_ENTRY_SYM       "hssi_plugin_entry"
+
+// Returned in *next_cycle by an idle plugin that has nothing to send
+// until it is handed more AFU->host beats
+#define HSSI_PLUGIN_IDLE_UNTIL_TX   INT64_MAX
+
+// hssi_plugin_beat_t flags
+#define HSSI_BEAT_TLAST             0x1
+
+//
+// One beat of an AXI-S HSSI stream. Buffers are owned by the emulator
+// and sized by the channel's hssi_plugin_chan_cfg_t.
+//
+typedef struct {
+	uint32_t flags;
+	uint32_t rsvd;
+	void *tdata;
+	void *tuser;
+	void *tkeep;
+} hssi_plugin_beat_t;
+
+typedef struct {
+	uint32_t abi_version;
+	int chan;
+	uint32_t tdata_bytes;
+	uint32_t tuser_bytes;
+	uint32_t tkeep_bytes;
+	// Largest batch passed to rx() and tx()
+	uint32_t max_beats;
+} hssi_plugin_chan_cfg_t;
+
+typedef struct {
+	uint32_t abi_version;
+
+	// Bind a channel. Returns the channel's context or NULL on error.
+	void *(*open)(const hssi_plugin_chan_cfg_t *cfg);
+
+	// Channel reset. Drop anything in flight.
+	void (*reset)(void *ctx);
+
+	// Fill up to max_beats host->AFU beats, sent one per cycle starting
+	// at "cycle". Returns the number filled or < 0 on error. When it
+	// returns 0 the plugin may set *next_cycle (default cycle + 1) to
+	// the first cycle it should be called again. The emulator calls
+	// sooner when tx() hands it new beats.
+	int (*rx)(void *ctx, int64_t cycle, hssi_plugin_beat_t *beats,
+		  int max_beats, int64_t *next_cycle);
+
+	// Consume n_beats AFU->host beats. Returns 0 or < 0 on error.
+	int (*tx)(void *ctx, int64_t cycle, const hssi_plugin_beat_t *beats,
+		  int n_beats);
+
+	// Release the channel's context
+	void (*close)(void *ctx);
+} hssi_plugin_ops_t;
+
+typedef const hssi_plugin_ops_t *(*hssi_plugin_entry_fn)(uint32_t abi_version);
+
+const hssi_plugin_ops_t *hssi_plugin_entry(uint32_t abi_version);
+
+#endif // _HSSI_PLUGIN_ABI_H_
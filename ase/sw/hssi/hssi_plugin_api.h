@@ -1,3 +1,10 @@
+//
+// Original HSSI plugin API: one call per channel per cycle, one plugin
+// for all channels. New plugins should use hssi_plugin_abi.h. Plugins
+// exporting these functions instead of hssi_plugin_entry() are still
+// loaded through an adapter in hssi_stream.c.
+//
+
 #ifndef _HSSI_PLUGIN_API_H_
 #define _HSSI_PLUGIN_API_H_
 
@@ -29,9 +29,17 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include <assert.h>
+#include <dlfcn.h>
 
+#include "ase_log.h"
 #include "hssi_stream.h"
-#include "hssi_plugin_api.h"
+#include "hssi_plugin_abi.h"
+
+// Plugin used by channels not named in ase.cfg, in the work directory
+#define HSSI_DEFAULT_PLUGIN "libhssi_plugin.so"
+
+// Beats per plugin call
+#define HSSI_PLUGIN_MAX_BEATS 64
 
 static FILE *logfile;
 
@@ -39,6 +47,35 @@ static bool in_reset[MAX_CHANNELS];
 
 t_ase_hssi_param_cfg hssi_param_cfg;
 
+//
+// Channel state. Host->AFU beats from the plugin are queued in rx_beats
+// and sent one per cycle. AFU->host beats collect in tx_beats until the
+// end of a frame or a full batch.
+//
+typedef struct {
+    bool loaded;
+    void *dl_handle;
+    const hssi_plugin_ops_t *ops;
+    void *ctx;
+    int max_beats;
+
+    hssi_plugin_beat_t rx_beats[HSSI_PLUGIN_MAX_BEATS];
+    int rx_head;
+    int rx_count;
+    // Don't call the plugin's rx() before this cycle
+    long long rx_next_cycle;
+
+    hssi_plugin_beat_t tx_beats[HSSI_PLUGIN_MAX_BEATS];
+    int tx_count;
+} t_hssi_chan;
+
+static t_hssi_chan hssi_chan[MAX_CHANNELS];
+
+// svBitVecVal sizes of the stream's fields
+static uint32_t tdata_bytes;
+static uint32_t tuser_bytes;
+static uint32_t tkeep_bytes;
+
 // ========================================================================
 //
 //  Utilities
@@ -89,8 +126,7 @@ static void fprintf_hssi_bitvec(FILE *stream, const svBitVecVal *payload, int n_
     fprintf(stream, "0x");
     for (int i = n_dwords - 1; i >= 0; i -= 1)
     {
-        uint32_t dw;
-        svGetPartselBit(&dw, payload, i * 32, 32);
+        uint32_t dw = payload[i];
         if ((i & 1) && (i != n_dwords - 1)) fprintf(stream, "_");
         fprintf(stream, "%0*x", width, dw);
     }
@@ -138,6 +174,232 @@ void fprintf_hssi_host_to_afu(
     fflush(stream);
 }
 
+// ========================================================================
+//
+//  Plugins
+//
+// ========================================================================
+
+//
+// Adapter for plugins written to the original per-cycle API in
+// hssi_plugin_api.h. They take one beat per call.
+//
+typedef void (*t_legacy_reset)(int chan);
+typedef int (*t_legacy_set_next_rx)(long long cycle, int chan, int *tvalid, int *tlast,
+                                    svBitVecVal *tdata, svBitVecVal *tuser, svBitVecVal *tkeep);
+typedef int (*t_legacy_get_next_tx)(long long cycle, int chan, int tvalid, int tlast,
+                                    const svBitVecVal *tdata, const svBitVecVal *tuser,
+                                    const svBitVecVal *tkeep);
+
+typedef struct {
+    int chan;
+    t_legacy_reset reset;
+    t_legacy_set_next_rx set_next_rx;
+    t_legacy_get_next_tx get_next_tx;
+} t_legacy_plugin;
+
+static void *legacy_open(const hssi_plugin_chan_cfg_t *cfg)
+{
+    // The handle is stashed in the channel before open() is called
+    void *dl_handle = hssi_chan[cfg->chan].dl_handle;
+    t_legacy_plugin *lp = ase_malloc(sizeof(t_legacy_plugin));
+
+    lp->chan = cfg->chan;
+    lp->reset = (t_legacy_reset)dlsym(dl_handle, "hssi_plugin_reset");
+    lp->set_next_rx = (t_legacy_set_next_rx)dlsym(dl_handle, "hssi_plugin_set_next_rx");
+    lp->get_next_tx = (t_legacy_get_next_tx)dlsym(dl_handle, "hssi_plugin_get_next_tx");
+    if (!lp->reset || !lp->set_next_rx || !lp->get_next_tx)
+    {
+        free(lp);
+        return NULL;
+    }
+
+    return lp;
+}
+
+static void legacy_reset(void *ctx)
+{
+    t_legacy_plugin *lp = ctx;
+    lp->reset(lp->chan);
+}
+
+static int legacy_rx(void *ctx, int64_t cycle, hssi_plugin_beat_t *beats,
+                     int max_beats, int64_t *next_cycle)
+{
+    UNUSED_PARAM(max_beats);
+    UNUSED_PARAM(next_cycle);
+
+    t_legacy_plugin *lp = ctx;
+    int tvalid = 0;
+    int tlast = 0;
+
+    lp->set_next_rx(cycle, lp->chan, &tvalid, &tlast,
+                    beats[0].tdata, beats[0].tuser, beats[0].tkeep);
+    beats[0].flags = (tlast ? HSSI_BEAT_TLAST : 0);
+    return tvalid ? 1 : 0;
+}
+
+static int legacy_tx(void *ctx, int64_t cycle, const hssi_plugin_beat_t *beats,
+                     int n_beats)
+{
+    t_legacy_plugin *lp = ctx;
+
+    for (int i = 0; i < n_beats; i += 1)
+    {
+        lp->get_next_tx(cycle, lp->chan, 1, (beats[i].flags & HSSI_BEAT_TLAST) ? 1 : 0,
+                        beats[i].tdata, beats[i].tuser, beats[i].tkeep);
+    }
+    return 0;
+}
+
+static const hssi_plugin_ops_t legacy_ops = {
+    .abi_version = HSSI_PLUGIN_ABI_VERSION,
+    .open = legacy_open,
+    .reset = legacy_reset,
+    .rx = legacy_rx,
+    .tx = legacy_tx,
+    .close = free
+};
+
+static void alloc_beats(hssi_plugin_beat_t *beats)
+{
+    for (int i = 0; i < HSSI_PLUGIN_MAX_BEATS; i += 1)
+    {
+        beats[i].tdata = ase_malloc(tdata_bytes);
+        beats[i].tuser = ase_malloc(tuser_bytes);
+        beats[i].tkeep = ase_malloc(tkeep_bytes);
+    }
+}
+
+static void free_beats(hssi_plugin_beat_t *beats)
+{
+    for (int i = 0; i < HSSI_PLUGIN_MAX_BEATS; i += 1)
+    {
+        free(beats[i].tdata);
+        free(beats[i].tuser);
+        free(beats[i].tkeep);
+    }
+}
+
+//
+// Load a channel's plugin, on first use
+//
+static t_hssi_chan *hssi_chan_get(int chan)
+{
+    t_hssi_chan *c = &hssi_chan[chan];
+    hssi_plugin_entry_fn entry;
+    hssi_plugin_chan_cfg_t cfg;
+    char default_path[ASE_FILEPATH_LEN];
+    const char *path;
+
+    if (c->loaded)
+        return c;
+    c->loaded = true;
+
+    tdata_bytes = ((hssi_param_cfg.tdata_width_bits + 31) / 32) * 4;
+    tuser_bytes = ((hssi_param_cfg.tuser_width_bits + 31) / 32) * 4;
+    tkeep_bytes = ((hssi_param_cfg.tdata_width_bits / 8 + 31) / 32) * 4;
+
+    path = hssi_plugin_path[chan];
+    if (!path)
+    {
+        // Built by sw_build in the simulator's work directory
+        snprintf(default_path, ASE_FILEPATH_LEN, "%s/%s",
+                 ase_workdir_path ? ase_workdir_path : ".", HSSI_DEFAULT_PLUGIN);
+        path = default_path;
+    }
+    c->dl_handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!c->dl_handle)
+    {
+        hssi_error_and_kill("HSSI chan[%d]: failed to load plugin: %s\n", chan, dlerror());
+        return NULL;
+    }
+
+    c->max_beats = HSSI_PLUGIN_MAX_BEATS;
+    entry = (hssi_plugin_entry_fn)dlsym(c->dl_handle, HSSI_PLUGIN_ENTRY_SYM);
+    if (entry)
+    {
+        c->ops = entry(HSSI_PLUGIN_ABI_VERSION);
+        if (!c->ops || (c->ops->abi_version != HSSI_PLUGIN_ABI_VERSION))
+        {
+            hssi_error_and_kill("HSSI chan[%d]: %s does not support plugin ABI version %d\n",
+                                chan, path, HSSI_PLUGIN_ABI_VERSION);
+            return NULL;
+        }
+    }
+    else
+    {
+        // Original per-cycle API
+        c->ops = &legacy_ops;
+        c->max_beats = 1;
+    }
+
+    cfg.abi_version = HSSI_PLUGIN_ABI_VERSION;
+    cfg.chan = chan;
+    cfg.tdata_bytes = tdata_bytes;
+    cfg.tuser_bytes = tuser_bytes;
+    cfg.tkeep_bytes = tkeep_bytes;
+    cfg.max_beats = c->max_beats;
+
+    c->ctx = c->ops->open(&cfg);
+    if (!c->ctx)
+    {
+        hssi_error_and_kill("HSSI chan[%d]: plugin %s failed to open the channel\n", chan, path);
+        c->ops = NULL;
+        return NULL;
+    }
+
+    alloc_beats(c->rx_beats);
+    alloc_beats(c->tx_beats);
+
+    ASE_INFO_2("HSSI chan[%d]: plugin %s\n", chan, path);
+    return c;
+}
+
+//
+// Close each channel's plugin and unload it. Called at the end of the
+// simulation.
+//
+void hssi_plugins_close(void)
+{
+    for (int chan = 0; chan < MAX_CHANNELS; chan += 1)
+    {
+        t_hssi_chan *c = &hssi_chan[chan];
+
+        if (c->ops && c->ctx)
+        {
+            c->ops->close(c->ctx);
+            free_beats(c->rx_beats);
+            free_beats(c->tx_beats);
+        }
+
+        if (c->dl_handle)
+            dlclose(c->dl_handle);
+
+        // Calls made while the simulator shuts down find no plugin
+        memset(c, 0, sizeof(*c));
+        c->loaded = true;
+    }
+}
+
+//
+// Hand queued AFU->host beats to the plugin
+//
+static void hssi_flush_tx(t_hssi_chan *c, long long cycle, int chan)
+{
+    if (c->tx_count == 0)
+        return;
+
+    if (c->ops->tx(c->ctx, cycle, c->tx_beats, c->tx_count) < 0)
+    {
+        hssi_error_and_kill("HSSI chan[%d]: plugin TX error\n", chan);
+    }
+    c->tx_count = 0;
+
+    // The plugin may have something to send now
+    c->rx_next_cycle = 0;
+}
+
 // ========================================================================
 //
 //  DPI-C methods that communicate with the SystemVerilog simulation
@@ -153,6 +415,8 @@ int hssi_param_init(const t_ase_hssi_param_cfg *params)
                                                        
 int hssi_reset(int chan)
 {
+    t_hssi_chan *c;
+
     if (chan >= MAX_CHANNELS)
         return 0;
     
@@ -163,15 +427,24 @@ int hssi_reset(int chan)
         return 0;
     }
 
-    hssi_plugin_reset(chan);
+    c = hssi_chan_get(chan);
+    if (!c || !c->ops)
+        return 0;
+
+    c->rx_head = 0;
+    c->rx_count = 0;
+    c->rx_next_cycle = 0;
+    c->tx_count = 0;
+    c->ops->reset(c->ctx);
     return 0;
 }
                                                        
 //
-// Get a host->AFU HSSI message for a single channel. Called once per
-// cycle via DPI-C for each HSSI channel.
+// Get a host->AFU HSSI message for a single channel. Called via DPI-C
+// for each HSSI channel, no earlier than the cycle returned by the
+// previous call unless AFU->host data arrived since then.
 //
-int hssi_stream_host_to_afu(
+long long hssi_stream_host_to_afu(
     long long cycle,
     int chan,
     int *tvalid,
@@ -181,18 +454,53 @@ int hssi_stream_host_to_afu(
     svBitVecVal *tkeep
 )
 {
-    if (chan >= MAX_CHANNELS) {
-        *tvalid = 0;
-        return 0;
-    }
+    t_hssi_chan *c;
+    int64_t next_cycle;
+    int n;
+
+    *tvalid = 0;
+    if (chan >= MAX_CHANNELS)
+        return HSSI_PLUGIN_IDLE_UNTIL_TX;
     in_reset[chan] = false;
 
-    hssi_plugin_set_next_rx(cycle, chan, tvalid, tlast, tdata, tuser, tkeep);
+    c = hssi_chan_get(chan);
+    if (!c || !c->ops)
+        return HSSI_PLUGIN_IDLE_UNTIL_TX;
+
+    // Refill the queue from the plugin, unless it said it is idle
+    if ((c->rx_count == 0) && (cycle >= c->rx_next_cycle))
+    {
+        next_cycle = cycle + 1;
+        n = c->ops->rx(c->ctx, cycle, c->rx_beats, c->max_beats, &next_cycle);
+        if (n < 0)
+        {
+            hssi_error_and_kill("HSSI chan[%d]: plugin RX error\n", chan);
+            n = 0;
+        }
+
+        c->rx_head = 0;
+        c->rx_count = n;
+        c->rx_next_cycle = n ? 0 : next_cycle;
+    }
+
+    if (c->rx_count)
+    {
+        hssi_plugin_beat_t *b = &c->rx_beats[c->rx_head];
+
+        *tvalid = 1;
+        *tlast = (b->flags & HSSI_BEAT_TLAST) ? 1 : 0;
+        memcpy(tdata, b->tdata, tdata_bytes);
+        memcpy(tuser, b->tuser, tuser_bytes);
+        memcpy(tkeep, b->tkeep, tkeep_bytes);
+        c->rx_head += 1;
+        c->rx_count -= 1;
 
-    if (*tvalid)
         fprintf_hssi_host_to_afu(logfile, cycle, chan, *tlast, tdata, tuser, tkeep);
+    }
 
-    return 0;
+    if (c->rx_count || (c->rx_next_cycle <= cycle))
+        return cycle + 1;
+    return c->rx_next_cycle;
 }
 
 //
@@ -209,12 +517,27 @@ int hssi_stream_afu_to_host(
     const svBitVecVal *tkeep
 )
 {
+    t_hssi_chan *c;
+    hssi_plugin_beat_t *b;
+
     if (chan >= MAX_CHANNELS)
         return 0;
     if (!tvalid)
         return 0;
 
-    hssi_plugin_get_next_tx(cycle, chan, tvalid, tlast, tdata, tuser, tkeep);
+    c = hssi_chan_get(chan);
+    if (!c || !c->ops)
+        return 0;
+
+    b = &c->tx_beats[c->tx_count++];
+    b->flags = (tlast ? HSSI_BEAT_TLAST : 0);
+    memcpy(b->tdata, tdata, tdata_bytes);
+    memcpy(b->tuser, tuser, tuser_bytes);
+    memcpy(b->tkeep, tkeep, tkeep_bytes);
+
+    // Pass whole frames to the plugin
+    if (tlast || (c->tx_count == c->max_beats))
+        hssi_flush_tx(c, cycle, chan);
 
     fprintf_hssi_afu_to_host(logfile, cycle, chan, tlast, tdata, tuser, tkeep);
 
@@ -242,7 +565,7 @@ int hssi_open_logfile(
     const char *logname
 )
 {
-    logfile = fopen(logname, "w");
+    logfile = ase_log_fopen(logname);
     if (logfile == NULL)
     {
         fprintf(stderr, "Failed to open log file: %s\n", logname);
@@ -33,7 +33,7 @@
 
 #include "ase_common.h"
 
-#define MAX_CHANNELS 16
+#define MAX_CHANNELS ASE_HSSI_MAX_CHANNELS
 
 #define hssi_error_and_kill(format, ...) { \
     ASE_ERR(format, __VA_ARGS__); \
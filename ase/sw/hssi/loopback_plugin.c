@@ -1,9 +1,15 @@
-#include "hssi_plugin_api.h"
-#include "hssi_stream.h"
+#include <stdlib.h>
+#include <string.h>
 
-// Since RX HSSI ignores in ready we can always send data
-// => realistically we only need a FIFO of size 2
-#define LOOPBACK_FIFO_SIZE 4
+#include "hssi_plugin_abi.h"
+
+// Plugins are built without ase_common.h
+#ifndef UNUSED_PARAM
+#define UNUSED_PARAM(x) ((void)x)
+#endif
+
+// Initial FIFO size, in beats. The FIFO grows when TX gets ahead of RX.
+#define LOOPBACK_FIFO_SIZE 64
 
 // ========================================================================
 //
@@ -12,31 +18,87 @@
 // ========================================================================
 
 //
-// Context for each chanel
+// Context for each channel. Beats arriving on TX are queued in a FIFO
+// and returned in order on RX.
 //
-typedef struct hssi_chan_context_s
+typedef struct
+{
+    hssi_plugin_chan_cfg_t cfg;
+
+    // Each FIFO slot holds tdata, tuser and tkeep, back to back
+    uint32_t slot_bytes;
+    char *data_fifo;
+    uint32_t *flags_fifo;
+    uint32_t size;
+    uint32_t sptr;
+    uint32_t count;
+} loopback_chan_t;
+
+static char *slot_data(loopback_chan_t *lb, uint32_t i)
 {
-    // FIFOs with data
-    // FIFOs are filled via TX and read by RX
-    int tlast_fifo[LOOPBACK_FIFO_SIZE];
-    char *tdata_fifo[LOOPBACK_FIFO_SIZE];
-    char *tuser_fifo[LOOPBACK_FIFO_SIZE];
-    char *tkeep_fifo[LOOPBACK_FIFO_SIZE];
-    int sptr, eptr;
-} hssi_chan_context_t;
-
-hssi_chan_context_t chan_context[MAX_CHANNELS];
-
-void hssi_plugin_reset(int chan)
+    return lb->data_fifo + (size_t)(i % lb->size) * lb->slot_bytes;
+}
+
+static int fifo_alloc(loopback_chan_t *lb, uint32_t size)
+{
+    char *data = malloc((size_t)size * lb->slot_bytes);
+    uint32_t *flags = malloc(size * sizeof(uint32_t));
+
+    if (!data || !flags)
+    {
+        free(data);
+        free(flags);
+        return -1;
+    }
+
+    // Move queued beats to the start of the new FIFO
+    for (uint32_t i = 0; i < lb->count; i += 1)
+    {
+        memcpy(data + (size_t)i * lb->slot_bytes, slot_data(lb, lb->sptr + i), lb->slot_bytes);
+        flags[i] = lb->flags_fifo[(lb->sptr + i) % lb->size];
+    }
+
+    free(lb->data_fifo);
+    free(lb->flags_fifo);
+    lb->data_fifo = data;
+    lb->flags_fifo = flags;
+    lb->size = size;
+    lb->sptr = 0;
+    return 0;
+}
+
+static void *loopback_open(const hssi_plugin_chan_cfg_t *cfg)
 {
-    for (int i=0; i<LOOPBACK_FIFO_SIZE; i++) {
-        chan_context[chan].tlast_fifo[i] = 0;
-        chan_context[chan].tdata_fifo[i] = (char *)ase_malloc(hssi_param_cfg.tdata_width_bits/8);
-        chan_context[chan].tuser_fifo[i] = (char *)ase_malloc(hssi_param_cfg.tuser_width_bits/8);
-        chan_context[chan].tkeep_fifo[i] = (char *)ase_malloc(hssi_param_cfg.tdata_width_bits/(8*8));
+    loopback_chan_t *lb = calloc(1, sizeof(loopback_chan_t));
+    if (!lb)
+        return NULL;
+
+    lb->cfg = *cfg;
+    lb->slot_bytes = cfg->tdata_bytes + cfg->tuser_bytes + cfg->tkeep_bytes;
+    if (fifo_alloc(lb, LOOPBACK_FIFO_SIZE))
+    {
+        free(lb);
+        return NULL;
     }
-    chan_context[chan].sptr = 0;
-    chan_context[chan].eptr = 0;
+
+    return lb;
+}
+
+static void loopback_reset(void *ctx)
+{
+    loopback_chan_t *lb = ctx;
+
+    lb->sptr = 0;
+    lb->count = 0;
+}
+
+static void loopback_close(void *ctx)
+{
+    loopback_chan_t *lb = ctx;
+
+    free(lb->data_fifo);
+    free(lb->flags_fifo);
+    free(lb);
 }
 
 // ========================================================================
@@ -44,34 +106,43 @@ void hssi_plugin_reset(int chan)
 //  RX side functions
 //
 // ========================================================================
-int hssi_plugin_set_next_rx(
-    long long cycle,
-    int chan,
-    int *tvalid,
-    int *tlast,
-    svBitVecVal *tdata,
-    svBitVecVal *tuser,
-    svBitVecVal *tkeep
+static int loopback_rx(
+    void *ctx,
+    int64_t cycle,
+    hssi_plugin_beat_t *beats,
+    int max_beats,
+    int64_t *next_cycle
 )
 {
-    *tvalid = 0;
+    UNUSED_PARAM(cycle);
+
+    loopback_chan_t *lb = ctx;
+    int n = 0;
 
-    // Get and update fifo start pointer
-    int i = chan_context[chan].sptr;
-    // Check empty
-    if (i == chan_context[chan].eptr)
+    // Nothing to send until more TX data arrives
+    if (lb->count == 0)
+    {
+        *next_cycle = HSSI_PLUGIN_IDLE_UNTIL_TX;
         return 0;
-    chan_context[chan].sptr = (chan_context[chan].sptr+1)%LOOPBACK_FIFO_SIZE;
+    }
 
+    while (lb->count && (n < max_beats))
+    {
+        char *p = slot_data(lb, lb->sptr);
 
-    // Get data from the FIFO
-    *tvalid = 1;
-    *tlast = chan_context[chan].tlast_fifo[i];
-    memcpy(tdata, chan_context[chan].tdata_fifo[i], hssi_param_cfg.tdata_width_bits/8);
-    memcpy(tkeep, chan_context[chan].tkeep_fifo[i], hssi_param_cfg.tdata_width_bits/(8*8));
-    memcpy(tuser, chan_context[chan].tuser_fifo[i], hssi_param_cfg.tuser_width_bits/8);
+        beats[n].flags = lb->flags_fifo[lb->sptr % lb->size];
+        memcpy(beats[n].tdata, p, lb->cfg.tdata_bytes);
+        p += lb->cfg.tdata_bytes;
+        memcpy(beats[n].tuser, p, lb->cfg.tuser_bytes);
+        p += lb->cfg.tuser_bytes;
+        memcpy(beats[n].tkeep, p, lb->cfg.tkeep_bytes);
 
-    return 0;
+        lb->sptr = (lb->sptr + 1) % lb->size;
+        lb->count -= 1;
+        n += 1;
+    }
+
+    return n;
 }
 
 // ========================================================================
@@ -79,29 +150,52 @@ int hssi_plugin_set_next_rx(
 //  TX side functions
 //
 // ========================================================================
-int hssi_plugin_get_next_tx(
-    long long cycle,
-    int chan,
-    int tvalid,
-    int tlast,
-    const svBitVecVal *tdata,
-    const svBitVecVal *tuser,
-    const svBitVecVal *tkeep
+static int loopback_tx(
+    void *ctx,
+    int64_t cycle,
+    const hssi_plugin_beat_t *beats,
+    int n_beats
 )
 {
-    if (!tvalid)
-        return 0;
-    
-    // Get and update fifo endpointer
-    int i = chan_context[chan].eptr;
-    // FIFO will never be full!
-    chan_context[chan].eptr = (chan_context[chan].eptr+1)%LOOPBACK_FIFO_SIZE;
-
-    // Store data in the FIFO
-    chan_context[chan].tlast_fifo[i] = tlast;
-    memcpy(chan_context[chan].tdata_fifo[i], tdata, hssi_param_cfg.tdata_width_bits/8);
-    memcpy(chan_context[chan].tkeep_fifo[i], tkeep, hssi_param_cfg.tdata_width_bits/(8*8));
-    memcpy(chan_context[chan].tuser_fifo[i], tuser, hssi_param_cfg.tuser_width_bits/8);
+    UNUSED_PARAM(cycle);
+
+    loopback_chan_t *lb = ctx;
+
+    if ((lb->count + n_beats > lb->size) &&
+        fifo_alloc(lb, 2 * (lb->count + n_beats)))
+        return -1;
+
+    for (int i = 0; i < n_beats; i += 1)
+    {
+        uint32_t slot = lb->sptr + lb->count;
+        char *p = slot_data(lb, slot);
+
+        lb->flags_fifo[slot % lb->size] = beats[i].flags;
+        memcpy(p, beats[i].tdata, lb->cfg.tdata_bytes);
+        p += lb->cfg.tdata_bytes;
+        memcpy(p, beats[i].tuser, lb->cfg.tuser_bytes);
+        p += lb->cfg.tuser_bytes;
+        memcpy(p, beats[i].tkeep, lb->cfg.tkeep_bytes);
+
+        lb->count += 1;
+    }
 
     return 0;
 }
+
+static const hssi_plugin_ops_t loopback_ops = {
+    .abi_version = HSSI_PLUGIN_ABI_VERSION,
+    .open = loopback_open,
+    .reset = loopback_reset,
+    .rx = loopback_rx,
+    .tx = loopback_tx,
+    .close = loopback_close
+};
+
+const hssi_plugin_ops_t *hssi_plugin_entry(uint32_t abi_version)
+{
+    if (abi_version != HSSI_PLUGIN_ABI_VERSION)
+        return NULL;
+
+    return &loopback_ops;
+}
@@ -25,7 +25,13 @@
 // POSSIBILITY OF SUCH DAMAGE.
 // **************************************************************************
 
+#include <poll.h>
+
 #include "ase_common.h"
+#include "ase_mq_ring.h"
+#ifdef SIM_SIDE
+#include "ase_mq_mux.h"
+#endif
 
 struct ipc_t mq_array[ASE_MQ_INSTANCES] = {
 	{ { "app2sim_alloc_ping_smq"    }, { 0, }, 0 },
@@ -162,6 +168,11 @@ void ipc_init(void)
 #ifdef SIM_SIDE
 	for (ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
 		unlink(mq_array[ipc_iter].path);
+
+	char ring_path[ASE_FILEPATH_LEN];
+	snprintf(ring_path, ASE_FILEPATH_LEN, "%s/%s", ase_workdir_path,
+		 ASE_MQ_RING_FILENAME);
+	unlink(ring_path);
 #endif
 
 	FUNC_CALL_EXIT;
@@ -178,6 +189,10 @@ void mqueue_create(char *mq_name_suffix)
 	char *mq_path;
 	int ret;
 
+	// Channels live in the ring segment, nothing to create
+	if (ase_mq_ring_active())
+		return;
+
 	mq_path = ase_malloc(ASE_FILEPATH_LEN);
 	snprintf(mq_path, ASE_FILEPATH_LEN, "%s/%s", ase_workdir_path,
 		 mq_name_suffix);
@@ -218,6 +233,9 @@ int mqueue_open(char *mq_name, int perm_flag)
 	int mq;
 	char *mq_path;
 
+	if (ase_mq_ring_active())
+		return ase_mq_ring_open(mq_name, perm_flag);
+
 	mq_path = ase_malloc(ASE_FILEPATH_LEN);
 	snprintf(mq_path, ASE_FILEPATH_LEN, "%s/%s", ase_workdir_path,
 		 mq_name);
@@ -268,6 +286,11 @@ void mqueue_close(int mq)
 	FUNC_CALL_ENTRY;
 
 	int ret;
+
+	// Rings are released together by ase_mq_ring_detach()
+	if (ase_mq_ring_is_handle(mq))
+		return;
+
 	ret = close(mq);
 	if (ret == -1) {
 #ifdef SIM_SIDE
@@ -289,6 +312,9 @@ void mqueue_destroy(char *mq_name_suffix)
 	char *mq_path;
 	int ret;
 
+	if (ase_mq_ring_active())
+		return;
+
 	// ASE malloc will allocate buffer, mq_path will be set correctly
 	mq_path = ase_malloc(ASE_FILEPATH_LEN);
 
@@ -321,6 +347,25 @@ void mqueue_send(int mq, const char *str, int size)
 
 	int ret_wr;
 
+	if (ase_mq_ring_is_handle(mq)) {
+		ase_mq_ring_send(mq, str, size);
+		return;
+	}
+
+	// Small messages go out in a single write, which a FIFO keeps atomic
+	// up to PIPE_BUF bytes. Threads may then share a queue without a lock.
+	if ((size >= 0) && (size + sizeof(size) <= PIPE_BUF)) {
+		char msg[PIPE_BUF];
+
+		memcpy(msg, &size, sizeof(size));
+		memcpy(msg + sizeof(size), str, size);
+		ret_wr = write(mq, (const void *) msg, sizeof(size) + size);
+		if (ret_wr != (int)(sizeof(size) + size)) goto wr_error;
+
+		FUNC_CALL_EXIT;
+		return;
+	}
+
 	// Send the message length first
 	ret_wr = write(mq, (const void *) &size, sizeof(size));
 	if (ret_wr < (int)sizeof(size)) goto wr_error;
@@ -350,6 +395,24 @@ void mqueue_send(int mq, const char *str, int size)
 // - Typecast message back to a required type
 // ------------------------------------------------------------------
 int mqueue_recv(int mq, char *str, int size)
+{
+	if (ase_mq_ring_is_handle(mq))
+		return ase_mq_ring_recv(mq, str, size);
+
+#ifdef SIM_SIDE
+	if (ase_mq_mux_owns(mq))
+		return ase_mq_mux_recv(mq, str, size);
+#endif
+
+	return mqueue_recv_fifo(mq, str, size, NULL);
+}
+
+
+// ------------------------------------------------------------------
+// mqueue_recv_fifo(): Receive from a named FIFO descriptor
+// - Length of the received message is returned in *len (optional)
+// ------------------------------------------------------------------
+int mqueue_recv_fifo(int mq, char *str, int size, int *len)
 {
 	FUNC_CALL_ENTRY;
 
@@ -374,14 +437,15 @@ int mqueue_recv(int mq, char *str, int size)
 	// Receive the entire message
 	int recv_total = 0;
 	int empty_trips = 0;
+	struct pollfd pfd = { .fd = mq, .events = POLLIN };
 	while (recv_total < msg_len) {
 		ret_rd = read(mq, (void *) &str[recv_total], msg_len - recv_total);
 		if (ret_rd <= 0) {
 			// Message queues are non-blocking, so we may have to wait for the
-			// message to arrive.
+			// rest of the message to arrive. Give up after ~5 seconds.
 			ret_rd = 0;
-			usleep(1);
-			if (++empty_trips == 100000) goto rd_error;
+			poll(&pfd, 1, 10);
+			if (++empty_trips == 500) goto rd_error;
 		}
 		else
 		{
@@ -391,6 +455,9 @@ int mqueue_recv(int mq, char *str, int size)
 		recv_total += ret_rd;
 	}
 
+	if (len)
+		*len = msg_len;
+
 	FUNC_CALL_EXIT;
 	return ASE_MSG_PRESENT;
 
@@ -401,3 +468,31 @@ int mqueue_recv(int mq, char *str, int size)
 #endif
 	exit(1);
 }
+
+
+#ifdef SIM_SIDE
+// ------------------------------------------------------------------
+// mqueue_rx_pending(): Cheap test for new inbound messages
+// - True when an app2sim channel may have been written since the
+//   previous call. Always true when neither the rings nor the IO
+//   thread are active, since then there is nothing to check.
+// ------------------------------------------------------------------
+bool mqueue_rx_pending(void)
+{
+	static uint32_t seen_doorbell;
+	uint32_t doorbell;
+
+	if (ase_mq_ring_active())
+		doorbell = ase_mq_ring_doorbell();
+	else if (ase_mq_mux_active())
+		doorbell = ase_mq_mux_doorbell();
+	else
+		return true;
+
+	if (doorbell == seen_doorbell)
+		return false;
+
+	seen_doorbell = doorbell;
+	return true;
+}
+#endif
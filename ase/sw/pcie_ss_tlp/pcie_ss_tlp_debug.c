@@ -178,8 +178,7 @@ static void fprintf_pcie_ss_bitvec(FILE *stream, const svBitVecVal *payload, int
     fprintf(stream, "0x");
     for (int i = n_dwords - 1; i >= 0; i -= 1)
     {
-        uint32_t dw;
-        svGetPartselBit(&dw, payload, i * 32, 32);
+        uint32_t dw = payload[i];
         if ((i & 1) && (i != n_dwords - 1)) fprintf(stream, "_");
         fprintf(stream, "%08x", dw);
     }
@@ -230,3 +229,85 @@ void fprintf_pcie_ss_host_to_afu(
     fprintf(stream, "\n");
     fflush(stream);
 }
+
+
+static void trace_pcie_ss_hdr(ase_trace_pcie_ss_hdr *t, const t_pcie_ss_hdr_upk *hdr)
+{
+    t->fmt_type = hdr->fmt_type;
+    t->flags = (hdr->dm_mode ? ASE_TRACE_SS_DM_MODE : 0) |
+               (hdr->vf_active ? ASE_TRACE_SS_VF_ACTIVE : 0) |
+               (hdr->pref_present ? ASE_TRACE_SS_PREF_PRESENT : 0);
+    t->len_bytes = hdr->len_bytes;
+    t->pf_num = hdr->pf_num;
+    t->vf_num = hdr->vf_num;
+    t->pref_type = hdr->pref_type;
+    t->pref = hdr->pref;
+    t->req_id = hdr->req_id;
+    t->tag = hdr->tag;
+
+    // Same classification as fprintf_pcie_ss_hdr()
+    if (tlp_func_is_mem_req(hdr->fmt_type))
+    {
+        t->addr = hdr->u.req.addr;
+        t->last_dw_be = hdr->u.req.last_dw_be;
+        t->first_dw_be = hdr->u.req.first_dw_be;
+        t->at = hdr->u.req.attr.at;
+    }
+    else if (tlp_func_is_completion(hdr->fmt_type))
+    {
+        t->comp_id = hdr->u.cpl.comp_id;
+        t->cpl_status = hdr->u.cpl.cpl_status;
+        t->bcm = hdr->u.cpl.bcm;
+        t->byte_count = hdr->u.cpl.byte_count;
+        t->low_addr = hdr->u.cpl.low_addr;
+        if (hdr->u.cpl.fc) t->flags |= ASE_TRACE_SS_FC;
+    }
+    else if (!hdr->dm_mode && tlp_func_is_msg(hdr->fmt_type))
+    {
+        t->msg0 = hdr->u.msg.msg0;
+        t->msg1 = hdr->u.msg.msg1;
+        t->msg2 = hdr->u.msg.msg2;
+        t->msg_code = hdr->u.msg.msg_code;
+    }
+    else if (tlp_func_is_interrupt_req(hdr->fmt_type))
+    {
+        t->vector_num = hdr->u.intr.vector_num;
+    }
+}
+
+void trace_pcie_ss_beat(
+    ase_trace_t *trace,
+    bool afu_to_host,
+    long long cycle,
+    bool eop,
+    const t_pcie_ss_hdr_upk *hdr,
+    const svBitVecVal *tdata,
+    const svBitVecVal *tkeep
+)
+{
+    // svBitVecVal vectors are little-endian arrays of 32 bit words, so
+    // tdata and tkeep are copied as-is
+    uint32_t tdata_bytes = pcie_ss_param_cfg.tdata_width_bits / 8;
+    uint32_t tkeep_bytes = tdata_bytes / 8;
+    uint32_t len = sizeof(ase_trace_rec_hdr) + (hdr ? sizeof(ase_trace_pcie_ss_hdr) : 0) +
+                   tdata_bytes + tkeep_bytes;
+    uint8_t flags = (afu_to_host ? ASE_TRACE_F_AFU_TO_HOST : 0) |
+                    (hdr ? ASE_TRACE_F_SOP : 0) |
+                    (eop ? ASE_TRACE_F_EOP : 0);
+
+    ase_trace_rec_hdr *rh = ase_trace_record(trace, len, ASE_TRACE_REC_PCIE_SS, flags, cycle);
+    if (!rh) return;
+    rh->aux = tdata_bytes / 4;
+    char *rec = (char *)(rh + 1);
+
+    if (hdr)
+    {
+        trace_pcie_ss_hdr((ase_trace_pcie_ss_hdr *)rec, hdr);
+        rec += sizeof(ase_trace_pcie_ss_hdr);
+    }
+
+    memcpy(rec, tdata, tdata_bytes);
+    memcpy(rec + tdata_bytes, tkeep, tkeep_bytes);
+
+    ase_trace_commit(trace, rh);
+}
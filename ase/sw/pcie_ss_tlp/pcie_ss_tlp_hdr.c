@@ -29,6 +29,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "ase_common.h"
+#include "ase_dpi_vec.h"
 #include "pcie_ss_tlp_stream.h"
 
 
@@ -52,7 +53,7 @@ void pcie_ss_tlp_payload_reset(
     memset(tdata, 0, pcie_ss_param_cfg.tdata_width_bits / 8);
     memset(tkeep, 0, pcie_ss_param_cfg.tdata_width_bits / 64);
 
-    svPutPartselBit(tuser, 0, 0, pcie_ss_param_cfg.tuser_width_bits);
+    memset(tuser, 0, SV_PACKED_DATA_NELEMS(pcie_ss_param_cfg.tuser_width_bits) * 4);
 }
 
 // Pack the expanded C TLP message into the encoded packed vector
@@ -66,10 +67,10 @@ void pcie_ss_tlp_hdr_pack(
     pcie_ss_tlp_payload_reset(tdata, tuser, tkeep);
 
     // Bit 0 of tuser indicates data mover mode
-    svPutPartselBit(tuser, hdr->dm_mode, 0, 1);
+    ase_dpi_put_bits(tuser, hdr->dm_mode, 0, 1);
 
     // Set keep mask for header
-    svPutPartselBit(tkeep, ~0, 0, pcie_ss_cfg.tlp_hdr_dwords * 4);
+    ase_dpi_set_bits(tkeep, 0, pcie_ss_cfg.tlp_hdr_dwords * 4);
 
     // Common header components
 
@@ -78,7 +79,7 @@ void pcie_ss_tlp_hdr_pack(
     v |= ((uint32_t)(hdr->tag >> 9) & 1) << 23;
     v |= ((uint32_t)(hdr->tag >> 8) & 1) << 19;
     v |= (uint32_t)((hdr->len_bytes >> 2) & 0x3ff);
-    svPutPartselBit(tdata, v, 0, 32);
+    ase_dpi_put_bits(tdata, v, 0, 32);
 
     v = 0;
     v |= (uint32_t)(hdr->bar_number) << 25;
@@ -87,16 +88,16 @@ void pcie_ss_tlp_hdr_pack(
     v |= (uint32_t)(hdr->vf_active) << 14;
     v |= (uint32_t)(hdr->vf_num) << 3;
     v |= (uint32_t)(hdr->pf_num);
-    svPutPartselBit(tdata, v, 32*5, 32);
+    ase_dpi_put_bits(tdata, v, 32*5, 32);
 
     v = 0;
     v |= (uint32_t)(hdr->pref_present) << 29;
     v |= (uint32_t)(hdr->pref_type) << 24;
     v |= (uint32_t)(hdr->pref);
-    svPutPartselBit(tdata, v, 32*4, 32);
+    ase_dpi_put_bits(tdata, v, 32*4, 32);
 
-    svPutPartselBit(tdata, hdr->metadata, 32*7, 32);
-    svPutPartselBit(tdata, hdr->metadata >> 32, 32*6, 32);
+    ase_dpi_put_bits(tdata, hdr->metadata, 32*7, 32);
+    ase_dpi_put_bits(tdata, hdr->metadata >> 32, 32*6, 32);
 
     if (tlp_func_is_mem_req(hdr->fmt_type))
     {
@@ -105,17 +106,17 @@ void pcie_ss_tlp_hdr_pack(
         v |= (uint32_t)(hdr->tag & 0xff) << 8;
         v |= (uint32_t)(hdr->u.req.last_dw_be) << 4;
         v |= (uint32_t)(hdr->u.req.first_dw_be);
-        svPutPartselBit(tdata, v, 32*1, 32);
+        ase_dpi_put_bits(tdata, v, 32*1, 32);
 
         // Unpacked address is always a 64 bit value
         if (tlp_func_is_addr64(hdr->fmt_type))
         {
-            svPutPartselBit(tdata, hdr->u.req.addr >> 32, 32*2, 32);
-            svPutPartselBit(tdata, hdr->u.req.addr >> 2, 32*3 + 2, 30);
+            ase_dpi_put_bits(tdata, hdr->u.req.addr >> 32, 32*2, 32);
+            ase_dpi_put_bits(tdata, hdr->u.req.addr >> 2, 32*3 + 2, 30);
         }
         else
         {
-            svPutPartselBit(tdata, hdr->u.req.addr, 32*2, 32);
+            ase_dpi_put_bits(tdata, hdr->u.req.addr, 32*2, 32);
         }
     }
     else if (tlp_func_is_completion(hdr->fmt_type))
@@ -128,13 +129,13 @@ void pcie_ss_tlp_hdr_pack(
             v |= (uint32_t)((hdr->len_bytes >> 12) & 3) << 18;
             v |= (uint32_t)(hdr->len_bytes & 3) << 16;
             v |= (uint32_t)(hdr->u.cpl.low_addr >> 8) & 0xffff;
-            svPutPartselBit(tdata, v, 32*3, 32);
+            ase_dpi_put_bits(tdata, v, 32*3, 32);
 
-            svPutPartselBit(tdata, hdr->u.cpl.low_addr, 32*2, 8);
+            ase_dpi_put_bits(tdata, hdr->u.cpl.low_addr, 32*2, 8);
 
             v = 0;
             v |= (uint32_t)(hdr->u.cpl.cpl_status) << 13;
-            svPutPartselBit(tdata, v, 32*1, 32);
+            ase_dpi_put_bits(tdata, v, 32*1, 32);
         }
         else
         {
@@ -142,14 +143,14 @@ void pcie_ss_tlp_hdr_pack(
             v |= (uint32_t)(hdr->req_id) << 16;
             v |= (uint32_t)(hdr->tag & 0xff) << 8;
             v |= (uint32_t)(hdr->u.cpl.low_addr & 0x7f);
-            svPutPartselBit(tdata, v, 32*2, 32);
+            ase_dpi_put_bits(tdata, v, 32*2, 32);
 
             v = 0;
             v |= (uint32_t)(hdr->u.cpl.comp_id) << 16;
             v |= (uint32_t)(hdr->u.cpl.cpl_status) << 13;
             v |= (uint32_t)(hdr->u.cpl.bcm) << 12;
             v |= (uint32_t)(hdr->u.cpl.byte_count);
-            svPutPartselBit(tdata, v, 32*1, 32);
+            ase_dpi_put_bits(tdata, v, 32*1, 32);
         }
     }
     else if (! hdr->dm_mode && tlp_func_is_msg(hdr->fmt_type))
@@ -158,10 +159,10 @@ void pcie_ss_tlp_hdr_pack(
         v |= (uint32_t)(hdr->req_id) << 16;
         v |= (uint32_t)(hdr->tag & 0xff) << 8;
         v |= (uint32_t)(hdr->u.msg.msg_code);
-        svPutPartselBit(tdata, v, 32*1, 32);
+        ase_dpi_put_bits(tdata, v, 32*1, 32);
 
-        svPutPartselBit(tdata, hdr->u.msg.msg1, 32*2, 32);
-        svPutPartselBit(tdata, hdr->u.msg.msg2, 32*3, 32);
+        ase_dpi_put_bits(tdata, hdr->u.msg.msg1, 32*2, 32);
+        ase_dpi_put_bits(tdata, hdr->u.msg.msg2, 32*3, 32);
     }
 }
 
@@ -176,16 +177,15 @@ void pcie_ss_tlp_hdr_unpack(
     pcie_ss_tlp_hdr_reset(hdr);
 
     // Bit 0 of tuser indicates data mover mode
-    hdr->dm_mode = svGetBitselBit(tuser, 0);
+    hdr->dm_mode = ase_dpi_get_bits(tuser, 0, 1);
 
     // Common header components
 
-    uint32_t dw0;
-    svGetPartselBit(&dw0, tdata, 0, 32);
+    uint32_t dw0 = ase_dpi_get_bits(tdata, 0, 32);
     hdr->fmt_type = (dw0 >> 24) & 0xff;
 
     uint32_t v, v1, v2;
-    svGetPartselBit(&v, tdata, 32*5, 32);
+    v = ase_dpi_get_bits(tdata, 32*5, 32);
     hdr->bar_number = (v >> 25) & 0x7f;
     hdr->mm_mode = (v >> 24) & 1;
     hdr->slot_num = (v >> 15) & 0x1f;
@@ -193,18 +193,18 @@ void pcie_ss_tlp_hdr_unpack(
     hdr->vf_num = (v >> 3) & 0x7ff;
     hdr->pf_num = v & 0x7;
 
-    svGetPartselBit(&v, tdata, 32*4, 32);
+    v = ase_dpi_get_bits(tdata, 32*4, 32);
     hdr->pref_present = (v >> 29) & 1;
     hdr->pref_type = (v >> 24) & 0x1f;
     hdr->pref = v & 0xffffff;
 
-    svGetPartselBit(&v, tdata, 32*7, 32);
-    svGetPartselBit(&v1, tdata, 32*6, 32);
+    v = ase_dpi_get_bits(tdata, 32*7, 32);
+    v1 = ase_dpi_get_bits(tdata, 32*6, 32);
     hdr->metadata = ((uint64_t)v1 << 32) | v;
 
     if (tlp_func_is_mem_req(hdr->fmt_type))
     {
-        svGetPartselBit(&v, tdata, 32*1, 32);
+        v = ase_dpi_get_bits(tdata, 32*1, 32);
         hdr->tag = (((dw0 >> 23) & 1) << 9) |    // tag_h
                    (((dw0 >> 19) & 1) << 8) |    // tag_m
                    ((v >> 8) & 0xff);            // tag_l
@@ -221,8 +221,8 @@ void pcie_ss_tlp_hdr_unpack(
                              ((dw0 & 0x3ff) << 2) |        // length_m
                              ((v >> 16) & 3);              // length_l
 
-            svGetPartselBit(&v1, tdata, 32*2, 32);
-            svGetPartselBit(&v2, tdata, 32*3, 32);
+            v1 = ase_dpi_get_bits(tdata, 32*2, 32);
+            v2 = ase_dpi_get_bits(tdata, 32*3, 32);
             hdr->u.req.addr = ((uint64_t)v1 << 32) |   // host_addr_h
                               (v2 & ~3) |              // host_addr_m
                               ((v >> 30) & 3);         // host_addr_l
@@ -246,13 +246,13 @@ void pcie_ss_tlp_hdr_unpack(
 
             if (tlp_func_is_addr64(hdr->fmt_type))
             {
-                svGetPartselBit(&v, tdata, 32*3, 32);
-                svGetPartselBit(&v1, tdata, 32*2, 32);
+                v = ase_dpi_get_bits(tdata, 32*3, 32);
+                v1 = ase_dpi_get_bits(tdata, 32*2, 32);
                 hdr->u.req.addr = ((uint64_t)v1 << 32) | (v & ~3);
             }
             else
             {
-                svGetPartselBit(&v, tdata, 32*2, 32);
+                v = ase_dpi_get_bits(tdata, 32*2, 32);
                 hdr->u.req.addr = v;
             }
         }
@@ -267,14 +267,14 @@ void pcie_ss_tlp_hdr_unpack(
 
         hdr->len_bytes = (dw0 & 0x3ff) << 2;
 
-        svGetPartselBit(&v, tdata, 32*2, 32);
+        v = ase_dpi_get_bits(tdata, 32*2, 32);
         hdr->req_id = (v >> 16) & 0xffff;
         hdr->tag = (((dw0 >> 23) & 1) << 9) |    // tag_h
                    (((dw0 >> 19) & 1) << 8) |    // tag_m
                    ((v >> 8) & 0xff);            // tag_l
         hdr->u.cpl.low_addr = v & 0x7f;
 
-        svGetPartselBit(&v, tdata, 32*1, 32);
+        v = ase_dpi_get_bits(tdata, 32*1, 32);
         hdr->u.cpl.comp_id = (v >> 16) & 0xffff;
         hdr->u.cpl.cpl_status = (v >> 13) & 0x7;
         hdr->u.cpl.bcm = (v >> 12) & 1;
@@ -282,7 +282,7 @@ void pcie_ss_tlp_hdr_unpack(
     }
     else if (! hdr->dm_mode && tlp_func_is_msg(hdr->fmt_type))
     {
-        svGetPartselBit(&v, tdata, 32*1, 32);
+        v = ase_dpi_get_bits(tdata, 32*1, 32);
         hdr->tag = (((dw0 >> 23) & 1) << 9) |    // tag_h
                    (((dw0 >> 19) & 1) << 8) |    // tag_m
                    ((v >> 8) & 0xff);            // tag_l
@@ -292,8 +292,8 @@ void pcie_ss_tlp_hdr_unpack(
         hdr->u.msg.msg0 = (v >> 8) & 0xff;
         hdr->u.msg.msg_code = v & 0xff;
 
-        svGetPartselBit(&hdr->u.msg.msg1, tdata, 32*2, 32);
-        svGetPartselBit(&hdr->u.msg.msg2, tdata, 32*3, 32);
+        hdr->u.msg.msg1 = ase_dpi_get_bits(tdata, 32*2, 32);
+        hdr->u.msg.msg2 = ase_dpi_get_bits(tdata, 32*3, 32);
     }
     else if (tlp_func_is_interrupt_req(hdr->fmt_type))
     {
@@ -303,7 +303,7 @@ void pcie_ss_tlp_hdr_unpack(
             start_simkill_countdown();
         }
 
-        svGetPartselBit(&v, tdata, 32*2, 16);
+        v = ase_dpi_get_bits(tdata, 32*2, 16);
         hdr->u.intr.vector_num = v;
     }
 }
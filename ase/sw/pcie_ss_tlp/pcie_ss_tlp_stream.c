@@ -31,10 +31,16 @@
 #include <assert.h>
 
 #include "ase_common.h"
+#include "ase_dpi_vec.h"
 #include "ase_host_memory.h"
+#include "ase_log.h"
+#include "ase_pool.h"
+#include "ase_wc.h"
+#include "ase_zcopy.h"
 #include "pcie_ss_tlp_stream.h"
 
 static FILE *logfile;
+static ase_trace_t *trace;        // Binary trace in place of logfile
 
 t_ase_pcie_ss_param_cfg pcie_ss_param_cfg;
 t_ase_pcie_ss_cfg pcie_ss_cfg;
@@ -273,12 +279,53 @@ typedef struct dma_read_cpl
 static t_dma_read_cpl *dma_read_cpl_head;
 static t_dma_read_cpl *dma_read_cpl_tail;
 
+// Completion records and read response payloads (max_any_rd_req_bytes),
+// recycled so that steady-state DMA doesn't touch the heap.
+static ase_pool_t dma_read_cpl_pool;
+static ase_pool_t dma_read_data_pool;
+
 // Number of DWORDs remaining in current host to AFU read completion
 static uint32_t dma_read_cpl_dw_rem;
 
 static uint32_t num_dma_reads_pending;
 static uint32_t num_dma_writes_pending;
 
+static void pcie_push_dma_read_rsp(uint32_t tag, uint32_t *read_rsp_data);
+
+
+//
+// Log a beat to the binary trace, if enabled, or to the text log.
+//
+static void log_pcie_ss_afu_to_host(
+    long long cycle,
+    bool eop,
+    const t_pcie_ss_hdr_upk *hdr,
+    const svBitVecVal *tdata,
+    const svBitVecVal *tuser,
+    const svBitVecVal *tkeep
+)
+{
+    if (trace)
+        trace_pcie_ss_beat(trace, true, cycle, eop, hdr, tdata, tkeep);
+    else
+        fprintf_pcie_ss_afu_to_host(logfile, cycle, eop, hdr, tdata, tuser, tkeep);
+}
+
+static void log_pcie_ss_host_to_afu(
+    long long cycle,
+    bool eop,
+    const t_pcie_ss_hdr_upk *hdr,
+    const svBitVecVal *tdata,
+    const svBitVecVal *tuser,
+    const svBitVecVal *tkeep
+)
+{
+    if (trace)
+        trace_pcie_ss_beat(trace, false, cycle, eop, hdr, tdata, tkeep);
+    else
+        fprintf_pcie_ss_host_to_afu(logfile, cycle, eop, hdr, tdata, tuser, tkeep);
+}
+
 
 // ========================================================================
 //
@@ -387,10 +434,7 @@ static void pcie_tlp_a2h_cpld(
     }
 
     // Copy payload data
-    for (int i = 0; i < payload_dws; i += 1)
-    {
-        svGetPartselBit(&payload[next_dw_idx + i], tdata, (i + tdata_payload_dw_idx) * 32, 32);
-    }
+    ase_dpi_get_dwords(&payload[next_dw_idx], tdata, tdata_payload_dw_idx, payload_dws);
     next_dw_idx += payload_dws;
 
     // Packet complete?
@@ -529,10 +573,7 @@ static void pcie_tlp_a2h_mwr(
     }
 
     // Copy payload data
-    for (int i = 0; i < payload_dws; i += 1)
-    {
-        svGetPartselBit(&payload[next_dw_idx + i], tdata, (i + tdata_payload_dw_idx) * 32, 32);
-    }
+    ase_dpi_get_dwords(&payload[next_dw_idx], tdata, tdata_payload_dw_idx, payload_dws);
     next_dw_idx += payload_dws;
 
     // Packet complete?
@@ -564,11 +605,16 @@ static void pcie_tlp_a2h_mwr(
             wr_req.pasid = hdr.pref & 0xfffff;
         }
 
-        mqueue_send(sim2app_membus_wr_req_tx, (char *) &wr_req, sizeof(wr_req));
-        mqueue_send(sim2app_membus_wr_req_tx, (char *) payload, wr_req.data_bytes);
+        // Zero-copy writes must not pass earlier writes that are still
+        // in flight through the application or held for combining.
+        if ((num_dma_writes_pending == 0) && !ase_wc_held() &&
+            ase_zcopy_write(&wr_req, payload))
+        {
+            return;
+        }
 
         // Update count of pending write responses
-        num_dma_writes_pending += 1;
+        num_dma_writes_pending += ase_wc_write(&wr_req, payload, cycle);
     }
 }
 
@@ -782,10 +828,7 @@ static void pcie_tlp_a2h_mrd(
 
         // Extract possible operands into 32 bit chunks
         uint32_t atomic_opers[4];
-        for (int i = 0; i < 4; i += 1)
-        {
-            svGetPartselBit(&atomic_opers[i], tdata, (i + payload_dw_offset) * 32, 32);
-        }
+        ase_dpi_get_dwords(atomic_opers, tdata, payload_dw_offset, 4);
 
         switch (hdr->fmt_type)
         {
@@ -829,6 +872,19 @@ static void pcie_tlp_a2h_mrd(
         }
     }
 
+    // Zero-copy reads complete immediately. Like writes, they must not pass
+    // earlier writes that are still in flight through the application.
+    if ((num_dma_writes_pending == 0) && ase_zcopy_active())
+    {
+        uint32_t *read_rsp_data = ase_pool_alloc(&dma_read_data_pool);
+        if (read_rsp_data && ase_zcopy_read(&rd_req, read_rsp_data))
+        {
+            pcie_push_dma_read_rsp(tag, read_rsp_data);
+            return;
+        }
+        ase_pool_free(&dma_read_data_pool, read_rsp_data);
+    }
+
     mqueue_send(sim2app_membus_rd_req_tx, (char *)&rd_req, sizeof(rd_req));
 
     // Update count of pending read responses
@@ -849,8 +905,9 @@ static void pcie_complete_dma_writes()
         int status;
 
         // The only task required here is to consume the response from the
-        // application. The response indicates whether the address was
-        // valid.  Raise an error for invalid addresses.
+        // application. Responses are sent only for invalid addresses and
+        // as watermarks that acknowledge a group of writes. Raise an error
+        // for invalid addresses.
 
         status = mqueue_recv(app2sim_membus_wr_rsp_rx, (char *) &wr_rsp, sizeof(wr_rsp));
 
@@ -862,7 +919,7 @@ static void pcie_complete_dma_writes()
                 break;
             }
 
-            num_dma_writes_pending -= 1;
+            num_dma_writes_pending -= ase_wc_acked(&wr_rsp);
         }
         else
         {
@@ -977,6 +1034,83 @@ static void push_new_read_cpl(t_dma_read_cpl *read_cpl)
 }
 
 
+//
+// Queue the completion packets for a DMA read response. Ownership of
+// read_rsp_data passes to the completion list.
+//
+static void pcie_push_dma_read_rsp(uint32_t tag, uint32_t *read_rsp_data)
+{
+    // Push the read on the list of pending PCIe completions
+    t_dma_read_state *rd_state = &dma_read_state[tag];
+    const t_pcie_ss_hdr_upk *req_hdr = &rd_state->req_hdr;
+
+    //
+    // If the read response is large then it might be broken apart into
+    // multiple response packets. Simulate that, randomizing the size
+    // decisions.
+    //
+
+    // Total DWORD length of the response
+    uint32_t len_dw_rem = (req_hdr->len_bytes + 3) / 4;
+    uint32_t len_bytes_rem = req_hdr->len_bytes;
+    // Total bytes of the response, accounting for masks
+    uint32_t byte_count_rem =
+        pcie_cpl_byte_count(len_dw_rem,
+                            req_hdr->u.req.first_dw_be,
+                            req_hdr->u.req.last_dw_be);
+    // Offset of the read data for the current packet
+    uint32_t start_dw = 0;
+
+    // Loop until the entire payload has completion packets
+    do
+    {
+        t_dma_read_cpl *read_cpl = ase_pool_alloc(&dma_read_cpl_pool);
+        read_cpl->state = rd_state;
+        read_cpl->read_rsp_data = read_rsp_data;
+
+        // Pick a random length, between the request completion
+        // boundary and the total payload size.
+        uint32_t this_len_dw = random_cpl_length(len_dw_rem, req_hdr->dm_mode);
+
+        bool is_first = (start_dw == 0);
+        bool is_last = (this_len_dw == len_dw_rem);
+
+        read_cpl->len_bytes = this_len_dw * 4;
+        if (is_last)
+        {
+            read_cpl->len_bytes = len_bytes_rem;
+        }
+
+        read_cpl->start_dw = start_dw;
+        // PCIe expects the total remaining byte count for this and all
+        // future packets for the original request as "byte_count".
+        read_cpl->byte_count = byte_count_rem;
+        read_cpl->is_first = is_first;
+        read_cpl->is_last = is_last;
+
+        // Push this completion on the list of pending messages
+        push_new_read_cpl(read_cpl);
+
+        // Subtract the length of the current completion from the total
+        byte_count_rem = byte_count_rem -
+            pcie_cpl_byte_count(this_len_dw,
+                                is_first ? req_hdr->u.req.first_dw_be : 0xf,
+                                is_last ? req_hdr->u.req.last_dw_be : 0xf);
+        len_dw_rem -= this_len_dw;
+        len_bytes_rem -= (this_len_dw * 4);
+        start_dw += this_len_dw;
+
+        // Check the algorithm -- is_last implies no remaining data.
+        assert((len_dw_rem == 0) == is_last);
+    }
+    while (len_dw_rem > 0);
+
+    // The algorithm above is broken if this assertion fails. All
+    // bytes should have been handled.
+    assert(byte_count_rem == 0);
+}
+
+
 static void pcie_receive_dma_reads()
 {
     while (num_dma_reads_pending)
@@ -998,7 +1132,7 @@ static void pcie_receive_dma_reads()
             }
 
             // Get the data, which was sent separately
-            uint32_t *read_rsp_data = ase_malloc(pcie_ss_cfg.max_any_rd_req_bytes);
+            uint32_t *read_rsp_data = ase_pool_alloc(&dma_read_data_pool);
             if (NULL == read_rsp_data) ASE_ERR("Out of memory");
             if (rd_rsp.data_bytes) {
                 while ((status = mqueue_recv(app2sim_membus_rd_rsp_rx, (char *)read_rsp_data, rd_rsp.data_bytes)) != ASE_MSG_PRESENT) {
@@ -1008,74 +1142,7 @@ static void pcie_receive_dma_reads()
 
             num_dma_reads_pending -= 1;
 
-            // Push the read on the list of pending PCIe completions
-            t_dma_read_state *rd_state = &dma_read_state[rd_rsp.tag];
-            const t_pcie_ss_hdr_upk *req_hdr = &rd_state->req_hdr;
-
-            //
-            // If the read response is large then it might be broken apart into
-            // multiple response packets. Simulate that, randomizing the size
-            // decisions.
-            //
-
-            // Total DWORD length of the response
-            uint32_t len_dw_rem = (req_hdr->len_bytes + 3) / 4;
-            uint32_t len_bytes_rem = req_hdr->len_bytes;
-            // Total bytes of the response, accounting for masks
-            uint32_t byte_count_rem =
-                pcie_cpl_byte_count(len_dw_rem,
-                                    req_hdr->u.req.first_dw_be,
-                                    req_hdr->u.req.last_dw_be);
-            // Offset of the read data for the current packet
-            uint32_t start_dw = 0;
-
-            // Loop until the entire payload has completion packets
-            do
-            {
-                t_dma_read_cpl *read_cpl = ase_malloc(sizeof(t_dma_read_cpl));
-                read_cpl->state = rd_state;
-                read_cpl->read_rsp_data = read_rsp_data;
-
-                // Pick a random length, between the request completion
-                // boundary and the total payload size.
-                uint32_t this_len_dw = random_cpl_length(len_dw_rem, req_hdr->dm_mode);
-
-                bool is_first = (start_dw == 0);
-                bool is_last = (this_len_dw == len_dw_rem);
-
-                read_cpl->len_bytes = this_len_dw * 4;
-                if (is_last)
-                {
-                    read_cpl->len_bytes = len_bytes_rem;
-                }
-
-                read_cpl->start_dw = start_dw;
-                // PCIe expects the total remaining byte count for this and all
-                // future packets for the original request as "byte_count".
-                read_cpl->byte_count = byte_count_rem;
-                read_cpl->is_first = is_first;
-                read_cpl->is_last = is_last;
-
-                // Push this completion on the list of pending messages
-                push_new_read_cpl(read_cpl);
-
-                // Subtract the length of the current completion from the total
-                byte_count_rem = byte_count_rem -
-                    pcie_cpl_byte_count(this_len_dw,
-                                        is_first ? req_hdr->u.req.first_dw_be : 0xf,
-                                        is_last ? req_hdr->u.req.last_dw_be : 0xf);
-                len_dw_rem -= this_len_dw;
-                len_bytes_rem -= (this_len_dw * 4);
-                start_dw += this_len_dw;
-
-                // Check the algorithm -- is_last implies no remaining data.
-                assert((len_dw_rem == 0) == is_last);
-            }
-            while (len_dw_rem > 0);
-
-            // The algorithm above is broken if this assertion fails. All
-            // bytes should have been handled.
-            assert(byte_count_rem == 0);
+            pcie_push_dma_read_rsp(rd_rsp.tag, read_rsp_data);
         }
         else if (status != ASE_MSG_ABSENT)
         {
@@ -1178,6 +1245,7 @@ typedef struct mmio_list
 
 static t_mmio_list *mmio_req_head;
 static t_mmio_list *mmio_req_tail;
+static ase_pool_t mmio_req_pool;
 
 //
 // Push a new MMIO request on the processing list.
@@ -1201,7 +1269,7 @@ void pcie_ss_mmio_new_req(const mmio_t *pkt)
     }
 
     // Allocate a request
-    t_mmio_list *m = ase_malloc(sizeof(t_mmio_list));
+    t_mmio_list *m = ase_pool_alloc(&mmio_req_pool);
     memcpy(&m->mmio_pkt, pkt, sizeof(mmio_t));
 
     // Push it on the tail of the list
@@ -1299,15 +1367,12 @@ static void pcie_tlp_h2a_msg(
                 if (status == ASE_MSG_ERROR) break;
             }
 
-            for (int i = 0; i < hdr.len_bytes / 4; i += 1)
-            {
-                svPutPartselBit(tdata, payload[i], (i + pcie_ss_cfg.tlp_hdr_dwords) * 32, 32);
-                svPutPartselBit(tkeep, 0xf, (i + pcie_ss_cfg.tlp_hdr_dwords) * 4, 4);
-            }
+            memcpy(&tdata[pcie_ss_cfg.tlp_hdr_dwords], payload, (hdr.len_bytes / 4) * 4);
+            ase_dpi_set_bits(tkeep, pcie_ss_cfg.tlp_hdr_dwords * 4, (hdr.len_bytes / 4) * 4);
         }
 
-        fprintf_pcie_ss_host_to_afu(logfile, cycle, *tlast, &hdr,
-                                    tdata, tuser, tkeep);
+        log_pcie_ss_host_to_afu(cycle, *tlast, &hdr,
+                                tdata, tuser, tkeep);
     }
 }
 
@@ -1412,18 +1477,15 @@ static bool pcie_tlp_h2a_mem(
 
             // Copy the next data group to the channel
             const uint32_t *req_data = (const uint32_t *)mmio_pkt->qword;
-            for (int i = 0; i < req_dw; i += 1)
-            {
-                svPutPartselBit(tdata, req_data[start_dw + i], (i + tdata_start_dw) * 32, 32);
-                svPutPartselBit(tkeep, ~0, (i + tdata_start_dw) * 4, 4);
-            }
+            ase_dpi_put_dwords(tdata, tdata_start_dw, &req_data[start_dw], req_dw);
+            ase_dpi_set_bits(tkeep, tdata_start_dw * 4, req_dw * 4);
 
             mmio_req_dw_rem -= req_dw;
         }
 
-        fprintf_pcie_ss_host_to_afu(logfile, cycle, *tlast,
-                                    (sop ? &hdr : NULL),
-                                    tdata, tuser, tkeep);
+        log_pcie_ss_host_to_afu(cycle, *tlast,
+                                (sop ? &hdr : NULL),
+                                tdata, tuser, tkeep);
     }
 
     // Pop request
@@ -1435,7 +1497,7 @@ static bool pcie_tlp_h2a_mem(
         {
             mmio_req_tail = NULL;
         }
-        free(m);
+        ase_pool_free(&mmio_req_pool, m);
     }
 
     return !*tvalid || *tlast;
@@ -1562,25 +1624,22 @@ static bool pcie_tlp_h2a_cpld(
 
         // Copy the next data group to the channel
         const uint32_t *rsp_data = dma_cpl->read_rsp_data;
-        for (int i = 0; i < rsp_dw; i += 1)
-        {
-            svPutPartselBit(tdata, rsp_data[start_dw + i], (i + tdata_start_dw) * 32, 32);
+        ase_dpi_put_dwords(tdata, tdata_start_dw, &rsp_data[start_dw], rsp_dw);
 
-            // Set the keep mask for this DW. If it's the last one and the
-            // length isn't a multiple of DWs, set only the appropriate bits.
-            uint32_t keep_mask = ~0;
-            if (*tlast && (i + 1 == rsp_dw) && (dma_cpl->len_bytes & 3))
-            {
-                keep_mask = (1 << (dma_cpl->len_bytes & 3)) - 1;
-            }
-            svPutPartselBit(tkeep, keep_mask, (i + tdata_start_dw) * 4, 4);
+        // Set the keep mask. If this is the last DW and the length isn't
+        // a multiple of DWs, set only the appropriate bits.
+        uint32_t keep_bytes = rsp_dw * 4;
+        if (*tlast && (dma_cpl->len_bytes & 3))
+        {
+            keep_bytes -= 4 - (dma_cpl->len_bytes & 3);
         }
+        ase_dpi_set_bits(tkeep, tdata_start_dw * 4, keep_bytes);
 
         dma_read_cpl_dw_rem -= rsp_dw;
 
-        fprintf_pcie_ss_host_to_afu(logfile, cycle, *tlast,
-                                    (sop ? &hdr : NULL),
-                                    tdata, tuser, tkeep);
+        log_pcie_ss_host_to_afu(cycle, *tlast,
+                                (sop ? &hdr : NULL),
+                                tdata, tuser, tkeep);
     }
 
     // Pop request
@@ -1589,7 +1648,7 @@ static bool pcie_tlp_h2a_cpld(
         if (dma_cpl->is_last)
         {
             // Done with the data
-            free(dma_cpl->read_rsp_data);
+            ase_pool_free(&dma_read_data_pool, dma_cpl->read_rsp_data);
         }
 
         dma_read_cpl_head = dma_cpl->next;
@@ -1602,7 +1661,7 @@ static bool pcie_tlp_h2a_cpld(
             dma_read_cpl_head->prev = NULL;
         }
 
-        free(dma_cpl);
+        ase_pool_free(&dma_read_cpl_pool, dma_cpl);
     }
 
     return !*tvalid || *tlast;
@@ -1651,12 +1710,24 @@ int pcie_ss_param_init(const t_ase_pcie_ss_param_cfg *params)
     while (dma_read_cpl_head)
     {
         t_dma_read_cpl *read_cpl_next = dma_read_cpl_head->next;
-        free(dma_read_cpl_head);
+        if (dma_read_cpl_head->is_last)
+            ase_pool_free(&dma_read_data_pool, dma_read_cpl_head->read_rsp_data);
+        ase_pool_free(&dma_read_cpl_pool, dma_read_cpl_head);
         dma_read_cpl_head = read_cpl_next;
     }
     dma_read_cpl_tail = NULL;
     dma_read_cpl_dw_rem = 0;
 
+    // Size the pools for the configured number of outstanding requests.
+    // Reads may be split into several completions. The pools grow if
+    // the estimates are low.
+    ase_pool_init(&dma_read_data_pool, pcie_ss_cfg.max_any_rd_req_bytes,
+                  pcie_ss_param_cfg.max_outstanding_dma_rd_reqs);
+    ase_pool_init(&dma_read_cpl_pool, sizeof(t_dma_read_cpl),
+                  4 * pcie_ss_param_cfg.max_outstanding_dma_rd_reqs);
+    ase_pool_init(&mmio_req_pool, sizeof(t_mmio_list),
+                  2 * pcie_ss_param_cfg.max_outstanding_mmio_rd_reqs);
+
     uint64_t dma_state_size = sizeof(t_dma_read_state) *
                               pcie_ss_param_cfg.max_outstanding_dma_rd_reqs;
     dma_read_state = ase_malloc(dma_state_size);
@@ -1679,6 +1750,9 @@ int pcie_ss_reset()
     if (!in_reset)
     {
         in_reset = true;
+
+        // Writes issued by the AFU before reset still reach memory
+        num_dma_writes_pending += ase_wc_flush();
     }
 
     afu_to_host_state = TLP_STATE_SOP;
@@ -1688,12 +1762,11 @@ int pcie_ss_reset()
 }
                                                        
 //
-// Get a host->AFU PCIe TLP message for a single channel. Called once per
-// cycle via DPI-C for each PCIe channel.
+// Generate the next host->AFU beat, if there is one. The AFU is known
+// to be ready.
 //
-int pcie_ss_stream_host_to_afu(
+static void pcie_ss_h2a_beat(
     long long cycle,
-    int tready,
     int *tvalid,
     int *tlast,
     svBitVecVal *tdata,
@@ -1701,17 +1774,8 @@ int pcie_ss_stream_host_to_afu(
     svBitVecVal *tkeep
 )
 {
-    cur_cycle = cycle;
-    in_reset = false;
-
     *tvalid = 0;
 
-    // Receive pending memory responses from the remote memory model
-    pcie_complete_dma_writes();
-    pcie_receive_dma_reads();
-
-    if (!tready) return 0;
-
     switch (host_to_afu_state)
     {
       case TLP_STATE_SOP:
@@ -1750,10 +1814,92 @@ int pcie_ss_stream_host_to_afu(
         ASE_ERR("Unexpected host to AFU TLP state\n");
         start_simkill_countdown();
     }
+}
 
+//
+// Get a host->AFU PCIe TLP message for a single channel. Called once per
+// cycle via DPI-C for each PCIe channel.
+//
+int pcie_ss_stream_host_to_afu(
+    long long cycle,
+    int tready,
+    int *tvalid,
+    int *tlast,
+    svBitVecVal *tdata,
+    svBitVecVal *tuser,
+    svBitVecVal *tkeep
+)
+{
+    cur_cycle = cycle;
+    in_reset = false;
+
+    *tvalid = 0;
+
+    // Send a combined DMA write whose window has expired
+    num_dma_writes_pending += ase_wc_tick(cycle);
+
+    // Receive pending memory responses from the remote memory model
+    pcie_complete_dma_writes();
+    pcie_receive_dma_reads();
+
+    if (!tready) return 0;
+
+    pcie_ss_h2a_beat(cycle, tvalid, tlast, tdata, tuser, tkeep);
     return 0;
 }
 
+//
+// Get up to max_beats host->AFU beats in one DPI-C call. The emulator
+// queues the beats and calls again once the AFU has consumed them all,
+// so beat i is expected to be delivered in cycle + i. In between, it
+// calls pcie_ss_stream_host_to_afu() with tready clear every cycle so
+// that memory responses are still received. Beats are packed
+// in unpacked arrays of tdata/tuser/tkeep and bit i of tlast holds the
+// tlast flag of beat i. Returns the number of valid beats, which are
+// always at the start of the arrays.
+//
+int pcie_ss_stream_host_to_afu_batch(
+    long long cycle,
+    int max_beats,
+    svBitVecVal *tlast,
+    svBitVecVal *tdata,
+    svBitVecVal *tuser,
+    svBitVecVal *tkeep
+)
+{
+    // Words per array entry
+    const uint32_t tdata_words = SV_PACKED_DATA_NELEMS(pcie_ss_param_cfg.tdata_width_bits);
+    const uint32_t tuser_words = SV_PACKED_DATA_NELEMS(pcie_ss_param_cfg.tuser_width_bits);
+    const uint32_t tkeep_words = SV_PACKED_DATA_NELEMS(pcie_ss_param_cfg.tdata_width_bits / 8);
+
+    in_reset = false;
+    memset(tlast, 0, SV_PACKED_DATA_NELEMS(max_beats) * 4);
+
+    num_dma_writes_pending += ase_wc_tick(cycle);
+
+    // Receive pending memory responses from the remote memory model
+    pcie_complete_dma_writes();
+    pcie_receive_dma_reads();
+
+    int n_beats;
+    for (n_beats = 0; n_beats < max_beats; n_beats += 1)
+    {
+        int beat_valid;
+        int beat_last;
+
+        cur_cycle = cycle + n_beats;
+        pcie_ss_h2a_beat(cycle + n_beats, &beat_valid, &beat_last,
+                         tdata + n_beats * tdata_words,
+                         tuser + n_beats * tuser_words,
+                         tkeep + n_beats * tkeep_words);
+        if (!beat_valid) break;
+
+        if (beat_last) ase_dpi_put_bits(tlast, 1, n_beats, 1);
+    }
+
+    return n_beats;
+}
+
 //
 // Receive an AFU->host PCIe TLP message for a single channel. Called only
 // when a channel has valid data.
@@ -1773,8 +1919,17 @@ int pcie_ss_stream_afu_to_host(
     {
       case TLP_STATE_SOP:
         pcie_ss_tlp_hdr_unpack(&hdr, tdata, tuser, tkeep);
-        fprintf_pcie_ss_afu_to_host(logfile, cycle, tlast, &hdr, tdata, tuser, tkeep);
-        
+        log_pcie_ss_afu_to_host(cycle, tlast, &hdr, tdata, tuser, tkeep);
+
+        // Only DMA writes may pass a write held for combining. Messages,
+        // interrupts, completions and reads are ordered after it.
+        if (tlp_func_is_interrupt_req(hdr.fmt_type) ||
+            !tlp_func_is_mem_req(hdr.fmt_type) || !tlp_func_is_mwr_req(hdr.fmt_type) ||
+            func_is_atomic_req(hdr.fmt_type))
+        {
+            num_dma_writes_pending += ase_wc_flush();
+        }
+
         if (!hdr.dm_mode && tlp_func_is_msg(hdr.fmt_type))
         {
             pcie_tlp_a2h_msg(cycle, tlast, &hdr, tdata, tuser, tkeep);
@@ -1838,17 +1993,17 @@ int pcie_ss_stream_afu_to_host(
         break;
 
       case TLP_STATE_CPL:
-        fprintf_pcie_ss_afu_to_host(logfile, cycle, tlast, NULL, tdata, tuser, tkeep);
+        log_pcie_ss_afu_to_host(cycle, tlast, NULL, tdata, tuser, tkeep);
         pcie_tlp_a2h_cpld(cycle, tlast, NULL, tdata, tuser, tkeep);
         break;
 
       case TLP_STATE_MWR:
-        fprintf_pcie_ss_afu_to_host(logfile, cycle, tlast, NULL, tdata, tuser, tkeep);
+        log_pcie_ss_afu_to_host(cycle, tlast, NULL, tdata, tuser, tkeep);
         pcie_tlp_a2h_mwr(cycle, tlast, NULL, tdata, tuser, tkeep);
         break;
 
       case TLP_STATE_MRD:
-        fprintf_pcie_ss_afu_to_host(logfile, cycle, tlast, NULL, tdata, tuser, tkeep);
+        log_pcie_ss_afu_to_host(cycle, tlast, NULL, tdata, tuser, tkeep);
         if (!tlast)
         {
             ASE_ERR("AFU Tx TLP - expected EOP with DMA atomic multi-beat request:\n");
@@ -1894,7 +2049,13 @@ int pcie_ss_open_logfile(
     const char *logname
 )
 {
-    logfile = fopen(logname, "w");
+    if (ase_trace_enabled())
+    {
+        trace = ase_trace_open(logname, ASE_TRACE_FMT_PCIE_SS);
+        if (trace) return 0;
+    }
+
+    logfile = ase_log_fopen(logname);
     if (logfile == NULL)
     {
         fprintf(stderr, "Failed to open log file: %s\n", logname);
@@ -1910,6 +2071,12 @@ int pcie_ss_write_logfile(
     const char *msg
 )
 {
+    if (trace)
+    {
+        ase_trace_text(trace, msg);
+        return 0;
+    }
+
     fprintf(logfile, "%s", msg);
     fflush(logfile);
     return 0;
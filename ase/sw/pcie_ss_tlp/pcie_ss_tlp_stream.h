@@ -32,6 +32,7 @@
 #define _PCIE_SS_TLP_STREAM_H_
 
 #include "ase_common.h"
+#include "ase_trace.h"
 #include "pcie_tlp_func.h"
 
 
@@ -518,4 +519,15 @@ void fprintf_pcie_ss_host_to_afu(
     const svBitVecVal *tkeep
 );
 
+// Binary trace equivalent of fprintf_pcie_ss_{afu_to_host,host_to_afu}()
+void trace_pcie_ss_beat(
+    ase_trace_t *trace,
+    bool afu_to_host,
+    long long cycle,
+    bool eop,
+    const t_pcie_ss_hdr_upk *hdr,
+    const svBitVecVal *tdata,
+    const svBitVecVal *tkeep
+);
+
 #endif // _PCIE_SS_TLP_STREAM_H_
@@ -44,6 +44,10 @@ static void* (*real_mremap)(void *start, size_t old_len, size_t len, int flags,
 
 static void *libase_handle;
 static void (*dl_ase_mem_unmap_hook)(void *va, size_t length);
+static void (*dl_ase_mem_map_hook)(void *va, size_t length, int flags, int fd);
+static void (*dl_ase_mem_unmapped_hook)(void *va, size_t length);
+static void (*dl_ase_mem_remap_hook)(void *old_va, size_t old_length,
+				     void *new_va, size_t new_length);
 
 /*
  * Find ASE notifier hooks that will be called to tell ASE about memory updates.
@@ -68,6 +72,18 @@ static void load_ase_hooks(void)
 		return;
 
 	dl_ase_mem_unmap_hook = dlsym(libase_handle, "ase_mem_unmap_hook");
+
+	// Updates to ASE's index of the address space, called after the
+	// real function succeeds.
+	dl_ase_mem_map_hook = dlsym(libase_handle, "ase_mem_map_hook");
+	dl_ase_mem_unmapped_hook = dlsym(libase_handle, "ase_mem_unmapped_hook");
+	dl_ase_mem_remap_hook = dlsym(libase_handle, "ase_mem_remap_hook");
+
+	// Tell ASE that address space updates will be reported
+	void (*attach)(void) = dlsym(libase_handle, "ase_mem_hooks_attach");
+	if (attach && dl_ase_mem_unmap_hook && dl_ase_mem_map_hook &&
+	    dl_ase_mem_unmapped_hook && dl_ase_mem_remap_hook)
+		(*attach)();
 }
 
 
@@ -87,7 +103,11 @@ mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
 		if (addr && dl_ase_mem_unmap_hook)
 			(*dl_ase_mem_unmap_hook)(addr, length);
 
-		return (*real_mmap)(addr, length, prot, flags, fd, offset);
+		void *result = (*real_mmap)(addr, length, prot, flags, fd, offset);
+		if ((result != MAP_FAILED) && dl_ase_mem_map_hook)
+			(*dl_ase_mem_map_hook)(result, length, flags, fd);
+
+		return result;
 	}
 
 	errno = EINVAL;
@@ -110,7 +130,11 @@ munmap(void *addr, size_t length)
 		if (dl_ase_mem_unmap_hook)
 			(*dl_ase_mem_unmap_hook)(addr, length);
 
-		return (*real_munmap)(addr, length);
+		int result = (*real_munmap)(addr, length);
+		if ((result == 0) && dl_ase_mem_unmapped_hook)
+			(*dl_ase_mem_unmapped_hook)(addr, length);
+
+		return result;
 	}
 
 	errno = EINVAL;
@@ -123,7 +147,7 @@ munmap(void *addr, size_t length)
 void  __attribute__((visibility("default"))) *
 mremap (void *start, size_t old_len, size_t len, int flags, ...)
 {
-	void *result = NULL;
+	void *result;
 	va_list ap;
 
 	va_start (ap, flags);
@@ -144,10 +168,15 @@ mremap (void *start, size_t old_len, size_t len, int flags, ...)
 			if (dl_ase_mem_unmap_hook)
 				(*dl_ase_mem_unmap_hook)(newaddr, len);
 
-			return (*real_mremap)(start, old_len, len, flags, newaddr);
+			result = (*real_mremap)(start, old_len, len, flags, newaddr);
 		}
 		else
-			return (*real_mremap)(start, old_len, len, flags);
+			result = (*real_mremap)(start, old_len, len, flags);
+
+		if ((result != MAP_FAILED) && dl_ase_mem_remap_hook)
+			(*dl_ase_mem_remap_hook)(start, old_len, result, len);
+
+		return result;
 	}
 
 	errno = EINVAL;
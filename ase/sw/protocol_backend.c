@@ -31,7 +31,13 @@
  * - Interface to page table
  */
 #include "ase_common.h"
+#include "ase_event.h"
 #include "ase_host_memory.h"
+#include "ase_log.h"
+#include "ase_mq_ring.h"
+#include "ase_mq_mux.h"
+#include "ase_wc.h"
+#include "ase_zcopy.h"
 #include "pcie_ss_tlp_stream.h"
 #include "pcie_tlp_stream.h"
 
@@ -55,12 +61,30 @@ int sim2app_membus_wr_req_tx;
 int app2sim_membus_wr_rsp_rx;
 int sim2app_pcie_msg_tx;
 int app2sim_pcie_msg_rx;
-static int intr_event_fds[MAX_USR_INTRS];
 
 int glbl_test_cmplt_cnt;                // Keeps the number of session_deinits received
 
-volatile int sockserver_kill;
-static pthread_t socket_srv_tid;
+// Event socket server, watched by the message queue IO thread
+static int event_srv_fd = -1;
+static char event_srv_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+
+// Session state
+static int   session_empty;
+static char *glbl_session_id;
+
+// Features this simulator supports and those negotiated with the
+// application at ASE_INIT (ASE_FEATURE_*)
+static uint32_t sim_features;
+static uint32_t session_features;
+
+// Session socket. Requests are received by the IO thread and served by
+// ase_listener(), which owns the session state.
+static int session_srv_fd = -1;
+static char session_srv_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static int session_req_fd = -1;
+static int32_t session_req_pid;
+static uint32_t session_req_features;
+static uint32_t session_req_pending;
 
 // MMIO Respons lock
 static pthread_mutex_t mmio_resp_lock = PTHREAD_MUTEX_INITIALIZER;
@@ -91,40 +115,18 @@ int self_destruct_in_progress;
 // work Directory location
 char *ase_workdir_path;
 
+// HSSI channel plugins from ase.cfg. HSSI_PLUGIN_CHAN<n> entries take
+// precedence over HSSI_PLUGIN, wherever they are in the file.
+char *hssi_plugin_path[ASE_HSSI_MAX_CHANNELS];
+static bool hssi_plugin_chan_set[ASE_HSSI_MAX_CHANNELS];
+
 // Incoming UMSG packet (allocated in ase_init, deallocated in start_simkill_countdown)
 static struct umsgcmd_t *incoming_umsg_pkt;
 
 // Incoming MMIO packet (allocated in ase_init, deallocated in start_simkill_countdown)
 static struct mmio_t *incoming_mmio_pkt;
 
-/*
- * ASE capability register
- * Purpose: This is the response for portctrl_cmd requests (as an ACK)
- */
-struct ase_capability_t ase_capability = {
-	ASE_UNIQUE_ID,
-	/* UMsg feature interrupt */
-#ifdef ASE_ENABLE_UMSG_FEATURE
-	1,
-#else
-	0,
-#endif
-	/* Interrupt feature interrupt */
-#ifdef ASE_ENABLE_INTR_FEATURE
-	1,
-#else
-	0,
-#endif
-	/* 512-bit MMIO support */
-#ifdef ASE_ENABLE_MMIO512
-	1
-#else
-	0
-#endif
-};
-
 const char *event_log_name = "ccip_transactions.tsv";
-const char *completed_str_msg = (char *)&ase_capability;
 
 /*
  * Generate scope data
@@ -330,6 +332,87 @@ void memline_addr_error(const char *access_type,
 }
 
 
+/*
+ * CCI-P host memory requests are pipelined. Reads are sent to the
+ * application as they leave the RTL latency model and the RTL collects
+ * the responses, in request order, in later cycles. Record which
+ * outstanding reads were satisfied from a zero-copy buffer so the
+ * matching rd_memline_rsp_dex call doesn't wait for the application.
+ * The RTL keeps fewer than MEMLINE_LOCAL_FIFO_SIZE reads in flight.
+ *
+ * Writes are posted. The AFU's write response comes from the RTL and
+ * the application's response only reports whether the address was
+ * valid, so write responses are consumed whenever they arrive.
+ */
+#define MEMLINE_LOCAL_FIFO_SIZE 128
+
+typedef struct {
+	bool local[MEMLINE_LOCAL_FIFO_SIZE];
+	uint32_t rd_idx;
+	uint32_t wr_idx;
+} memline_local_fifo;
+
+static memline_local_fifo rd_memline_local;
+
+// Writes sent to the application and not yet acknowledged. Zero-copy
+// writes must not pass them, nor may reads of the same lines.
+static uint32_t wr_memline_msg_pending;
+
+// CCI-P clock count, used to time out writes held for combining
+static uint64_t wr_memline_cycle;
+
+static inline void memline_local_push(memline_local_fifo *f, bool local)
+{
+	f->local[f->wr_idx++ % MEMLINE_LOCAL_FIFO_SIZE] = local;
+}
+
+// Is the oldest entry local? False when empty.
+static inline bool memline_local_head(const memline_local_fifo *f)
+{
+	return (f->rd_idx != f->wr_idx) &&
+		f->local[f->rd_idx % MEMLINE_LOCAL_FIFO_SIZE];
+}
+
+static inline void memline_local_pop(memline_local_fifo *f)
+{
+	if (f->rd_idx != f->wr_idx)
+		f->rd_idx++;
+}
+
+
+/*
+ * Consume write responses from the application. With wait set, block
+ * until every write sent so far is acknowledged. This is the fence
+ * before anything that could observe the writes: write fences,
+ * interrupts, MMIO responses and AFU reads of lines still being
+ * written.
+ */
+static void wr_memline_complete(bool wait)
+{
+	ase_host_memory_write_rsp wr_rsp;
+	int status;
+
+	// A held write is not visible to the application yet
+	if (wait)
+		wr_memline_msg_pending += ase_wc_flush();
+
+	while (wr_memline_msg_pending) {
+		status = mqueue_recv(app2sim_membus_wr_rsp_rx, (char *) &wr_rsp, sizeof(wr_rsp));
+
+		if (status == ASE_MSG_PRESENT) {
+			wr_memline_msg_pending -= ase_wc_acked(&wr_rsp);
+			if (wr_rsp.status != HOST_MEM_STATUS_VALID)
+				memline_addr_error("WRITE", wr_rsp.status, wr_rsp.pa, wr_rsp.va);
+		}
+		// Error?  Probably channel closed and the simulator will be closing
+		// soon.
+		else if ((status == ASE_MSG_ERROR) || !wait) {
+			break;
+		}
+	}
+}
+
+
 /*
  * DPI: Write line request (sent to application)
  */
@@ -385,10 +468,13 @@ void wr_memline_req_dex(cci_pkt *pkt)
 #endif
 		}
 
-		mqueue_send(sim2app_membus_wr_req_tx, (char *) &wr_req, sizeof(wr_req));
+		// Zero-copy writes may proceed once earlier writes are done
+		wr_memline_complete(false);
 
-		// Send the data separately
-		mqueue_send(sim2app_membus_wr_req_tx, payload, wr_req.data_bytes);
+		if ((wr_memline_msg_pending != 0) || ase_wc_held() ||
+		    !ase_zcopy_write(&wr_req, payload)) {
+			wr_memline_msg_pending += ase_wc_write(&wr_req, payload, wr_memline_cycle);
+		}
 
 		// Success
 		pkt->success = 1;
@@ -396,10 +482,19 @@ void wr_memline_req_dex(cci_pkt *pkt)
 		/*
 		 * Interrupt operation
 		 */
-		// Trigger interrupt action
+		// Trigger interrupt action once the AFU's writes are visible
+		wr_memline_complete(true);
 		intr_id = pkt->intr_id;
 		ase_interrupt_generator(intr_id);
 
+		// Success
+		pkt->success = 1;
+	} else if (pkt->mode == CCIPKT_WRFENCE_MODE) {
+		/*
+		 * Write fence: earlier writes must be complete
+		 */
+		wr_memline_complete(true);
+
 		// Success
 		pkt->success = 1;
 	}
@@ -415,33 +510,13 @@ void wr_memline_rsp_dex(cci_pkt *pkt)
 {
 	FUNC_CALL_ENTRY;
 
-	ase_host_memory_write_rsp wr_rsp;
-	int status;
-
-	// The only task required here is to consume the response from the application.
-	// triggered by wr_memline_req_dex. The response indicates whether the address
-	// was valid.  Raise an error for invalid addresses.
-
-	if (pkt->mode == CCIPKT_WRITE_MODE) {
-		while (true) {
-			status = mqueue_recv(app2sim_membus_wr_rsp_rx, (char *) &wr_rsp, sizeof(wr_rsp));
-
-			if (status == ASE_MSG_PRESENT) {
-				if (wr_rsp.status != HOST_MEM_STATUS_VALID) {
-					memline_addr_error("WRITE", wr_rsp.status, wr_rsp.pa, wr_rsp.va);
-					pkt->success = 0;
-				}
-				break;
-			}
-
-			// Error?  Probably channel closed and the simulator will be closing
-			// soon.
-			if (status == ASE_MSG_ERROR) {
-				pkt->success = 0;
-				break;
-			}
-		}
-	}
+	// The only task required here is to consume responses from the
+	// application, triggered by wr_memline_req_dex. Responses report
+	// invalid addresses and acknowledge groups of writes. They may arrive
+	// later than the RTL's write response to the AFU, so don't wait for
+	// them.
+	UNUSED_PARAM(pkt);
+	wr_memline_complete(false);
 
 	FUNC_CALL_EXIT;
 }
@@ -463,31 +538,59 @@ void rd_memline_req_dex(cci_pkt *pkt)
 	rd_req.req = HOST_MEM_REQ_READ;
 	rd_req.addr = phys_addr;
 	rd_req.data_bytes = CL_BYTE_WIDTH;
-	mqueue_send(sim2app_membus_rd_req_tx, (char *) &rd_req, sizeof(rd_req));
+
+	// Reads must see earlier writes to the same line. The application
+	// serves reads and writes on different threads, so wait for them.
+	// Writes to other lines stay in flight.
+	wr_memline_complete(false);
+	if (ase_wc_overlaps(rd_req.addr, rd_req.data_bytes, wr_memline_msg_pending))
+		wr_memline_complete(true);
+
+	// Zero-copy reads fill the packet now. The packet is carried
+	// to rd_memline_rsp_dex() by the RTL.
+	if (ase_zcopy_read(&rd_req, pkt->qword)) {
+		memline_local_push(&rd_memline_local, true);
+	} else {
+		mqueue_send(sim2app_membus_rd_req_tx, (char *) &rd_req, sizeof(rd_req));
+		memline_local_push(&rd_memline_local, false);
+	}
 
 	FUNC_CALL_EXIT;
 }
 
 
 /*
- * DPI: Read line data response
+ * DPI: Read line data response for the oldest outstanding read. Never
+ * blocks waiting for the application. Returns 1 when the read is
+ * complete and pkt holds the data, 0 when the application hasn't
+ * responded yet.
  */
-void rd_memline_rsp_dex(cci_pkt *pkt)
+int rd_memline_rsp_dex(cci_pkt *pkt)
 {
 	FUNC_CALL_ENTRY;
 
 	ase_host_memory_read_rsp rd_rsp;
 	int status;
 
-	while (true) {
-		status = mqueue_recv(app2sim_membus_rd_rsp_rx, (char *) &rd_rsp, sizeof(rd_rsp));
+	// Already satisfied from a zero-copy buffer?
+	if (memline_local_head(&rd_memline_local)) {
+		memline_local_pop(&rd_memline_local);
+		FUNC_CALL_EXIT;
+		return 1;
+	}
 
-		if (status == ASE_MSG_PRESENT) {
-			if (rd_rsp.status != HOST_MEM_STATUS_VALID) {
-				memline_addr_error("READ", rd_rsp.status, rd_rsp.pa, rd_rsp.va);
-				break;
-			}
+	status = mqueue_recv(app2sim_membus_rd_rsp_rx, (char *) &rd_rsp, sizeof(rd_rsp));
+	if (status == ASE_MSG_ABSENT) {
+		FUNC_CALL_EXIT;
+		return 0;
+	}
 
+	memline_local_pop(&rd_memline_local);
+
+	if (status == ASE_MSG_PRESENT) {
+		if (rd_rsp.status != HOST_MEM_STATUS_VALID) {
+			memline_addr_error("READ", rd_rsp.status, rd_rsp.pa, rd_rsp.va);
+		} else {
 			if (rd_rsp.data_bytes != CL_BYTE_WIDTH) {
 				ASE_ERR("\n @ERROR: Unexpected memory read response size (%ld)!\n", rd_rsp.data_bytes);
 				start_simkill_countdown();
@@ -497,18 +600,16 @@ void rd_memline_rsp_dex(cci_pkt *pkt)
 			while ((status = mqueue_recv(app2sim_membus_rd_rsp_rx, (char *) pkt->qword, CL_BYTE_WIDTH)) != ASE_MSG_PRESENT) {
 				if (status == ASE_MSG_ERROR) break;
 			}
-			break;
-		}
-
-		// Error?  Probably channel closed and the simulator will be closing
-		// soon.
-		if (status == ASE_MSG_ERROR) {
-			pkt->success = 0;
-			break;
 		}
 	}
 
+	// Error?  Probably channel closed and the simulator will be closing
+	// soon.
+	if (status == ASE_MSG_ERROR)
+		pkt->success = 0;
+
 	FUNC_CALL_EXIT;
+	return 1;
 }
 
 
@@ -529,6 +630,9 @@ void mmio_response(struct mmio_t *mmio_pkt)
 	print_mmiopkt(fp_memaccess_log, "MMIO Got ", mmio_pkt);
 #endif
 
+	// Software may look at memory written by the AFU before the response
+	wr_memline_complete(true);
+
 	// Send MMIO Response
 	mqueue_send(sim2app_mmiorsp_tx, (char *) mmio_pkt, sizeof(mmio_t));
 
@@ -540,31 +644,61 @@ void mmio_response(struct mmio_t *mmio_pkt)
 
 
 /*
- * ASE Interrupt generator handle
+ * Answer a port control request
  */
-void ase_interrupt_generator(int id)
+static void portctrl_respond(void)
 {
-	int cnt;
+	struct ase_portctrl_rsp rsp;
 
-	if (id >= MAX_USR_INTRS) {
-		ASE_ERR("SIM-C : Interrupt #%d > avail. interrupts (%d)!\n",
-			id, MAX_USR_INTRS);
-		return;
-	}
+	rsp.version = ASE_CTRL_VERSION;
+	rsp.features = session_features;
+	mqueue_send(sim2app_portctrl_rsp_tx, (char *) &rsp, sizeof(rsp));
+}
 
-	if (intr_event_fds[id] < 0) {
-		ASE_ERR("SIM-C : No valid event for AFU interrupt %d!\n", id);
-	} else {
-		uint64_t val = 1;
 
-		cnt = write(intr_event_fds[id], &val, sizeof(uint64_t));
-		if (cnt < 0) {
-			ASE_ERR("SIM-C : Error writing fd %d errno = %s\n",
-				intr_event_fds[id], strerror(errno));
+/*
+ * Log pinned and unpinned host memory pages. The pages are not shared
+ * with the simulator, which sends read/write memory requests to the
+ * application.
+ */
+static void pin_notes_log(const struct ase_pin_note *note, uint32_t num_notes)
+{
+	static char logger_str[ASE_LOGGER_LEN];
+	uint32_t i;
+
+	for (i = 0; i < num_notes; i += 1) {
+		if (note[i].pinned) {
+			snprintf(logger_str,
+				 ASE_LOGGER_LEN,
+				 "Pinned host memory page =>\n"
+				 "\t\tHost app virtual addr   = 0x%" PRIx64 "\n"
+				 "\t\tHW physical addr (byte) = 0x%" PRIx64 "\n"
+				 "\t\tHW physical addr (line) = 0x%" PRIx64 "\n"
+				 "\t\tPage size (bytes)       = %" PRIu32 "\n",
+				 note[i].va,
+				 note[i].iova,
+				 note[i].iova >> 6,
+				 note[i].length);
 		} else {
-			ASE_MSG("SIM-C : AFU Interrupt event %d\n", id);
+			snprintf(logger_str,
+				 ASE_LOGGER_LEN,
+				 "Unpinned host memory page =>\n"
+				 "\t\tHW physical addr (byte) = 0x%" PRIx64 "\n"
+				 "\t\tHW physical addr (line) = 0x%" PRIx64 "\n"
+				 "\t\tPage size (bytes)       = %" PRIu32 "\n",
+				 note[i].iova,
+				 note[i].iova >> 6,
+				 note[i].length);
 		}
+
+		buffer_msg_inject(1, logger_str);
+
+		if (fp_workspace_log != NULL)
+			fprintf(fp_workspace_log, "%s", logger_str);
 	}
+
+	if (fp_workspace_log != NULL)
+		fflush(fp_workspace_log);
 }
 
 
@@ -576,8 +710,7 @@ void sw_reset_response(void)
 	FUNC_CALL_ENTRY;
 
 	// Send portctrl_rsp message
-	mqueue_send(sim2app_portctrl_rsp_tx, completed_str_msg,
-		    ASE_MQ_MSGSIZE);
+	portctrl_respond();
 
 	FUNC_CALL_EXIT;
 }
@@ -665,157 +798,259 @@ void update_fme_dfh(struct buffer_t *umas)
 	*csr_umsg_base_address = (uint64_t) umas->pbase;
 }
 
-int read_fd(int sock_fd)
-{
-	struct msghdr msg = {0};
-	char buf[CMSG_SPACE(sizeof(int))];
-	struct event_request req = { .type = 0, .flags = 0 };
-	struct iovec io = { .iov_base = &req, .iov_len = sizeof(req) };
-	struct cmsghdr *cmsg;
-	int *fdptr;
-
-	ase_memset(buf, '\0', sizeof(buf));
-	msg.msg_iov = &io;
-	msg.msg_iovlen = 1;
-	msg.msg_control = buf;
-	msg.msg_controllen = sizeof(buf);
-
-	cmsg = (struct cmsghdr *)buf;
-	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
-	cmsg->cmsg_level = SOL_SOCKET;
-	cmsg->cmsg_type = SCM_RIGHTS;
-
-	msg.msg_name = NULL;
-	msg.msg_namelen = 0;
-	msg.msg_iov = &io;
-	msg.msg_iovlen = 1;
-	msg.msg_control = cmsg;
-	msg.msg_controllen = CMSG_LEN(sizeof(int));
-	msg.msg_flags = 0;
-
-	if (recvmsg(sock_fd, &msg, 0) < 0) {
-		ASE_ERR("SIM-C : Unable to rcvmsg from socket\n");
-		return 1;
-	}
-
-	cmsg = CMSG_FIRSTHDR(&msg);
-	if (cmsg == NULL) {
-		ASE_ERR("SIM-C : Null pointer from rcvmsg socket\n");
-		return 1;
-	}
 
-	int vector_id = 0;
+/*
+ * Serve event socket connections. Runs on the IO thread when the
+ * listening socket is readable.
+ */
+static void event_srv_accept(int sock_fd, void *arg)
+{
+	UNUSED_PARAM(arg);
 
-	fdptr = (int *)CMSG_DATA(cmsg);
+	// A client that stalls must not hold up the IO thread
+	struct timeval tv = { .tv_sec = 1, .tv_usec = 0 };
+	int sock_msg;
 
-	if (req.type == REGISTER_EVENT) {
-		vector_id = req.flags;
-		intr_event_fds[vector_id] = *fdptr;
-	}
-	if (req.type == UNREGISTER_EVENT) {
-		int i;
-		// locate the interrupt vector to unregister
-		// from the event handle
-		for (i = 0; i < MAX_USR_INTRS; i++) {
-			if (intr_event_fds[vector_id] == *fdptr)
-				intr_event_fds[vector_id] = -1;
-		}
+	while ((sock_msg = accept(sock_fd, NULL, NULL)) >= 0) {
+		setsockopt(sock_msg, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+		if (ase_event_request(sock_msg) != 0)
+			ASE_ERR("SIM-C : Event socket request failed\n");
+		close(sock_msg);
+#ifdef ASE_DEBUG
+		ASE_MSG("SIM-C : accept success\n");
+#endif
 	}
-	return 0;
+
+	if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+		ASE_ERR("SIM-C : accept error=%s\n", strerror(errno));
 }
 
-static void *start_socket_srv(void *args)
+
+/*
+ * Start the event socket server for a session. Connections are served
+ * by the message queue IO thread, which blocks in epoll_wait() between
+ * them.
+ */
+static int event_srv_start(void)
 {
-	int res = 0;
-	int err_cnt = 0;
-	int sock_msg = 0;
-	int sock_fd;
 	struct sockaddr_un saddr;
-	socklen_t addrlen;
-	struct timeval tv;
-	fd_set readfds;
-
-	pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
+	int res;
 
-	sock_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-	if (sock_fd == -1) {
+	event_srv_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (event_srv_fd == -1) {
 		ASE_ERR("SIM-C : Error opening event socket: %s",
 			strerror(errno));
-		err_cnt++;
-		return args;
+		return -1;
 	}
 
-	// set socket type to non blocking
-	fcntl(sock_fd, F_SETFL, O_NONBLOCK);
-	fcntl(sock_fd, F_SETFL, O_ASYNC);
 	saddr.sun_family = AF_UNIX;
-
 	res = generate_sockname(saddr.sun_path);
 	if (res < 0) {
 		ASE_ERR("%s: Error strncpy_s\n", __func__);
-		err_cnt++;
 		goto err;
 	}
 
 	// unlink previous addresses in use (if any)
 	unlink(saddr.sun_path);
-	addrlen = sizeof(struct sockaddr_un);
-	if (bind(sock_fd, (struct sockaddr *)&saddr, addrlen) < 0) {
+	if (bind(event_srv_fd, (struct sockaddr *)&saddr, sizeof(struct sockaddr_un)) < 0) {
 		ASE_ERR("SIM-C : Error binding event socket: %s\n",
 			strerror(errno));
-		err_cnt++;
 		goto err;
 	}
+	ase_memcpy(event_srv_path, saddr.sun_path, sizeof(event_srv_path));
 
 	ASE_MSG("SIM-C : Creating Socket Server@%s...\n", saddr.sun_path);
-	if (listen(sock_fd, 5) < 0) {
+	if (listen(event_srv_fd, 5) < 0) {
 		ASE_ERR("SIM-C : Socket server listen failed with error:%s\n",
 			strerror(errno));
-		err_cnt++;
-		goto err;
+		goto err_unlink;
 	}
 
+	if (ase_mq_mux_add_fd(event_srv_fd, &event_srv_accept, NULL) != 0)
+		goto err_unlink;
+
 	ASE_MSG("SIM-C : Started listening on server %s\n", saddr.sun_path);
-	tv.tv_usec = 0;
-	FD_ZERO(&readfds);
-
-	do {
-		FD_SET(sock_fd, &readfds);
-		res = TEMP_FAILURE_RETRY(select(sock_fd+1, &readfds, NULL, NULL, &tv));
-		if (res < 0) {
-			ASE_ERR("SIM-C : select error=%s\n", strerror(errno));
-			err_cnt++;
-			break;
-		}
-		if (FD_ISSET(sock_fd, &readfds)) {
-			sock_msg = accept(sock_fd, (struct sockaddr *)&saddr,
-					  &addrlen);
-			if (sock_msg == -1) {
-				ASE_ERR("SIM-C : accept error=%s\n",
-					strerror(errno));
-				err_cnt++;
-				break;
-			}
-			if (read_fd(sock_msg) != 0) {
-				err_cnt++;
-				break;
-			}
-#ifdef ASE_DEBUG
-			ASE_MSG("SIM-C : accept success\n");
-#endif
+	return 0;
+
+err_unlink:
+	unlink(event_srv_path);
+err:
+	close(event_srv_fd);
+	event_srv_fd = -1;
+	return -1;
+}
+
+
+static void event_srv_stop(void)
+{
+	if (event_srv_fd == -1)
+		return;
+
+	ase_mq_mux_del_fd(event_srv_fd);
+	close(event_srv_fd);
+	unlink(event_srv_path);
+	event_srv_fd = -1;
+
+	ASE_MSG("SIM-C : Exiting event socket server@%s...\n", event_srv_path);
+}
+
+
+/*
+ * Start a session for application pid, requested either by ASE_INIT
+ * or over the session socket. features are those the application
+ * supports.
+ */
+static void session_start(int pid, uint32_t features)
+{
+	ASE_INFO("Session requested by PID = %d\n", pid);
+	session_features = sim_features & features;
+	// Generate new timestamp
+	put_timestamp();
+
+	// Generate session ID path
+	snprintf(tstamp_filepath, ASE_FILEPATH_LEN,
+		 "%s/%s", ase_workdir_path,
+		 TSTAMP_FILENAME);
+
+	// Print timestamp
+	glbl_session_id = ase_malloc(20);
+	get_timestamp(glbl_session_id);
+	ASE_MSG("Session ID => %s\n",
+		glbl_session_id);
+
+	session_empty = 0;
+
+	// Listen for events before the application is told to go ahead
+	if (event_srv_start() != 0) {
+		ASE_ERR("FAILED Event server \
+		failed to start\n");
+		exit(1);
+	}
+	ASE_MSG("Event socket server started\n");
+}
+
+
+/*
+ * Receive session requests. Runs on the IO thread when the session
+ * socket is readable. One request is handed to ase_listener() at a time.
+ */
+static void session_srv_accept(int sock_fd, void *arg)
+{
+	UNUSED_PARAM(arg);
+
+	struct timeval tv = { .tv_sec = 1, .tv_usec = 0 };
+	struct ase_session_req req;
+	struct ase_session_rsp rsp;
+	int sock_msg;
+
+	while ((sock_msg = accept(sock_fd, NULL, NULL)) >= 0) {
+		setsockopt(sock_msg, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+		if ((TEMP_FAILURE_RETRY(recv(sock_msg, &req, sizeof(req), MSG_WAITALL)) != sizeof(req)) ||
+		    (req.version != ASE_CTRL_VERSION) ||
+		    __atomic_load_n(&session_req_pending, __ATOMIC_ACQUIRE)) {
+			// The application will fall back to ASE_INIT
+			ase_memset(&rsp, 0, sizeof(rsp));
+			rsp.status = -1;
+			send(sock_msg, &rsp, sizeof(rsp), MSG_NOSIGNAL);
+			close(sock_msg);
+			continue;
 		}
-		if (sockserver_kill)
-			break;
-	} while (res >= 0);
 
-	ASE_MSG("SIM-C : Exiting event socket server@%s...\n", saddr.sun_path);
+		session_req_fd = sock_msg;
+		session_req_pid = req.pid;
+		session_req_features = req.features;
+		__atomic_store_n(&session_req_pending, 1, __ATOMIC_RELEASE);
+	}
 
-err:
-	close(sock_msg);
-	close(sock_fd);
+	if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+		ASE_ERR("SIM-C : Session socket accept error=%s\n", strerror(errno));
+}
+
+
+/*
+ * Start the session requested over the session socket and reply.
+ * Called by ase_listener().
+ */
+static void session_srv_serve(void)
+{
+	struct ase_session_rsp rsp;
+
+	session_start(session_req_pid, session_req_features);
+
+	ase_memset(&rsp, 0, sizeof(rsp));
+	rsp.status = 0;
+	ase_memcpy(rsp.session_id, glbl_session_id, sizeof(rsp.session_id));
+	rsp.ctrl.version = ASE_CTRL_VERSION;
+	rsp.ctrl.features = session_features;
+	if (send(session_req_fd, &rsp, sizeof(rsp), MSG_NOSIGNAL) != sizeof(rsp))
+		ASE_ERR("SIM-C : Session response not sent: %s\n", strerror(errno));
+
+	close(session_req_fd);
+	session_req_fd = -1;
+	__atomic_store_n(&session_req_pending, 0, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * Listen on the session socket in the work directory. Without it,
+ * applications use ASE_INIT, so failures are not fatal.
+ */
+static void session_srv_start(void)
+{
+	struct sockaddr_un saddr;
+	int len;
+
+	saddr.sun_family = AF_UNIX;
+	len = snprintf(saddr.sun_path, sizeof(saddr.sun_path), "%s/%s",
+		       ase_workdir_path, ASE_SESSION_SOCKNAME);
+	if ((len < 0) || (len >= (int)sizeof(saddr.sun_path))) {
+		ASE_MSG("Work directory path too long for the session socket\n");
+		return;
+	}
+
+	session_srv_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (session_srv_fd == -1) {
+		ASE_ERR("SIM-C : Error opening session socket: %s\n", strerror(errno));
+		return;
+	}
+
+	unlink(saddr.sun_path);
+	if ((bind(session_srv_fd, (struct sockaddr *)&saddr, sizeof(saddr)) < 0) ||
+	    (listen(session_srv_fd, 5) < 0)) {
+		ASE_ERR("SIM-C : Session socket setup failed: %s\n", strerror(errno));
+		goto err;
+	}
+	ase_memcpy(session_srv_path, saddr.sun_path, sizeof(session_srv_path));
+
+	if (ase_mq_mux_add_fd(session_srv_fd, &session_srv_accept, NULL) != 0)
+		goto err_unlink;
+
+	ASE_MSG("Session socket at $ASE_WORKDIR/%s\n", ASE_SESSION_SOCKNAME);
+	return;
+
+err_unlink:
 	unlink(saddr.sun_path);
-	sockserver_kill = 0;
-	return args;
+err:
+	close(session_srv_fd);
+	session_srv_fd = -1;
+}
+
+
+static void session_srv_stop(void)
+{
+	if (session_srv_fd == -1)
+		return;
+
+	ase_mq_mux_del_fd(session_srv_fd);
+	close(session_srv_fd);
+	unlink(session_srv_path);
+	session_srv_fd = -1;
+
+	if (session_req_fd != -1)
+		close(session_req_fd);
+	session_req_fd = -1;
+	session_req_pending = 0;
 }
 
 
@@ -842,18 +1077,18 @@ int ase_listener(int mode)
 	int  portctrl_value;
 
 	// Portctrl variables
-	static char portctrl_msgstr[ASE_MQ_MSGSIZE];
+	static uint64_t portctrl_msg[ASE_MQ_MSGSIZE / sizeof(uint64_t)];
+	struct ase_portctrl_req *portctrl_req = (struct ase_portctrl_req *) portctrl_msg;
 	static char logger_str[ASE_LOGGER_LEN];
 	static char umsg_mapstr[ASE_MQ_MSGSIZE];
 
-	// Session status
-	static int   session_empty;
-	static char *glbl_session_id;
-
 	//umsg, lookup before issuing UMSG
 	static int   glbl_umsgmode;
 	char umsg_mode_msg[ASE_LOGGER_LEN];
 
+	// A message was received by the previous call, so more may be queued
+	static bool  rx_active = true;
+
 	//   FUNC_CALL_ENTRY;
 
     if (mode > 0)
@@ -861,27 +1096,56 @@ int ase_listener(int mode)
         // PCIe TLP mode
         event_log_name = "log_ase_events.tsv";
     }
+    else
+    {
+        // Send CCI-P DMA writes whose combining window has expired
+        wr_memline_cycle += 1;
+        wr_memline_msg_pending += ase_wc_tick(wr_memline_cycle);
+    }
 
 	// ---------------------------------------------------------------------- //
 	/*
 	 * Port Control message
-	 * Format: <cmd> <value>
+	 * Format: struct ase_portctrl_req
 	 * -----------------------------------------------------------------
 	 * Supported commands       |
-	 * ASE_INIT   <APP_PID>     | Session control - sends PID to
-	 *                          |
+	 * ASE_INIT   <APP_PID>     | Session control - sends PID and
+	 *                          | features to negotiate
 	 * AFU_RESET  <0,1>         | AFU reset handle
 	 * UMSG_MODE  <8-bit mask>  | UMSG mode control
+	 * ASE_PIN_NOTES            | Pinned page notes, for logging only
 	 *
-	 * ASE responds with "COMPLETED" as a string, there is no
-	 * expectation of a string check
+	 * ASE responds with struct ase_portctrl_rsp, except to
+	 * ASE_PIN_NOTES
 	 *
 	 */
 	// Simulator is not in lockdown mode (simkill not in progress)
 	if (self_destruct_in_progress == 0) {
-		if (mqueue_recv(app2sim_portctrl_req_rx, (char *)portctrl_msgstr, ASE_MQ_MSGSIZE) == ASE_MSG_PRESENT) {
-			sscanf_s_ii(portctrl_msgstr, "%d %d", &rx_portctrl_cmd, &portctrl_value);
-			if (rx_portctrl_cmd == AFU_RESET) {
+		// Session requested over the session socket
+		if (__atomic_load_n(&session_req_pending, __ATOMIC_ACQUIRE))
+			session_srv_serve();
+
+		// Nothing arrived on any channel since the last call
+		if (!rx_active && !mqueue_rx_pending())
+			return 0;
+		rx_active = false;
+
+		if (mqueue_recv(app2sim_portctrl_req_rx, (char *)portctrl_msg, ASE_MQ_MSGSIZE) == ASE_MSG_PRESENT) {
+			rx_active = true;
+			rx_portctrl_cmd = portctrl_req->cmd;
+			portctrl_value = portctrl_req->value;
+			if (portctrl_req->version != ASE_CTRL_VERSION) {
+				// The response tells the application which version
+				// this simulator speaks
+				ASE_ERR("Port control protocol version mismatch, application %u, simulator %u ... IGNORING\n",
+					portctrl_req->version, ASE_CTRL_VERSION);
+				portctrl_respond();
+			} else if (rx_portctrl_cmd == ASE_PIN_NOTES) {
+				// No response, notes are sent lazily by the application
+				if (portctrl_req->num_notes <= ASE_PIN_NOTES_MAX)
+					pin_notes_log((const struct ase_pin_note *) (portctrl_req + 1),
+						      portctrl_req->num_notes);
+			} else if (rx_portctrl_cmd == AFU_RESET) {
 				// AFU Reset control
 				portctrl_value = (portctrl_value != 0) ? 1 : 0 ;
 
@@ -898,43 +1162,23 @@ int ase_listener(int mode)
 				buffer_msg_inject(1, umsg_mode_msg);
 
 				// Send portctrl_rsp message
-				mqueue_send(sim2app_portctrl_rsp_tx, completed_str_msg, ASE_MQ_MSGSIZE);
+				portctrl_respond();
 			} else if (rx_portctrl_cmd == ASE_INIT) {
-				ASE_INFO("Session requested by PID = %d\n", portctrl_value);
-				// Generate new timestamp
-				put_timestamp();
-
-				// Generate session ID path
-				snprintf(tstamp_filepath, ASE_FILEPATH_LEN,
-					 "%s/%s", ase_workdir_path,
-					 TSTAMP_FILENAME);
-
-				// Print timestamp
-				glbl_session_id = ase_malloc(20);
-				get_timestamp(glbl_session_id);
-				ASE_MSG("Session ID => %s\n",
-					glbl_session_id);
-
-				session_empty = 0;
+				session_start(portctrl_value, portctrl_req->features);
 
 				// Send portctrl_rsp message
-				mqueue_send(sim2app_portctrl_rsp_tx, completed_str_msg, ASE_MQ_MSGSIZE);
-
-				int thr_err = pthread_create(&socket_srv_tid,
-							     NULL, &start_socket_srv, NULL);
-
-				if (thr_err != 0) {
-					ASE_ERR("FAILED Event server \
-					failed to start\n");
-					exit(1);
-				}
-				ASE_MSG("Event socket server started\n");
+				portctrl_respond();
 			} else if (rx_portctrl_cmd == ASE_SIMKILL) {
 #ifdef ASE_DEBUG
 				ASE_MSG("ASE_SIMKILL requested, processing options... \n");
 #endif
 
-				sockserver_kill = 1;
+				event_srv_stop();
+				ase_event_session_end();
+
+				// The application is gone. Its IOVAs may be reused by the
+				// next session.
+				ase_zcopy_unmap_all();
 				// ------------------------------------------------------------- //
 				// Update regression counter
 				glbl_test_cmplt_cnt = glbl_test_cmplt_cnt + 1;
@@ -978,9 +1222,7 @@ int ase_listener(int mode)
 #endif
 
 				// Send portctrl_rsp message
-				mqueue_send(sim2app_portctrl_rsp_tx,
-					    completed_str_msg,
-					    ASE_MQ_MSGSIZE);
+				portctrl_respond();
 
 				// Clean up session OD
 				ase_free_buffer(glbl_session_id);
@@ -989,9 +1231,7 @@ int ase_listener(int mode)
 					("Undefined Port Control function ... IGNORING\n");
 
 				// Send portctrl_rsp message
-				mqueue_send(sim2app_portctrl_rsp_tx,
-					    completed_str_msg,
-					    ASE_MQ_MSGSIZE);
+				portctrl_respond();
 			}
 		}
 
@@ -1003,62 +1243,46 @@ int ase_listener(int mode)
 		if (mqueue_recv
 		    (app2sim_alloc_rx, (char *) incoming_alloc_msgstr,
 		     ASE_MQ_MSGSIZE) == ASE_MSG_PRESENT) {
+			rx_active = true;
+
 			// Typecast string to buffer_t
 			ase_memcpy((char *) &ase_buffer,
 				   incoming_alloc_msgstr,
 				   sizeof(struct buffer_t));
 
-			if (ase_buffer.is_pinned) {
-				// Pinned buffer (host memory) messages are sent only for
-				// logging. The actual buffer is not shared with the simulator.
-				// The simulator will send read/write memory requests to the
-				// application.
-				snprintf(logger_str,
-						 ASE_LOGGER_LEN,
-						 "Pinned host memory page =>\n"
-						 "\t\tHost app virtual addr   = 0x%" PRIx64 "\n"
-						 "\t\tHW physical addr (byte) = 0x%" PRIx64 "\n"
-						 "\t\tHW physical addr (line) = 0x%" PRIx64 "\n"
-						 "\t\tPage size (bytes)       = %" PRId32 "\n",
-						 ase_buffer.vbase,
-						 ase_buffer.fake_paddr,
-						 ase_buffer.fake_paddr >> 6,
-						 ase_buffer.memsize);
+			// Allocate action
+			ase_shmem_alloc_action(&ase_buffer);
+			ase_buffer.is_privmem = 0;
+			if (ase_buffer.index == 0) {
+				ase_buffer.is_mmiomap = 1;
 			} else {
-				// Allocate action
-				ase_shmem_alloc_action(&ase_buffer);
-				ase_buffer.is_privmem = 0;
-				if (ase_buffer.index == 0) {
-					ase_buffer.is_mmiomap = 1;
-				} else {
-					ase_buffer.is_mmiomap = 0;
-				}
-
-				char *buffer_class = "Buffer";
-				if (ase_buffer.is_mmiomap) {
-					buffer_class = "MMIO map";
-					initialize_fme_dfh(&ase_buffer);
-				} else if (ase_buffer.is_umas) {
-					buffer_class = "UMAS";
-					update_fme_dfh(&ase_buffer);
-				}
+				ase_buffer.is_mmiomap = 0;
+			}
 
-				snprintf(logger_str,
-						 ASE_LOGGER_LEN,
-						 "%s allocated, index %d (located /dev/shm%s) =>\n"
-						 "\t\tHost app virtual addr   = 0x%" PRIx64 "\n"
-						 "\t\tHW physical addr (byte) = 0x%" PRIx64 "\n"
-						 "\t\tHW physical addr (line) = 0x%" PRIx64 "\n"
-						 "\t\tWorkspace size (bytes)  = %" PRId32 "\n",
-						 buffer_class,
-						 ase_buffer.index,
-						 ase_buffer.memname,
-						 ase_buffer.vbase,
-						 ase_buffer.fake_paddr,
-						 ase_buffer.fake_paddr >> 6,
-						 ase_buffer.memsize);
+			char *buffer_class = "Buffer";
+			if (ase_buffer.is_mmiomap) {
+				buffer_class = "MMIO map";
+				initialize_fme_dfh(&ase_buffer);
+			} else if (ase_buffer.is_umas) {
+				buffer_class = "UMAS";
+				update_fme_dfh(&ase_buffer);
 			}
 
+			snprintf(logger_str,
+					 ASE_LOGGER_LEN,
+					 "%s allocated, index %d (located /dev/shm%s) =>\n"
+					 "\t\tHost app virtual addr   = 0x%" PRIx64 "\n"
+					 "\t\tHW physical addr (byte) = 0x%" PRIx64 "\n"
+					 "\t\tHW physical addr (line) = 0x%" PRIx64 "\n"
+					 "\t\tWorkspace size (bytes)  = %" PRId32 "\n",
+					 buffer_class,
+					 ase_buffer.index,
+					 ase_buffer.memname,
+					 ase_buffer.vbase,
+					 ase_buffer.fake_paddr,
+					 ase_buffer.fake_paddr >> 6,
+					 ase_buffer.memsize);
+
 			// Inject buffer message
 			buffer_msg_inject(1, logger_str);
 
@@ -1080,42 +1304,30 @@ int ase_listener(int mode)
 		if (mqueue_recv
 		    (app2sim_dealloc_rx, (char *) incoming_dealloc_msgstr,
 		     ASE_MQ_MSGSIZE) == ASE_MSG_PRESENT) {
+			rx_active = true;
+
 			// Typecast string to buffer_t
 			ase_memcpy((char *) &ase_buffer,
 				   incoming_dealloc_msgstr,
 				   sizeof(struct buffer_t));
 
-			if (ase_buffer.is_pinned) {
-				// Pinned buffer (host memory) messages are sent only for
-				// logging.
-				snprintf(logger_str,
-						 ASE_LOGGER_LEN,
-						 "Unpinned host memory page =>\n"
-						 "\t\tHW physical addr (byte) = 0x%" PRIx64 "\n"
-						 "\t\tHW physical addr (line) = 0x%" PRIx64 "\n"
-						 "\t\tPage size (bytes)       = %" PRId32 "\n",
-						 ase_buffer.fake_paddr,
-						 ase_buffer.fake_paddr >> 6,
-						 ase_buffer.memsize);
-			} else {
-				// Format workspace info string
-				snprintf(logger_str,
-						 ASE_LOGGER_LEN,
-						 "Buffer deallocated, index %d (located /dev/shm%s) =>\n"
-						 "\t\tHost app virtual addr   = 0x%" PRIx64 "\n"
-						 "\t\tHW physical addr (byte) = 0x%" PRIx64 "\n"
-						 "\t\tHW physical addr (line) = 0x%" PRIx64 "\n"
-						 "\t\tWorkspace size (bytes)  = %" PRId32 "\n",
-						 ase_buffer.index,
-						 ase_buffer.memname,
-						 ase_buffer.vbase,
-						 ase_buffer.fake_paddr,
-						 ase_buffer.fake_paddr >> 6,
-						 ase_buffer.memsize);
-
-				// Deallocate action
-				ase_shmem_dealloc_action(&ase_buffer, 1);
-			}
+			// Format workspace info string
+			snprintf(logger_str,
+					 ASE_LOGGER_LEN,
+					 "Buffer deallocated, index %d (located /dev/shm%s) =>\n"
+					 "\t\tHost app virtual addr   = 0x%" PRIx64 "\n"
+					 "\t\tHW physical addr (byte) = 0x%" PRIx64 "\n"
+					 "\t\tHW physical addr (line) = 0x%" PRIx64 "\n"
+					 "\t\tWorkspace size (bytes)  = %" PRId32 "\n",
+					 ase_buffer.index,
+					 ase_buffer.memname,
+					 ase_buffer.vbase,
+					 ase_buffer.fake_paddr,
+					 ase_buffer.fake_paddr >> 6,
+					 ase_buffer.memsize);
+
+			// Deallocate action
+			ase_shmem_dealloc_action(&ase_buffer, 1);
 
 			// Inject buffer message
 			buffer_msg_inject(1, logger_str);
@@ -1144,6 +1356,8 @@ int ase_listener(int mode)
 		if (mqueue_recv
 		    (app2sim_mmioreq_rx, (char *) incoming_mmio_pkt,
 		     sizeof(struct mmio_t)) == ASE_MSG_PRESENT) {
+			rx_active = true;
+
 			// ase_memcpy(incoming_mmio_pkt, (mmio_t *)mmio_mapstr, sizeof(struct mmio_t));
 
 #ifdef ASE_DEBUG
@@ -1185,6 +1399,8 @@ int ase_listener(int mode)
 		if (mqueue_recv
 		    (app2sim_umsg_rx, (char *) umsg_mapstr,
 		     sizeof(struct umsgcmd_t)) == ASE_MSG_PRESENT) {
+			rx_active = true;
+
 			ase_memcpy(incoming_umsg_pkt,
 				   (umsgcmd_t *) umsg_mapstr,
 				   sizeof(struct umsgcmd_t));
@@ -1315,6 +1531,14 @@ int ase_init(void)
 
 	// Set up message queues
 	ASE_MSG("Creating Messaging IPCs...\n");
+	if (cfg->enable_ipc_rings) {
+		if (ase_mq_ring_create() == 0) {
+			ASE_MSG("Using shared memory rings for messaging\n");
+		} else {
+			ASE_ERR("Shared memory rings could not be set up, using named pipes\n");
+		}
+	}
+
 	int ipc_iter;
 	for (ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
 		mqueue_create(mq_array[ipc_iter].name);
@@ -1356,24 +1580,59 @@ int ase_init(void)
 	app2sim_pcie_msg_rx =
 		mqueue_open(mq_array[15].name, mq_array[15].perm_flag);
 
-	int i;
+	// Named pipes polled by ase_listener and, once per cycle, by the
+	// PCIe TLP emulators are watched by an IO thread. The thread also
+	// serves the event socket, so it runs with the rings as well.
+	if (!ase_mq_ring_active()) {
+		if ((ase_mq_mux_add("app2sim_portctrl_req_smq", app2sim_portctrl_req_rx) != 0) ||
+		    (ase_mq_mux_add("app2sim_alloc_ping_smq", app2sim_alloc_rx) != 0) ||
+		    (ase_mq_mux_add("app2sim_dealloc_ping_smq", app2sim_dealloc_rx) != 0) ||
+		    (ase_mq_mux_add("app2sim_mmioreq_smq", app2sim_mmioreq_rx) != 0) ||
+		    (ase_mq_mux_add("app2sim_umsg_smq", app2sim_umsg_rx) != 0) ||
+		    (ase_mq_mux_add("app2sim_pcie_msg_smq", app2sim_pcie_msg_rx) != 0)) {
+			ASE_ERR("Named pipes not watched by the IO thread, polling them\n");
+			ase_mq_mux_stop();
+		}
+	}
+	if (ase_mq_mux_start() != 0) {
+		ASE_ERR("Message queue IO thread not started, polling named pipes\n");
+		ase_mq_mux_stop();
+	}
 
-	for (i = 0; i < MAX_USR_INTRS; i++)
-		intr_event_fds[i] = -1;
+	ase_wc_init(cfg->write_combine_cycles);
 
-	sockserver_kill = 0;
+	ase_event_init();
 
 	srand(cfg->ase_seed);
 
-	// Open Buffer info log
-	fp_workspace_log = fopen("workspace_info.log", "wb");
-	if (fp_workspace_log == (FILE *) NULL) {
-		ase_error_report("fopen", errno, ASE_OS_FOPEN_ERR);
+	// Open Buffer info log. env(ASE_WORKSPACE_LOG)=0 turns it off, along
+	// with the application's pinned page notes.
+	char *str_env = getenv("ASE_WORKSPACE_LOG");
+	if (str_env && (strtol(str_env, NULL, 10) == 0)) {
+		fp_workspace_log = NULL;
 	} else {
-		ASE_INFO_2
-			("Information about allocated buffers => workspace_info.log \n");
+		fp_workspace_log = ase_log_fopen("workspace_info.log");
+		if (fp_workspace_log == (FILE *) NULL) {
+			ase_error_report("fopen", errno, ASE_OS_FOPEN_ERR);
+		} else {
+			ASE_INFO_2
+				("Information about allocated buffers => workspace_info.log \n");
+		}
 	}
 
+	sim_features = 0;
+#ifdef ASE_ENABLE_UMSG_FEATURE
+	sim_features |= ASE_FEATURE_UMSG;
+#endif
+#ifdef ASE_ENABLE_INTR_FEATURE
+	sim_features |= ASE_FEATURE_INTR;
+#endif
+#ifdef ASE_ENABLE_MMIO512
+	sim_features |= ASE_FEATURE_MMIO512;
+#endif
+	if (fp_workspace_log != NULL)
+		sim_features |= ASE_FEATURE_PIN_NOTES;
+
 	fflush(stdout);
 
 	FUNC_CALL_EXIT;
@@ -1398,6 +1657,9 @@ int ase_ready(void)
 	// Write lock file
 	ase_write_lock_file();
 
+	// Applications may now connect
+	session_srv_start();
+
 	// Display "Ready for simulation"
 	ASE_INFO
 		("** ATTENTION : BEFORE running the software application **\n");
@@ -1466,14 +1728,20 @@ void start_simkill_countdown(void)
 	// In regression mode app side stucks in mqueue_recv during deinitialization
 	// Therefore, send a complete message to allow app to cleanly exit
 	if (cfg->ase_mode == ASE_MODE_REGRESSION) {
-		mqueue_send(sim2app_portctrl_rsp_tx,
-				completed_str_msg,
-				ASE_MQ_MSGSIZE);
+		portctrl_respond();
 	}
 
 	// Close and unlink message queue
 	ASE_MSG("Closing message queue and unlinking...\n");
 
+	// Stop the IO thread before its descriptors are closed
+	ase_mq_mux_stop();
+
+	ase_zcopy_unmap_all();
+
+	// Let HSSI plugins release their channels
+	hssi_plugins_close();
+
 	// Close message queues
 	mqueue_close(app2sim_alloc_rx);
 	mqueue_close(sim2app_alloc_tx);
@@ -1495,6 +1763,7 @@ void start_simkill_countdown(void)
 	int ipc_iter;
 	for (ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
 		mqueue_destroy(mq_array[ipc_iter].name);
+	ase_mq_ring_detach();
 
 	if (unlink(tstamp_filepath) == -1) {
 		ASE_MSG
@@ -1506,9 +1775,9 @@ void start_simkill_countdown(void)
 	// Final clean of IPC
 	final_ipc_cleanup();
 
-	// wait for server shutdown
-	pthread_cancel(socket_srv_tid);
-	pthread_join(socket_srv_tid, NULL);
+	// Remove the event and session sockets
+	event_srv_stop();
+	session_srv_stop();
 
 	// Remove session files
 	ASE_MSG("Cleaning session files...\n");
@@ -1645,6 +1914,41 @@ void parse_ase_cfg_line(char *filename, char *line, float *f_usrclk)
 						cfg->phys_memory_available_gb = value;
 					}
 				}
+			} else if (ase_strncmp(parameter, "ENABLE_IPC_RINGS", 16) == 0) {
+				pch = strtok_r(NULL, "", &saveptr);
+				if (pch != NULL)
+					cfg->enable_ipc_rings = strtol(pch, NULL, 10);
+			} else if (ase_strncmp(parameter, "WRITE_COMBINE_CYCLES", 20) == 0) {
+				pch = strtok_r(NULL, "", &saveptr);
+				if (pch != NULL) {
+					value = strtol(pch, NULL, 10);
+					if (value < 0) {
+						ASE_ERR("Write combining window is negative in %s\n", filename);
+						ASE_ERR("        Reverting to default %d cycles\n", cfg->write_combine_cycles);
+					} else {
+						cfg->write_combine_cycles = value;
+					}
+				}
+			} else if (ase_strncmp(parameter, "HSSI_PLUGIN_CHAN", 16) == 0) {
+				pch = strtok_r(NULL, "", &saveptr);
+				value = strtol(parameter + 16, NULL, 10);
+				if ((value < 0) || (value >= ASE_HSSI_MAX_CHANNELS)) {
+					ASE_ERR("HSSI channel %s is out of range in %s\n", parameter + 16, filename);
+				} else if (pch != NULL) {
+					free(hssi_plugin_path[value]);
+					hssi_plugin_path[value] = strdup(pch);
+					hssi_plugin_chan_set[value] = true;
+				}
+			} else if (ase_strncmp(parameter, "HSSI_PLUGIN", 11) == 0) {
+				pch = strtok_r(NULL, "", &saveptr);
+				if (pch != NULL) {
+					for (value = 0; value < ASE_HSSI_MAX_CHANNELS; value += 1) {
+						if (hssi_plugin_chan_set[value])
+							continue;
+						free(hssi_plugin_path[value]);
+						hssi_plugin_path[value] = strdup(pch);
+					}
+				}
 			} else {
 				ASE_INFO_2("In config file %s, Parameter type %s is unidentified \n",
 							 filename, parameter);
@@ -1686,6 +1990,8 @@ void ase_config_parse(char *filename)
 	cfg->enable_cl_view = 1;
 	cfg->usr_tps = DEFAULT_USR_CLK_TPS;
 	cfg->phys_memory_available_gb = 256;
+	cfg->enable_ipc_rings = 1;
+	cfg->write_combine_cycles = 64;
 
 	// Fclk Mhz
 	f_usrclk = DEFAULT_USR_CLK_MHZ;
@@ -1822,6 +2128,19 @@ void ase_config_parse(char *filename)
 	ASE_INFO_2("Amount of physical memory  ... %d GB\n",
 		   cfg->phys_memory_available_gb);
 
+	// Messaging transport
+	if (cfg->enable_ipc_rings != 0)
+		ASE_INFO_2("Shared memory IPC rings    ... ENABLED\n");
+	else
+		ASE_INFO_2("Shared memory IPC rings    ... DISABLED\n");
+
+	// DMA write combining
+	if (cfg->write_combine_cycles != 0)
+		ASE_INFO_2("DMA write combining        ... %d cycles\n",
+			   cfg->write_combine_cycles);
+	else
+		ASE_INFO_2("DMA write combining        ... DISABLED\n");
+
 	// Transfer data to hardware (for simulation only)
 	ase_config_dex(cfg);
 
@@ -0,0 +1,54 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+//
+// Reference DPI-C part-select functions for tests, moving one bit at a
+// time. Bit i of a vector is bit (i % 32) of word (i / 32).
+//
+
+#include "svdpi.h"
+
+svBit svGetBitselBit(const svBitVecVal *s, int i)
+{
+    return (s[i / 32] >> (i % 32)) & 1;
+}
+
+void svGetPartselBit(svBitVecVal *d, const svBitVecVal *s, int i, int w)
+{
+    uint32_t v = 0;
+    for (int j = 0; j < w; j += 1)
+        v |= (uint32_t)svGetBitselBit(s, i + j) << j;
+    *d = v;
+}
+
+void svPutPartselBit(svBitVecVal *d, const svBitVecVal s, int i, int w)
+{
+    for (int j = 0; j < w; j += 1)
+    {
+        int b = i + j;
+        d[b / 32] = (d[b / 32] & ~(1u << (b % 32))) | (((s >> j) & 1) << (b % 32));
+    }
+}
@@ -0,0 +1,233 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+//
+// Bit-exactness test for the word-level DPI-C vector accessors in
+// ase_dpi_vec.h. Each accessor is compared against a bit-by-bit
+// part-select on 256, 512 and 1024 bit vectors, at every bit offset
+// for the bit field functions and every DWORD offset for the DWORD
+// copies. The test is built with ASE_DEBUG, so the accessors' own
+// checks run against the reference part-select in svdpi_ref.c as well.
+//
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ase_dpi_vec.h"
+
+#define MAX_VEC_DW 32
+// One extra DWORD past the end of each vector catches overruns
+#define GUARD 0xa5a5a5a5
+
+static const uint32_t vec_widths[] = { 256, 512, 1024 };
+
+static int n_errors;
+
+static uint32_t rand_state = 0x12345678;
+
+static uint32_t next_rand(void)
+{
+    // xorshift32, so runs are repeatable
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+static void fill_rand(svBitVecVal *v, uint32_t n_dw)
+{
+    for (uint32_t i = 0; i < n_dw; i += 1)
+        v[i] = next_rand();
+    v[n_dw] = GUARD;
+}
+
+static uint32_t ref_bit(const svBitVecVal *v, uint32_t i)
+{
+    return (v[i / 32] >> (i % 32)) & 1;
+}
+
+static void ref_set_bit(svBitVecVal *v, uint32_t i, uint32_t b)
+{
+    v[i / 32] = (v[i / 32] & ~(1u << (i % 32))) | ((b & 1) << (i % 32));
+}
+
+static void fail(const char *fn, uint32_t vec_bits, uint32_t pos, uint32_t len)
+{
+    if (n_errors < 20)
+        printf("FAIL: %s vec_bits=%u pos=%u len=%u\n", fn, vec_bits, pos, len);
+    n_errors += 1;
+}
+
+// Compare two vectors bit by bit, including the guard DWORD
+static bool vec_equal(const svBitVecVal *a, const svBitVecVal *b, uint32_t n_dw)
+{
+    for (uint32_t i = 0; i < (n_dw + 1) * 32; i += 1)
+    {
+        if (ref_bit(a, i) != ref_bit(b, i))
+            return false;
+    }
+    return true;
+}
+
+static void test_get_bits(uint32_t vec_bits)
+{
+    uint32_t n_dw = vec_bits / 32;
+    svBitVecVal v[MAX_VEC_DW + 1];
+    fill_rand(v, n_dw);
+
+    for (uint32_t lsb = 0; lsb < vec_bits; lsb += 1)
+    {
+        for (uint32_t width = 1; width <= 32 && lsb + width <= vec_bits; width += 1)
+        {
+            svBitVecVal ref;
+            svGetPartselBit(&ref, v, lsb, width);
+            if (ase_dpi_get_bits(v, lsb, width) != ref)
+                fail("ase_dpi_get_bits", vec_bits, lsb, width);
+        }
+    }
+}
+
+static void test_put_bits(uint32_t vec_bits)
+{
+    uint32_t n_dw = vec_bits / 32;
+    svBitVecVal v[MAX_VEC_DW + 1];
+    svBitVecVal ref[MAX_VEC_DW + 1];
+
+    for (uint32_t lsb = 0; lsb < vec_bits; lsb += 1)
+    {
+        for (uint32_t width = 1; width <= 32 && lsb + width <= vec_bits; width += 1)
+        {
+            // Random value with bits set above the field, which must be ignored
+            uint32_t val = next_rand();
+            fill_rand(v, n_dw);
+            memcpy(ref, v, sizeof(ref));
+
+            ase_dpi_put_bits(v, val, lsb, width);
+            svPutPartselBit(ref, val, lsb, width);
+            if (!vec_equal(v, ref, n_dw))
+                fail("ase_dpi_put_bits", vec_bits, lsb, width);
+        }
+    }
+}
+
+static void test_set_bits(uint32_t vec_bits)
+{
+    uint32_t n_dw = vec_bits / 32;
+    svBitVecVal v[MAX_VEC_DW + 1];
+    svBitVecVal ref[MAX_VEC_DW + 1];
+
+    for (uint32_t lsb = 0; lsb < vec_bits; lsb += 1)
+    {
+        for (uint32_t n_bits = 0; lsb + n_bits <= vec_bits; n_bits += 1)
+        {
+            // Short runs exhaustively, then longer runs at a coarser step
+            if (n_bits > 70 && lsb + n_bits != vec_bits && (n_bits % 29) != 0)
+                continue;
+
+            fill_rand(v, n_dw);
+            memcpy(ref, v, sizeof(ref));
+
+            ase_dpi_set_bits(v, lsb, n_bits);
+            for (uint32_t i = lsb; i < lsb + n_bits; i += 1)
+                ref_set_bit(ref, i, 1);
+            if (!vec_equal(v, ref, n_dw))
+                fail("ase_dpi_set_bits", vec_bits, lsb, n_bits);
+        }
+    }
+}
+
+static void test_get_dwords(uint32_t vec_bits)
+{
+    uint32_t n_dw = vec_bits / 32;
+    svBitVecVal v[MAX_VEC_DW + 1];
+    uint32_t dst[MAX_VEC_DW + 1];
+    fill_rand(v, n_dw);
+
+    for (uint32_t src_dw = 0; src_dw < n_dw; src_dw += 1)
+    {
+        for (uint32_t len = 1; src_dw + len <= n_dw; len += 1)
+        {
+            fill_rand(dst, len);
+            ase_dpi_get_dwords(dst, v, src_dw, len);
+
+            bool ok = (dst[len] == GUARD);
+            for (uint32_t i = 0; ok && i < len * 32; i += 1)
+                ok = (ref_bit(dst, i) == ref_bit(v, src_dw * 32 + i));
+            if (!ok)
+                fail("ase_dpi_get_dwords", vec_bits, src_dw, len);
+        }
+    }
+}
+
+static void test_put_dwords(uint32_t vec_bits)
+{
+    uint32_t n_dw = vec_bits / 32;
+    svBitVecVal v[MAX_VEC_DW + 1];
+    svBitVecVal ref[MAX_VEC_DW + 1];
+    uint32_t src[MAX_VEC_DW];
+
+    for (uint32_t dst_dw = 0; dst_dw < n_dw; dst_dw += 1)
+    {
+        for (uint32_t len = 1; dst_dw + len <= n_dw; len += 1)
+        {
+            fill_rand(v, n_dw);
+            memcpy(ref, v, sizeof(ref));
+            for (uint32_t i = 0; i < len; i += 1)
+                src[i] = next_rand();
+
+            ase_dpi_put_dwords(v, dst_dw, src, len);
+            for (uint32_t i = 0; i < len * 32; i += 1)
+                ref_set_bit(ref, dst_dw * 32 + i, ref_bit(src, i));
+            if (!vec_equal(v, ref, n_dw))
+                fail("ase_dpi_put_dwords", vec_bits, dst_dw, len);
+        }
+    }
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < sizeof(vec_widths) / sizeof(vec_widths[0]); i += 1)
+    {
+        uint32_t vec_bits = vec_widths[i];
+
+        test_get_bits(vec_bits);
+        test_put_bits(vec_bits);
+        test_set_bits(vec_bits);
+        test_get_dwords(vec_bits);
+        test_put_dwords(vec_bits);
+    }
+
+    if (n_errors)
+    {
+        printf("%d mismatches\n", n_errors);
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,184 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+//
+// Interrupt events pass through the event socket as they do from the
+// application. The simulator receives each eventfd with a new number,
+// so unregistering must name the vector. Once a vector is unregistered
+// no interrupt may reach its event, and the simulator must have closed
+// every descriptor it received.
+//
+
+#include "ase_common.h"
+#include "ase_event.h"
+#include "ase_zcopy.h"
+
+#include <dirent.h>
+#include <sys/eventfd.h>
+
+#define VECTOR 3
+
+static int n_errors;
+
+void ase_print(int loglevel, const char *fmt, ...)
+{
+	UNUSED_PARAM(loglevel);
+	UNUSED_PARAM(fmt);
+}
+
+int ase_memset(void *dest, int ch, size_t count)
+{
+	memset(dest, ch, count);
+	return 0;
+}
+
+int ase_zcopy_map(int fd, int32_t afu_idx, uint64_t iova, uint64_t length)
+{
+	UNUSED_PARAM(fd);
+	UNUSED_PARAM(afu_idx);
+	UNUSED_PARAM(iova);
+	UNUSED_PARAM(length);
+	return -1;
+}
+
+int ase_zcopy_unmap(int32_t afu_idx, uint64_t iova)
+{
+	UNUSED_PARAM(afu_idx);
+	UNUSED_PARAM(iova);
+	return -1;
+}
+
+static void check(bool ok, const char *what)
+{
+	if (!ok) {
+		printf("FAIL: %s\n", what);
+		n_errors += 1;
+	}
+}
+
+static int open_fds(void)
+{
+	DIR *d = opendir("/proc/self/fd");
+	int n = 0;
+
+	if (d == NULL)
+		return -1;
+	while (readdir(d) != NULL)
+		n += 1;
+	closedir(d);
+	return n;
+}
+
+// Send a request as the application does, with fd attached if >= 0
+static int send_request(int sock_fd, int fd, struct event_request *req)
+{
+	struct msghdr msg = {0};
+	char buf[CMSG_SPACE(sizeof(int))];
+	struct iovec io = { .iov_base = req, .iov_len = sizeof(*req) };
+	struct cmsghdr *cmsg;
+
+	memset(buf, 0, sizeof(buf));
+	msg.msg_iov = &io;
+	msg.msg_iovlen = 1;
+	if (fd >= 0) {
+		msg.msg_control = buf;
+		msg.msg_controllen = CMSG_LEN(sizeof(int));
+		cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+		*(int *)CMSG_DATA(cmsg) = fd;
+	}
+	return (sendmsg(sock_fd, &msg, 0) < 0) ? -1 : 0;
+}
+
+// Number of interrupts signaled on the event since the last read
+static uint64_t events(int efd)
+{
+	uint64_t val;
+
+	if (read(efd, &val, sizeof(val)) != sizeof(val))
+		return 0;
+	return val;
+}
+
+int main(void)
+{
+	struct event_request req;
+	int sv[2];
+	int efd;
+	int n_fds;
+
+	ase_event_init();
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+		printf("FAIL: socketpair\n");
+		return 1;
+	}
+	efd = eventfd(0, EFD_NONBLOCK);
+	if (efd < 0) {
+		printf("FAIL: eventfd\n");
+		return 1;
+	}
+	n_fds = open_fds();
+
+	memset(&req, 0, sizeof(req));
+	req.type = REGISTER_EVENT;
+	req.flags = VECTOR;
+	check(send_request(sv[0], efd, &req) == 0, "send register");
+	check(ase_event_request(sv[1]) == 0, "register");
+	check(open_fds() == n_fds + 1, "simulator holds its copy");
+
+	ase_interrupt_generator(VECTOR);
+	check(events(efd) == 1, "interrupt delivered");
+
+	// The application passes the vectors, not its descriptor
+	memset(&req, 0, sizeof(req));
+	req.type = UNREGISTER_EVENT;
+	req.vectors = UINT64_C(1) << VECTOR;
+	check(send_request(sv[0], -1, &req) == 0, "send unregister");
+	check(ase_event_request(sv[1]) == 0, "unregister");
+	check(open_fds() == n_fds, "simulator copy closed");
+
+	ase_interrupt_generator(VECTOR);
+	check(events(efd) == 0, "no interrupt after unregister");
+
+	// A descriptor sent with an unregister request is closed as well
+	check(send_request(sv[0], efd, &req) == 0, "send unregister with fd");
+	check(ase_event_request(sv[1]) == 0, "unregister with fd");
+	check(open_fds() == n_fds, "received descriptor closed");
+
+	ase_event_session_end();
+	close(efd);
+	close(sv[0]);
+	close(sv[1]);
+
+	if (n_errors)
+		return 1;
+
+	printf("PASS\n");
+	return 0;
+}
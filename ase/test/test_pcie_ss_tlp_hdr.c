@@ -0,0 +1,238 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+//
+// Randomized comparison of pcie_ss_tlp_hdr_pack() and
+// pcie_ss_tlp_hdr_unpack() with the bit-level implementation in
+// pcie_ss_tlp_hdr_ref.c. Headers with random fields are packed by both
+// and the resulting tdata, tuser and tkeep vectors must match. Random
+// vectors are then unpacked by both and the headers must match. Each
+// bus width supported by the PCIe SS emulator is covered.
+//
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ase_common.h"
+#include "pcie_ss_tlp_stream.h"
+
+#define N_ITER 20000
+#define MAX_VEC_DW 32
+
+void ref_pcie_ss_tlp_hdr_pack(svBitVecVal *tdata, svBitVecVal *tuser,
+                              svBitVecVal *tkeep, const t_pcie_ss_hdr_upk *hdr);
+void ref_pcie_ss_tlp_hdr_unpack(t_pcie_ss_hdr_upk *hdr, const svBitVecVal *tdata,
+                                const svBitVecVal *tuser, const svBitVecVal *tkeep);
+
+t_ase_pcie_ss_param_cfg pcie_ss_param_cfg;
+t_ase_pcie_ss_cfg pcie_ss_cfg;
+
+static const uint32_t tdata_widths[] = { 256, 512, 1024 };
+
+// Header types handled by distinct paths in the packing code
+static const uint8_t fmt_types[] = {
+	PCIE_FMTTYPE_MEM_READ32, PCIE_FMTTYPE_MEM_READ64,
+	PCIE_FMTTYPE_MEM_WRITE32, PCIE_FMTTYPE_MEM_WRITE64,
+	PCIE_FMTTYPE_CFG_WRITE, PCIE_FMTTYPE_INTR,
+	PCIE_FMTTYPE_CPL, PCIE_FMTTYPE_CPLD,
+	PCIE_FMTTYPE_FETCH_ADD32, PCIE_FMTTYPE_FETCH_ADD64,
+	PCIE_FMTTYPE_SWAP32, PCIE_FMTTYPE_SWAP64,
+	PCIE_FMTTYPE_CAS32, PCIE_FMTTYPE_CAS64,
+	0x30, 0x34, 0x70, 0x74
+};
+
+static int n_errors;
+
+static uint32_t rand_state = 0x2468ace1;
+
+static uint32_t next_rand(void)
+{
+	// xorshift32, so runs are repeatable
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return rand_state;
+}
+
+static uint64_t next_rand64(void)
+{
+	return ((uint64_t)next_rand() << 32) | next_rand();
+}
+
+static void fill_rand(svBitVecVal *v, uint32_t n_dw)
+{
+	for (uint32_t i = 0; i < n_dw; i += 1)
+		v[i] = next_rand();
+}
+
+// Errors are expected for some random headers, e.g. DM completions
+void ase_print(int loglevel, const char *fmt, ...)
+{
+	UNUSED_PARAM(loglevel);
+	UNUSED_PARAM(fmt);
+}
+
+void start_simkill_countdown(void)
+{
+}
+
+static void fail(const char *what, uint32_t tdata_bits, int iter)
+{
+	if (n_errors < 20)
+		printf("FAIL: %s tdata_bits=%u iter=%d\n", what, tdata_bits, iter);
+	n_errors += 1;
+}
+
+// Fields hold random values, including bits beyond their width in the
+// packed format, which must be dropped the same way by both versions.
+static void rand_hdr(t_pcie_ss_hdr_upk *hdr)
+{
+	memset(hdr, 0, sizeof(*hdr));
+
+	hdr->metadata = next_rand64();
+	hdr->bar_number = next_rand();
+	hdr->mm_mode = next_rand() & 1;
+	hdr->slot_num = next_rand();
+	hdr->vf_active = next_rand() & 1;
+	hdr->vf_num = next_rand();
+	hdr->pf_num = next_rand() & 7;
+	hdr->pref_present = next_rand() & 1;
+	hdr->pref_type = next_rand() & 0x1f;
+	hdr->pref = next_rand() & 0xffffff;
+	hdr->req_id = next_rand();
+	hdr->tag = next_rand() & 0x3ff;
+	hdr->len_bytes = next_rand();
+	if (next_rand() & 1)
+		hdr->fmt_type = fmt_types[next_rand() % (sizeof(fmt_types) / sizeof(fmt_types[0]))];
+	else
+		hdr->fmt_type = next_rand();
+	hdr->dm_mode = next_rand() & 1;
+
+	if (tlp_func_is_mem_req(hdr->fmt_type)) {
+		hdr->u.req.addr = next_rand64();
+		hdr->u.req.last_dw_be = next_rand() & 0xf;
+		hdr->u.req.first_dw_be = next_rand() & 0xf;
+	} else if (tlp_func_is_completion(hdr->fmt_type)) {
+		hdr->u.cpl.comp_id = next_rand();
+		hdr->u.cpl.cpl_status = next_rand() & 7;
+		hdr->u.cpl.bcm = next_rand() & 1;
+		hdr->u.cpl.byte_count = next_rand() & 0xfff;
+		hdr->u.cpl.low_addr = next_rand() & 0xffffff;
+		hdr->u.cpl.fc = next_rand() & 1;
+	} else if (tlp_func_is_msg(hdr->fmt_type)) {
+		hdr->u.msg.msg2 = next_rand();
+		hdr->u.msg.msg1 = next_rand();
+		hdr->u.msg.msg_code = next_rand();
+	}
+}
+
+static bool tuser_equal(const svBitVecVal *a, const svBitVecVal *b)
+{
+	for (int i = 0; i < pcie_ss_param_cfg.tuser_width_bits; i += 1) {
+		if (svGetBitselBit(a, i) != svGetBitselBit(b, i))
+			return false;
+	}
+	return true;
+}
+
+static void test_pack(uint32_t tdata_bits, int iter)
+{
+	uint32_t n_dw = tdata_bits / 32;
+	uint32_t n_keep_dw = SV_PACKED_DATA_NELEMS(tdata_bits / 8);
+	svBitVecVal tdata[MAX_VEC_DW], tuser[1], tkeep[MAX_VEC_DW];
+	svBitVecVal ref_tdata[MAX_VEC_DW], ref_tuser[1], ref_tkeep[MAX_VEC_DW];
+	t_pcie_ss_hdr_upk hdr;
+
+	rand_hdr(&hdr);
+
+	// Start from the same garbage, all of which must be replaced
+	fill_rand(tdata, MAX_VEC_DW);
+	fill_rand(tuser, 1);
+	fill_rand(tkeep, MAX_VEC_DW);
+	memcpy(ref_tdata, tdata, sizeof(tdata));
+	memcpy(ref_tuser, tuser, sizeof(tuser));
+	memcpy(ref_tkeep, tkeep, sizeof(tkeep));
+
+	pcie_ss_tlp_hdr_pack(tdata, tuser, tkeep, &hdr);
+	ref_pcie_ss_tlp_hdr_pack(ref_tdata, ref_tuser, ref_tkeep, &hdr);
+
+	if (memcmp(tdata, ref_tdata, n_dw * 4))
+		fail("pcie_ss_tlp_hdr_pack tdata", tdata_bits, iter);
+	if (!tuser_equal(tuser, ref_tuser))
+		fail("pcie_ss_tlp_hdr_pack tuser", tdata_bits, iter);
+	if (memcmp(tkeep, ref_tkeep, n_keep_dw * 4))
+		fail("pcie_ss_tlp_hdr_pack tkeep", tdata_bits, iter);
+}
+
+static void test_unpack(uint32_t tdata_bits, int iter)
+{
+	svBitVecVal tdata[MAX_VEC_DW], tuser[1], tkeep[MAX_VEC_DW];
+	t_pcie_ss_hdr_upk hdr, ref_hdr;
+
+	fill_rand(tdata, MAX_VEC_DW);
+	fill_rand(tuser, 1);
+	fill_rand(tkeep, MAX_VEC_DW);
+
+	// Steer half of the vectors to the known header types
+	if (next_rand() & 1) {
+		uint8_t t = fmt_types[next_rand() % (sizeof(fmt_types) / sizeof(fmt_types[0]))];
+		tdata[0] = (tdata[0] & 0x00ffffff) | ((uint32_t)t << 24);
+	}
+
+	pcie_ss_tlp_hdr_unpack(&hdr, tdata, tuser, tkeep);
+	ref_pcie_ss_tlp_hdr_unpack(&ref_hdr, tdata, tuser, tkeep);
+
+	if (memcmp(&hdr, &ref_hdr, sizeof(hdr)))
+		fail("pcie_ss_tlp_hdr_unpack", tdata_bits, iter);
+}
+
+int main(void)
+{
+	pcie_ss_param_cfg.tuser_width_bits = 10;
+	pcie_ss_cfg.tlp_hdr_dwords = 8;
+
+	for (uint32_t i = 0; i < sizeof(tdata_widths) / sizeof(tdata_widths[0]); i += 1) {
+		uint32_t tdata_bits = tdata_widths[i];
+
+		pcie_ss_param_cfg.tdata_width_bits = tdata_bits;
+		pcie_ss_cfg.tlp_tdata_dwords = tdata_bits / 32;
+
+		for (int iter = 0; iter < N_ITER; iter += 1) {
+			test_pack(tdata_bits, iter);
+			test_unpack(tdata_bits, iter);
+		}
+	}
+
+	if (n_errors) {
+		printf("%d mismatches\n", n_errors);
+		return 1;
+	}
+
+	printf("PASS\n");
+	return 0;
+}
@@ -0,0 +1,167 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+//
+// Readers translate through the lock-free page table while the AFU's
+// table is torn down and rebuilt under them. A reader that walks a table
+// after ase_host_memory_terminate_afu() has freed it faults on the
+// unmapped node.
+//
+
+#include "ase_common.h"
+#include "ase_host_memory.h"
+#include "ase_vma.h"
+#include "ase_zcopy.h"
+
+#define N_READERS 4
+#define RUN_NSEC (1000 * 1000 * 1000L)
+#define TEST_IOVA UINT64_C(0x40000000)
+
+static char page[4096] __attribute__((aligned(4096)));
+static volatile bool stop;
+static uint64_t n_errors;
+static uint64_t n_hits;
+
+static int64_t elapsed_nsec(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1000000000L +
+	       (now.tv_nsec - start->tv_nsec);
+}
+
+void ase_print(int loglevel, const char *fmt, ...)
+{
+	UNUSED_PARAM(loglevel);
+	UNUSED_PARAM(fmt);
+}
+
+bool ase_checkenv(const char *name)
+{
+	UNUSED_PARAM(name);
+	return false;
+}
+
+int ase_memset(void *dest, int ch, size_t count)
+{
+	memset(dest, ch, count);
+	return 0;
+}
+
+int64_t ase_vma_page_len(uint64_t va)
+{
+	UNUSED_PARAM(va);
+	return 4096;
+}
+
+void ase_zcopy_drop(int32_t afu_idx, uint64_t iova, uint64_t length)
+{
+	UNUSED_PARAM(afu_idx);
+	UNUSED_PARAM(iova);
+	UNUSED_PARAM(length);
+}
+
+void note_pinned_page(uint64_t va, uint64_t iova, uint64_t length)
+{
+	UNUSED_PARAM(va);
+	UNUSED_PARAM(iova);
+	UNUSED_PARAM(length);
+}
+
+void note_unpinned_page(uint64_t iova, uint64_t length)
+{
+	UNUSED_PARAM(iova);
+	UNUSED_PARAM(length);
+}
+
+static void *reader(void *arg)
+{
+	uint64_t off = (uint64_t)arg * 64;
+	bool lock = false;
+
+	while (!__atomic_load_n(&stop, __ATOMIC_ACQUIRE)) {
+		uint64_t va = ase_host_memory_iova_to_va(0, TEST_IOVA + off, lock);
+
+		if (va) {
+			if (va != (uint64_t)page + off)
+				__atomic_add_fetch(&n_errors, 1, __ATOMIC_RELAXED);
+			__atomic_add_fetch(&n_hits, 1, __ATOMIC_RELAXED);
+			if (lock)
+				ase_host_memory_unlock();
+		} else {
+			// No table, let the writer build one
+			sched_yield();
+		}
+
+		lock = !lock;
+	}
+
+	return NULL;
+}
+
+int main(void)
+{
+	pthread_t tid[N_READERS];
+	struct timespec start;
+	uint64_t n_iters = 0;
+	int i;
+
+	for (i = 0; i < N_READERS; i++)
+		pthread_create(&tid[i], NULL, reader, (void *)(uint64_t)i);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while (elapsed_nsec(&start) < RUN_NSEC) {
+		if (ase_host_memory_pin(0, page, TEST_IOVA, sizeof(page))) {
+			printf("FAIL: pin\n");
+			return 1;
+		}
+
+		// Let readers find the table
+		sched_yield();
+
+		ase_host_memory_terminate_afu(0);
+		n_iters += 1;
+	}
+
+	__atomic_store_n(&stop, true, __ATOMIC_RELEASE);
+	for (i = 0; i < N_READERS; i++)
+		pthread_join(tid[i], NULL);
+
+	if (ase_host_memory_iova_to_va(0, TEST_IOVA, false) != 0) {
+		printf("FAIL: translation after terminate\n");
+		return 1;
+	}
+
+	if (n_errors) {
+		printf("FAIL: %" PRIu64 " bad translations\n", n_errors);
+		return 1;
+	}
+
+	printf("PASS (%" PRIu64 " translations raced with %" PRIu64 " teardowns)\n",
+	       n_hits, n_iters);
+	return 0;
+}
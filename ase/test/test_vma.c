@@ -0,0 +1,98 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+//
+// The VMA index must notice memory that the C library unmaps without
+// going through the preload hooks. A buffer from a large malloc() is
+// mapped by the C library internally and unmapped again by free(), so a
+// lookup after free() must report it as not mapped.
+//
+
+#include "ase_common.h"
+#include "ase_vma.h"
+
+// Big enough for malloc() to map it separately
+#define BIG_BYTES (16 * 1024 * 1024)
+
+static int n_errors;
+
+void ase_host_memory_va_mapped(uint64_t va, uint64_t length, bool mapped)
+{
+	UNUSED_PARAM(va);
+	UNUSED_PARAM(length);
+	UNUSED_PARAM(mapped);
+}
+
+static void check(bool ok, const char *what)
+{
+	if (!ok) {
+		printf("FAIL: %s\n", what);
+		n_errors += 1;
+	}
+}
+
+int main(void)
+{
+	// As if libase-preload had found the library
+	ase_mem_hooks_attach();
+	check(ase_vma_tracking(), "hooks attached");
+
+	// Mapped and unmapped by the C library, unseen by the hooks
+	char *buf = malloc(BIG_BYTES);
+	if (buf == NULL) {
+		printf("FAIL: malloc\n");
+		return 1;
+	}
+	memset(buf, 0, BIG_BYTES);
+	uint64_t va = (uint64_t)buf + BIG_BYTES / 2;
+
+	check(ase_vma_page_len(va) > 0, "malloc buffer mapped");
+	// Second lookup hits the index
+	check(ase_vma_page_len(va) > 0, "malloc buffer mapped again");
+
+	free(buf);
+	check(ase_vma_page_len(va) == 0, "freed malloc buffer not mapped");
+
+	// Mapped and unmapped through the hooks
+	void *p = mmap(NULL, 1024 * 1024, PROT_READ | PROT_WRITE,
+		       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED) {
+		printf("FAIL: mmap\n");
+		return 1;
+	}
+	ase_mem_map_hook(p, 1024 * 1024, MAP_PRIVATE | MAP_ANONYMOUS, -1);
+	check(ase_vma_page_len((uint64_t)p + 4096) == 4096, "hooked mmap mapped");
+
+	munmap(p, 1024 * 1024);
+	ase_mem_unmapped_hook(p, 1024 * 1024);
+	check(ase_vma_page_len((uint64_t)p + 4096) == 0, "hooked munmap not mapped");
+
+	if (n_errors)
+		return 1;
+
+	printf("PASS\n");
+	return 0;
+}
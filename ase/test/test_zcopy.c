@@ -0,0 +1,156 @@
+// Copyright(c) 2026, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+//
+// Zero-copy buffers shared by the application must be dropped by the
+// simulator as soon as their pages are unpinned, unmapped or remapped,
+// so that DMA to them goes back through the application's NOT_PINNED
+// and NOT_MAPPED checks. This test drives the application side of
+// ase_zcopy.c with the simulator requests stubbed out.
+//
+
+#include "ase_common.h"
+#include "ase_vma.h"
+#include "ase_zcopy.h"
+
+#define MAX_CALLS 16
+
+static bool hooks_attached;
+static int register_status;
+
+static int n_registered;
+static struct {
+	int32_t afu_idx;
+	uint64_t iova;
+} unregistered[MAX_CALLS];
+static int n_unregistered;
+
+static int n_errors;
+
+bool ase_vma_tracking(void)
+{
+	return hooks_attached;
+}
+
+int register_dma_buffer(int fd, int32_t afu_idx, uint64_t iova, uint64_t length)
+{
+	UNUSED_PARAM(fd);
+	UNUSED_PARAM(afu_idx);
+	UNUSED_PARAM(iova);
+	UNUSED_PARAM(length);
+
+	n_registered += 1;
+	return register_status;
+}
+
+int unregister_dma_buffer(int32_t afu_idx, uint64_t iova)
+{
+	if (n_unregistered < MAX_CALLS) {
+		unregistered[n_unregistered].afu_idx = afu_idx;
+		unregistered[n_unregistered].iova = iova;
+	}
+	n_unregistered += 1;
+	return 0;
+}
+
+static void check(bool ok, const char *what)
+{
+	if (!ok) {
+		printf("FAIL: %s\n", what);
+		n_errors += 1;
+	}
+}
+
+// Check that exactly one buffer, (afu_idx, iova), was unregistered
+static void check_dropped(int32_t afu_idx, uint64_t iova, const char *what)
+{
+	check((n_unregistered == 1) &&
+	      (unregistered[0].afu_idx == afu_idx) &&
+	      (unregistered[0].iova == iova), what);
+	n_unregistered = 0;
+}
+
+int main(void)
+{
+	char *va_a = (char *)0x7f0000000000;
+	char *va_b = (char *)0x7f0000100000;
+
+	// Without the preload hooks, unmaps can't be seen and nothing is shared
+	check(ase_zcopy_register(3, va_a, 0, 0x100000, 8192) != 0,
+	      "registered without the preload hooks");
+	check(n_registered == 0, "simulator asked to map without the preload hooks");
+
+	hooks_attached = true;
+
+	// A buffer the simulator refuses is forgotten without unregistering
+	register_status = -1;
+	check(ase_zcopy_register(3, va_a, 0, 0x100000, 8192) != 0,
+	      "refused registration reported success");
+	ase_zcopy_drop(0, 0x100000, 8192);
+	check(n_unregistered == 0, "refused buffer unregistered");
+	register_status = 0;
+
+	// Same IOVA in two AFUs
+	check(ase_zcopy_register(3, va_a, 0, 0x100000, 8192) == 0, "register AFU 0");
+	check(ase_zcopy_register(4, va_b, 1, 0x100000, 4096) == 0, "register AFU 1");
+
+	// Unpinning part of a buffer drops the whole buffer, in that AFU only
+	ase_zcopy_drop(0, 0x101000, 4096);
+	check_dropped(0, 0x100000, "unpin drops the buffer in its AFU");
+	ase_zcopy_drop(0, 0x100000, 8192);
+	check(n_unregistered == 0, "buffer dropped twice");
+
+	// Unmaps elsewhere leave the buffer alone
+	ase_zcopy_va_changed((uint64_t)va_b + 4096, 4096);
+	ase_zcopy_va_changed((uint64_t)va_b - 4096, 4096);
+	check(n_unregistered == 0, "unmap of neighboring pages dropped the buffer");
+
+	// Unmapping any byte of a buffer drops it
+	ase_zcopy_va_changed((uint64_t)va_b + 100, 1);
+	check_dropped(1, 0x100000, "unmap drops the buffer");
+
+	// Nothing is left to drop
+	ase_zcopy_drop(1, 0, UINT64_MAX);
+	ase_zcopy_va_changed(0, UINT64_MAX);
+	check(n_unregistered == 0, "buffers left after all were dropped");
+
+	// Many buffers, dropped by one large unmap
+	for (int i = 0; i < 100; i += 1) {
+		check(ase_zcopy_register(5, va_a + i * 4096, 2, 0x200000 + i * 4096, 4096) == 0,
+		      "register many");
+	}
+	ase_zcopy_va_changed((uint64_t)va_a, 100 * 4096);
+	check(n_unregistered == 100, "large unmap missed buffers");
+	n_unregistered = 0;
+
+	if (n_errors) {
+		printf("%d errors\n", n_errors);
+		return 1;
+	}
+
+	printf("PASS\n");
+	return 0;
+}